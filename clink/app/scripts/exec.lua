@@ -142,6 +142,19 @@ local function exec_matches(line_state, match_builder, chained)
         added = add_files(text.."*", true) or added
     end
 
+    -- Executables in PATH come from the executable catalog when it's ready,
+    -- so the directories don't need to be enumerated on every completion.
+    -- Looking up the catalog also starts a background check for directories
+    -- that changed, so its results are used even when nothing matched.
+    if paths and paths[1] then
+        local prefix = settings.get("match.substring") and "" or text
+        local found, catalog_added = match_builder:addexecutables(prefix)
+        if found then
+            added = catalog_added or added
+            paths = {}
+        end
+    end
+
     -- Search 'paths' for files ending in 'suffices' and look for matches.
     local suffices = (os.getenv("pathext") or ""):explode(";")
     for _, suffix in ipairs(suffices) do
@@ -48,6 +48,144 @@ local function log_cost(tick, filter, func_name)
     end
 end
 
+--------------------------------------------------------------------------------
+local function find_git_head(dir)
+    while dir do
+        local git = path.join(dir, ".git")
+        if os.isdir(git) then
+            return path.join(git, "HEAD")
+        elseif os.isfile(git) then
+            -- Worktrees and submodules have a file that names the git dir.
+            local f = io.open(git)
+            if f then
+                local gitdir = (f:read("*l") or ""):match("^gitdir:%s*(.-)%s*$")
+                f:close()
+                if gitdir and gitdir ~= "" then
+                    return path.join(path.join(dir, gitdir), "HEAD")
+                end
+            end
+            return
+        end
+
+        local parent = path.getdirectory(path.normalise(dir))
+        if not parent or parent == dir then
+            return
+        end
+        dir = parent
+    end
+end
+
+--------------------------------------------------------------------------------
+local function get_mtime(file)
+    local files = os.globfiles(file, 2)
+    return files and files[1] and files[1].mtime or ""
+end
+
+--------------------------------------------------------------------------------
+local function read_first_line(file)
+    local f = io.open(file)
+    if f then
+        local line = f:read("*l") or ""
+        f:close()
+        return line
+    end
+end
+
+--------------------------------------------------------------------------------
+local function get_git_head_key()
+    local head = find_git_head(os.getcwd())
+    if not head then
+        return ""
+    end
+
+    local content = read_first_line(head) or ""
+    local key = head.."|"..get_mtime(head).."|"..content
+
+    -- A commit on the current branch updates the branch's ref instead of
+    -- HEAD, so include the ref as well.  A ref can be a loose file or be in
+    -- packed-refs, and worktrees keep shared refs in the common git dir.
+    local ref = content:match("^ref:%s*(.-)%s*$")
+    if ref and ref ~= "" then
+        local gitdir = path.getdirectory(head)
+        local commondir = read_first_line(path.join(gitdir, "commondir"))
+        commondir = (commondir and commondir ~= "") and path.join(gitdir, commondir) or gitdir
+
+        local value = read_first_line(path.join(gitdir, ref)) or read_first_line(path.join(commondir, ref))
+        key = key.."|"..(value or get_mtime(path.join(commondir, "packed-refs")))
+    end
+
+    return key
+end
+
+--------------------------------------------------------------------------------
+-- Each key is resolved at most once per prompt filtering pass, and shared by
+-- all of the prompt filters that depend on it.
+local function resolve_cache_key(k, resolved)
+    local v = resolved[k]
+    if v == nil then
+        if type(k) == "function" then
+            v = k()
+        elseif k == "cwd" then
+            v = os.getcwd()
+        elseif k == "errorlevel" then
+            v = os.geterrorlevel()
+        elseif k == "githead" then
+            v = get_git_head_key()
+        elseif type(k) == "string" and k:sub(1, 4) == "env:" then
+            v = os.getenv(k:sub(5))
+        else
+            error("unrecognized prompt filter cache key '"..tostring(k).."'", 0)
+        end
+        v = (v == nil) and "\001" or tostring(v)
+        resolved[k] = v
+    end
+    return v
+end
+
+--------------------------------------------------------------------------------
+local function make_cache_key(keys, text, resolved)
+    local parts = { text or "" }
+    if type(keys) == "table" then
+        for _, k in ipairs(keys) do
+            table.insert(parts, resolve_cache_key(k, resolved))
+        end
+    else
+        table.insert(parts, resolve_cache_key(keys, resolved))
+    end
+    return table.concat(parts, "\000")
+end
+
+--------------------------------------------------------------------------------
+local function call_filter(filter, func, func_name, text, resolved)
+    local key
+    local cname = "cache"..func_name
+    if filter.cachekeys then
+        key = make_cache_key(filter.cachekeys, text, resolved)
+        local cached = filter[cname]
+        if cached and cached.key == key then
+            local hname = "hits"..func_name
+            filter[hname] = (filter[hname] or 0) + 1
+            filter["lasthit"..func_name] = true
+            return cached.filtered, cached.onwards
+        end
+    end
+
+    local tick = os.clock()
+    local filtered, onwards = func(filter, text)
+    log_cost(tick, filter, func_name)
+    filter["lasthit"..func_name] = nil
+
+    -- Output that depends on a prompt coroutine changes when the coroutine
+    -- finishes, so it can't be reused.
+    if key and not prompt_filter_coroutines[filter] then
+        filter[cname] = { key=key, filtered=filtered, onwards=onwards }
+    else
+        filter[cname] = nil
+    end
+
+    return filtered, onwards
+end
+
 --------------------------------------------------------------------------------
 local function _do_filter_prompt(type, prompt, rprompt, line, cursor, final)
     -- Sort by priority if required.
@@ -64,6 +202,7 @@ local function _do_filter_prompt(type, prompt, rprompt, line, cursor, final)
     -- Protected call to prompt filters.
     local impl = function(prompt, rprompt) -- luacheck: ignore 432
         local filtered, onwards
+        local resolved = {}
         for _, filter in ipairs(prompt_filters) do
             set_current_prompt_filter(filter)
 
@@ -74,9 +213,7 @@ local function _do_filter_prompt(type, prompt, rprompt, line, cursor, final)
             local func
             func = filter[filter_func_name]
             if func or #type == 0 then
-                local tick = os.clock()
-                filtered, onwards = func(filter, prompt)
-                log_cost(tick, filter, filter_func_name)
+                filtered, onwards = call_filter(filter, func, filter_func_name, prompt, resolved)
                 if filtered ~= nil then
                     prompt = filtered
                     if onwards == false then return prompt, rprompt end
@@ -85,9 +222,7 @@ local function _do_filter_prompt(type, prompt, rprompt, line, cursor, final)
 
             func = filter[right_filter_func_name]
             if func then
-                local tick = os.clock()
-                filtered, onwards = func(filter, rprompt)
-                log_cost(tick, filter, right_filter_func_name)
+                filtered, onwards = call_filter(filter, func, right_filter_func_name, rprompt, resolved)
                 if filtered ~= nil then
                     rprompt = filtered
                     if onwards == false then return prompt, rprompt end
@@ -155,6 +290,11 @@ end
 --- further prompt filtering by also returning false.  See
 --- <a href="#customisingtheprompt">Customizing the Prompt</a> for more
 --- information.
+---
+--- Starting in v1.4.9, setting a <code>cachekeys</code> field on the object
+--- lets Clink reuse the filter's output while its inputs are unchanged.  See
+--- <a href="#promptfiltercache">Caching Prompt Filter Output</a> for more
+--- information.
 --- -show:  local foo_prompt = clink.promptfilter(80)
 --- -show:  function foo_prompt:filter(prompt)
 --- -show:  &nbsp;   -- Insert the date at the beginning of the prompt.
@@ -220,7 +360,7 @@ local function collect_filter_src(t, type)
     local tsub = {}
     t[type] = tsub
 
-    local any_cost
+    local any_cost, any_hits
     local longest = 24
     for _,prompt in ipairs (prompt_filters) do
         local func = prompt[type]
@@ -229,17 +369,23 @@ local function collect_filter_src(t, type)
             if not clink._is_internal_script(info.short_src) then
                 local src = info.short_src..":"..info.linedefined
                 local cost = prompt["cost"..type]
-                table.insert(tsub, { src=src, cost=cost })
+                local hits = prompt.cachekeys and (prompt["hits"..type] or 0)
+                local lasthit = prompt["lasthit"..type]
+                table.insert(tsub, { src=src, cost=cost, hits=hits, lasthit=lasthit })
                 if longest < #src then
                     longest = #src
                 end
                 if not any_cost and cost then
                     any_cost = true
                 end
+                if not any_hits and hits then
+                    any_hits = true
+                end
             end
         end
     end
     tsub.any_cost = any_cost
+    tsub.any_hits = any_hits
     t.longest = max_len(t.longest, longest)
 end
 
@@ -250,16 +396,27 @@ local function print_filter_src(t, type)
     if tsub[1] then
         local longest = t.longest
         if tsub.any_cost then
-            clink.print(string.format("  %s           %slast    avg     peak%s",
-                    pad_string(type..":", longest), header, norm))
+            clink.print(string.format("  %s           %slast    avg     peak%s%s",
+                    pad_string(type..":", longest), header,
+                    tsub.any_hits and "   hits" or "", norm))
         else
             clink.print("  "..type..":")
         end
         for _,entry in ipairs (tsub) do
             if entry.cost then
-                clink.print(string.format("        %s  %4u ms %4u ms %4u ms",
+                local hits = ""
+                if entry.hits then
+                    -- Hit rate of the cache, out of all calls to the filter.
+                    local calls = entry.hits + entry.cost.num
+                    hits = string.format("  %4u%%", math.floor(entry.hits * 100 / calls))
+                end
+                -- When the most recent call was served from the cache, say so
+                -- instead of showing the cost of the last actual call.
+                local last = entry.lasthit and "    hit" or string.format("%4u ms", entry.cost.last)
+                clink.print(string.format("        %s  %s %4u ms %4u ms%s",
                         pad_string(entry.src, longest),
-                        entry.cost.last, entry.cost.total / entry.cost.num, entry.cost.peak))
+                        last, entry.cost.total / entry.cost.num, entry.cost.peak,
+                        hits))
             else
                 clink.print(string.format("        %s", entry.src))
             end
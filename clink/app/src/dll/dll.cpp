@@ -130,6 +130,10 @@ static void shutdown_clink()
     extern void shutdown_recognizer();
     shutdown_recognizer();
 
+    extern void shutdown_exec_catalog();
+    shutdown_exec_catalog();
+
+    // Deleting the logger stops its thread and writes out any pending records.
     if (logger* logger = logger::get())
         delete logger;
 
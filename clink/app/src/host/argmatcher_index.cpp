@@ -0,0 +1,482 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "argmatcher_index.h"
+
+#include <core/os.h>
+#include <core/path.h>
+#include <core/str_tokeniser.h>
+
+//------------------------------------------------------------------------------
+static const char c_index_header[] = "clink argmatcher index 1";
+
+//------------------------------------------------------------------------------
+static unsigned long long get_mtime(const char* path)
+{
+    wstr<280> wpath(path);
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (!GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &fad))
+        return 0;
+
+    ULARGE_INTEGER uli;
+    uli.LowPart = fad.ftLastWriteTime.dwLowDateTime;
+    uli.HighPart = fad.ftLastWriteTime.dwHighDateTime;
+    return uli.QuadPart;
+}
+
+//------------------------------------------------------------------------------
+static bool read_file(const char* file, str_base& out)
+{
+    out.clear();
+
+    FILE* in = fopen(file, "rb");
+    if (in == nullptr)
+        return false;
+
+    fseek(in, 0, SEEK_END);
+    int size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+
+    if (size > 0 && out.reserve(size))
+    {
+        char* data = out.data();
+        size = int(fread(data, 1, size, in));
+        data[size] = '\0';
+    }
+
+    fclose(in);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static bool is_ident_char(char c)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9') || c == '_';
+}
+
+//------------------------------------------------------------------------------
+static const char* skip_space(const char* p)
+{
+    while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n')
+        ++p;
+    return p;
+}
+
+//------------------------------------------------------------------------------
+// Anything that may have side effects other than registering argmatchers
+// disqualifies a script.  This errs on the side of loading scripts eagerly.
+static const char* const c_disqualifiers[] =
+{
+    "require",
+    "dofile",
+    "loadfile",
+    "_G",
+    "clink.on",
+    "clink.prompt",
+    "clink.register",
+    "clink.generator",
+    "clink.classifier",
+    "clink.arg.",
+    "clink.runcoroutine",
+    "settings.add",
+    "rl.setbinding",
+    "rl.describemacro",
+    "os.setenv",
+    "os.setalias",
+};
+
+//------------------------------------------------------------------------------
+static bool is_keyword(const char* p, int len)
+{
+    static const char* const c_keywords[] =
+    {
+        "and", "break", "do", "else", "elseif", "end", "false", "for",
+        "function", "goto", "if", "in", "local", "nil", "not", "or", "repeat",
+        "return", "then", "true", "until", "while",
+    };
+
+    for (const char* keyword : c_keywords)
+        if (int(strlen(keyword)) == len && strncmp(p, keyword, len) == 0)
+            return true;
+    return false;
+}
+
+//------------------------------------------------------------------------------
+// Returns true if the line calls anything other than clink.argmatcher() and
+// methods chained onto it.  Any call runs when the script is loaded, even as
+// an initializer such as "local x = f()", so it may have side effects.
+static bool has_call(const char* line)
+{
+    static const char c_argmatcher[] = "clink.argmatcher";
+
+    bool after_function = false;
+    for (const char* p = line; *p && *p != '\n';)
+    {
+        if (*p == '"' || *p == '\'')
+        {
+            const char quote = *(p++);
+            while (*p && *p != '\n' && *p != quote)
+                p += (*p == '\\' && p[1] && p[1] != '\n') ? 2 : 1;
+            if (*p == quote)
+                ++p;
+            continue;
+        }
+
+        if (p[0] == '-' && p[1] == '-')
+            break;
+
+        if (*p >= '0' && *p <= '9')
+        {
+            while (is_ident_char(*p) || *p == '.')
+                ++p;
+            continue;
+        }
+
+        if (!is_ident_char(*p))
+        {
+            ++p;
+            continue;
+        }
+
+        const char* before = p;
+        while (before > line && (before[-1] == ' ' || before[-1] == '\t'))
+            --before;
+        const bool method = (before > line && before[-1] == ':');
+
+        const char* name = p;
+        while (is_ident_char(*p) || *p == '.')
+            ++p;
+        const int len = int(p - name);
+
+        if (is_keyword(name, len))
+        {
+            after_function = (len == 8 && strncmp(name, "function", 8) == 0);
+            continue;
+        }
+
+        const char* next = p;
+        while (*next == ' ' || *next == '\t')
+            ++next;
+        const bool call = (*next == '(' || *next == '"' || *next == '\'' || *next == '{');
+        if (call && !after_function && !method &&
+            !(len == sizeof(c_argmatcher) - 1 && strncmp(name, c_argmatcher, len) == 0))
+            return true;
+
+        after_function = false;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+static bool has_global_side_effects(const char* content)
+{
+    for (const char* word : c_disqualifiers)
+        if (strstr(content, word))
+            return true;
+
+    // Top level global assignments and function definitions could be used by
+    // other scripts, so they also disqualify the script.  That includes
+    // "function a.b()" and "function a:b()", which add to a table that may be
+    // shared.  So does any top level call, including in a method chain that
+    // continues on an indented line.  Other indented lines are presumed to be
+    // inside a function or block.
+    for (const char* line = content; *line; )
+    {
+        const char* p = line;
+        if (is_ident_char(*p))
+        {
+            if (strncmp(p, "function", 8) == 0 && (p[8] == ' ' || p[8] == '\t'))
+                return true;
+
+            if (strncmp(p, "local", 5) != 0 || is_ident_char(p[5]))
+            {
+                while (is_ident_char(*p) || *p == '.')
+                    ++p;
+                p = skip_space(p);
+                if (p[0] == '=' && p[1] != '=')
+                    return true;
+            }
+
+            if (has_call(line))
+                return true;
+        }
+        else
+        {
+            while (*p == ' ' || *p == '\t')
+                ++p;
+            if (*p == ':' && has_call(p))
+                return true;
+        }
+
+        line = strchr(line, '\n');
+        if (!line)
+            break;
+        ++line;
+    }
+
+    return false;
+}
+
+//------------------------------------------------------------------------------
+static const char* parse_string_literal(const char* p, str_base& out)
+{
+    const char quote = *p;
+    if (quote != '"' && quote != '\'')
+        return nullptr;
+
+    const char* start = ++p;
+    while (*p && *p != quote)
+    {
+        // Escapes and separators would make the command name ambiguous.
+        if (*p == '\\' || *p == ';' || *p == '\t' || *p == '\n')
+            return nullptr;
+        ++p;
+    }
+
+    if (*p != quote || p == start)
+        return nullptr;
+
+    if (out.length())
+        out.concat(";", 1);
+    out.concat(start, int(p - start));
+    return p + 1;
+}
+
+//------------------------------------------------------------------------------
+// Returns true if the script content only registers argmatchers, and puts the
+// semicolon delimited list of command names in out.
+bool argmatcher_index::scan(const char* content, str_base& out)
+{
+    out.clear();
+
+    if (has_global_side_effects(content))
+        return false;
+
+    static const char c_argmatcher[] = "clink.argmatcher";
+    const int len = sizeof(c_argmatcher) - 1;
+
+    for (const char* p = strstr(content, c_argmatcher); p; p = strstr(p, c_argmatcher))
+    {
+        p = skip_space(p + len);
+
+        // clink.argmatcher "name"
+        if (*p == '"' || *p == '\'')
+        {
+            p = parse_string_literal(p, out);
+            if (!p)
+                return false;
+            continue;
+        }
+
+        // clink.argmatcher([priority,] "name", ...)
+        if (*p != '(')
+            return false;
+        p = skip_space(p + 1);
+        if (*p >= '0' && *p <= '9')
+        {
+            while (*p >= '0' && *p <= '9')
+                ++p;
+            p = skip_space(p);
+            if (*p != ',')
+                return false;
+            p = skip_space(p + 1);
+        }
+
+        while (true)
+        {
+            p = parse_string_literal(p, out);
+            if (!p)
+                return false;
+            p = skip_space(p);
+            if (*p == ')')
+                break;
+            if (*p != ',')
+                return false;
+            p = skip_space(p + 1);
+        }
+    }
+
+    return out.length() > 0;
+}
+
+//------------------------------------------------------------------------------
+void argmatcher_index::load(const char* file)
+{
+    m_dirs.clear();
+    m_current = -1;
+    m_dirty = false;
+    m_file = file;
+
+    if (!file || !*file)
+        return;
+
+    str_moveable buffer;
+    if (!read_file(file, buffer))
+        return;
+
+    bool first = true;
+    str<> line;
+    str_tokeniser lines(buffer.c_str(), "\n\r");
+    while (lines.next(line))
+    {
+        if (first)
+        {
+            first = false;
+            if (!line.equals(c_index_header))
+                return;
+            continue;
+        }
+
+        // D <tab> mtime <tab> dir
+        // S <tab> mtime <tab> commands <tab> name
+        char* fields[4] = {};
+        const int num_fields = (line.c_str()[0] == 'D') ? 3 : 4;
+        char* p = line.data();
+        int i = 0;
+        for (; i < num_fields && p; ++i)
+        {
+            fields[i] = p;
+            if (i + 1 < num_fields)
+            {
+                p = strchr(p, '\t');
+                if (p)
+                    *(p++) = '\0';
+            }
+        }
+        if (!p)
+            continue;
+
+        const unsigned long long mtime = _strtoui64(fields[1], nullptr, 10);
+        if (strcmp(fields[0], "D") == 0)
+        {
+            dir_entry dir;
+            dir.dir = fields[2];
+            dir.mtime = mtime;
+            m_dirs.emplace_back(std::move(dir));
+        }
+        else if (strcmp(fields[0], "S") == 0 && !m_dirs.empty())
+        {
+            script_entry script;
+            script.name = fields[3];
+            script.mtime = mtime;
+            script.commands = fields[2];
+            m_dirs.back().scripts.emplace_back(std::move(script));
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+bool argmatcher_index::save()
+{
+    if (!m_dirty || m_file.empty())
+        return true;
+
+    // Other sessions may read or save the index at the same time, so write a
+    // temporary file and then replace the index with it.
+    str<280> parent(m_file.c_str());
+    path::to_parent(parent, nullptr);
+
+    str<280> tmp;
+    FILE* out = os::create_temp_file(&tmp, "argmatcher_index", ".tmp", os::normal, parent.c_str());
+    if (out == nullptr)
+        return false;
+
+    fprintf(out, "%s\n", c_index_header);
+    for (const auto& dir : m_dirs)
+    {
+        fprintf(out, "D\t%llu\t%s\n", dir.mtime, dir.dir.c_str());
+        for (const auto& script : dir.scripts)
+            fprintf(out, "S\t%llu\t%s\t%s\n", script.mtime, script.commands.c_str(), script.name.c_str());
+    }
+
+    const bool ok = !ferror(out);
+    fclose(out);
+
+    wstr<280> wtmp(tmp.c_str());
+    wstr<280> wfile(m_file.c_str());
+    if (!ok || !MoveFileExW(wtmp.c_str(), wfile.c_str(), MOVEFILE_REPLACE_EXISTING))
+    {
+        os::unlink(tmp.c_str());
+        return false;
+    }
+
+    m_dirty = false;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void argmatcher_index::begin_dir(const char* dir)
+{
+    const unsigned long long mtime = get_mtime(dir);
+
+    m_current = -1;
+    for (size_t i = 0; i < m_dirs.size(); ++i)
+    {
+        if (_stricmp(m_dirs[i].dir.c_str(), dir) == 0)
+        {
+            m_current = int(i);
+            break;
+        }
+    }
+
+    if (m_current < 0)
+    {
+        dir_entry entry;
+        entry.dir = dir;
+        entry.mtime = mtime;
+        m_dirs.emplace_back(std::move(entry));
+        m_current = int(m_dirs.size() - 1);
+        m_dirty = true;
+    }
+    else if (m_dirs[m_current].mtime != mtime)
+    {
+        // Scripts were added, removed, or renamed; rescan the whole directory.
+        m_dirs[m_current].mtime = mtime;
+        m_dirs[m_current].scripts.clear();
+        m_dirty = true;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool argmatcher_index::get_commands(const char* script, unsigned long long mtime, str_base& out)
+{
+    out.clear();
+
+    if (m_current < 0)
+        return false;
+
+    const char* name = path::get_name(script);
+    auto& scripts = m_dirs[m_current].scripts;
+
+    script_entry* entry = nullptr;
+    for (auto& s : scripts)
+    {
+        if (_stricmp(s.name.c_str(), name) == 0)
+        {
+            entry = &s;
+            break;
+        }
+    }
+
+    if (!entry || entry->mtime != mtime)
+    {
+        if (!entry)
+        {
+            scripts.emplace_back();
+            entry = &scripts.back();
+            entry->name = name;
+        }
+
+        str_moveable content;
+        if (!read_file(script, content) || !scan(content.c_str(), entry->commands))
+            entry->commands.clear();
+        entry->mtime = mtime;
+        m_dirty = true;
+        ++m_scanned;
+    }
+
+    out = entry->commands.c_str();
+    return !out.empty();
+}
@@ -0,0 +1,47 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <core/str.h>
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Remembers which Lua scripts do nothing except register argmatchers, and for
+// which commands.  Loading those scripts can be deferred until one of their
+// commands is typed.  The index is persisted, and a directory is rescanned
+// when its timestamp changes; a script is rescanned when its own timestamp
+// changes.
+class argmatcher_index
+{
+public:
+                        argmatcher_index() = default;
+    void                load(const char* file);
+    bool                save();
+    void                begin_dir(const char* dir);
+    bool                get_commands(const char* script, unsigned long long mtime, str_base& out);
+    unsigned int        get_scanned_count() const { return m_scanned; }
+    static bool         scan(const char* content, str_base& out);
+
+private:
+    struct script_entry
+    {
+        str_moveable        name;
+        unsigned long long  mtime;
+        str_moveable        commands;
+    };
+
+    struct dir_entry
+    {
+        str_moveable        dir;
+        unsigned long long  mtime;
+        std::vector<script_entry> scripts;
+    };
+
+    std::vector<dir_entry> m_dirs;
+    int                 m_current = -1;
+    str_moveable        m_file;
+    bool                m_dirty = false;
+    unsigned int        m_scanned = 0;
+};
@@ -15,6 +15,7 @@
 #include <core/str_tokeniser.h>
 #include <core/str_transform.h>
 #include <core/log.h>
+#include <core/perf_stats.h>
 #include <core/debugheap.h>
 #include <core/callstack.h>
 #include <core/assert_improved.h>
@@ -200,6 +201,25 @@ static setting_bool g_get_errorlevel(
     "default.",
     true);
 
+static setting_bool g_debug_trace(
+    "debug.trace",
+    "Record timing events",
+    "When this is enabled and logging is enabled, Clink records how long prompt\n"
+    "filtering, match generation, input line coloring, and display take.  The\n"
+    "events are written to clink_trace_<pid>.json in the same directory as the\n"
+    "log file, which can be loaded in chrome://tracing or https://ui.perfetto.dev.",
+    false);
+
+static setting_bool g_debug_perf_stats(
+    "debug.perf_stats",
+    "Record keystroke latency stats",
+    "When this is enabled, Clink measures how long each stage of handling a\n"
+    "keystroke takes (see clink-show-perf).  The stats are also saved to\n"
+    "clink_perf_<pid>.txt in the profile directory after each input line, where\n"
+    "<pid> is the process id of the cmd.exe session, so that 'clink info' can\n"
+    "report them.",
+    false);
+
 #ifdef DEBUG
 static setting_bool g_debug_heap_stats(
     "debug.heap_stats",
@@ -376,6 +396,8 @@ struct autostart_display
 //------------------------------------------------------------------------------
 void autostart_display::save()
 {
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbi))
@@ -396,6 +418,8 @@ void autostart_display::save()
 //------------------------------------------------------------------------------
 void autostart_display::restore()
 {
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbi))
@@ -422,6 +446,8 @@ void autostart_display::restore()
 //------------------------------------------------------------------------------
 static void move_cursor_up_one_line()
 {
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (GetConsoleScreenBufferInfo(h, &csbi))
@@ -448,6 +474,15 @@ host::~host()
 {
     purge_old_files();
 
+#ifdef USE_PERF_STATS
+    if (perf_stats_enabled())
+    {
+        str<> perf_file;
+        app_context::get()->get_perf_stats_path(perf_file);
+        _unlink(perf_file.c_str());
+    }
+#endif
+
     delete m_prompt_filter;
     delete m_suggester;
     delete m_lua;
@@ -748,12 +783,55 @@ bool host::edit_line(const char* prompt, const char* rprompt, str_base& out, boo
     settings::load(settings_file.c_str(), default_settings_file.c_str());
     reset_keyseq_to_name_map();
 
+    // Start or stop recording keystroke latency stats.
+    {
+        const bool perf = g_debug_perf_stats.get();
+        if (perf != perf_stats_enabled())
+        {
+            perf_stats_enable(perf);
+            if (!perf)
+            {
+                perf_stats_reset();
+                str<288> perf_file;
+                app->get_perf_stats_path(perf_file);
+                _unlink(perf_file.c_str());
+            }
+        }
+    }
+
+    // Start or stop recording timing events.
+    if (logger* log = logger::get())
+    {
+        const bool trace = g_debug_trace.get();
+        if (trace != logger::is_tracing())
+        {
+            if (trace)
+            {
+                str<288> trace_file;
+                app->get_log_path(trace_file);
+                path::to_parent(trace_file, nullptr);
+                str<32> name;
+                name.format("clink_trace_%d.json", GetCurrentProcessId());
+                path::append(trace_file, name.c_str());
+                log->begin_trace(trace_file.c_str());
+            }
+            else
+            {
+                log->end_trace();
+            }
+        }
+    }
+
     // Set up the string comparison mode.
     static_assert(str_compare_scope::exact == 0, "g_ignore_case values must match str_compare_scope values");
     static_assert(str_compare_scope::caseless == 1, "g_ignore_case values must match str_compare_scope values");
     static_assert(str_compare_scope::relaxed == 2, "g_ignore_case values must match str_compare_scope values");
     str_compare_scope compare(g_ignore_case.get(), g_fuzzy_accent.get());
 
+    // Cache directory listings for expanding abbreviated paths for the
+    // duration of the edit session.
+    os::abbreviated_path_cache_scope abbrev_cache;
+
     // Run clinkstart.cmd on inject, if present.
     static bool s_autostart = true;
     static std::unique_ptr<autostart_display> s_autostart_display;
@@ -1061,6 +1139,8 @@ skip_errorlevel:
         if (!ret)
             break;
 
+        save_perf_stats();
+
         // Determine whether to add the line to history.  Must happen before
         // calling expand() because that resets the history position.
         bool add_history = true;
@@ -1275,6 +1355,28 @@ const char* host::filter_prompt(const char** rprompt, bool transient, bool final
     return m_filtered_prompt.c_str();
 }
 
+//------------------------------------------------------------------------------
+// Saves the keystroke latency stats so that `clink info` can report them.
+void host::save_perf_stats()
+{
+#ifdef USE_PERF_STATS
+    if (!perf_stats_enabled())
+        return;
+
+    str_moveable report;
+    if (!perf_stats_report(report))
+        return;
+
+    str<> file;
+    app_context::get()->get_perf_stats_path(file);
+    if (FILE* f = fopen(file.c_str(), "wt"))
+    {
+        fputs(report.c_str(), f);
+        fclose(f);
+    }
+#endif
+}
+
 //------------------------------------------------------------------------------
 void host::purge_old_files()
 {
@@ -1288,6 +1390,16 @@ void host::purge_old_files()
     i.older_than(seconds);
     while (i.next(tmp))
         _unlink(tmp.c_str());
+
+    // Purge orphaned clink_perf files as well; they're rewritten after each
+    // input line, so active sessions restore theirs.
+    app_context::get()->get_state_dir(tmp);
+    path::append(tmp, "clink_perf_*.txt");
+
+    globber p(tmp.c_str());
+    p.older_than(seconds);
+    while (p.next(tmp))
+        _unlink(tmp.c_str());
 }
 
 //------------------------------------------------------------------------------
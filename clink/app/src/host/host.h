@@ -79,6 +79,7 @@ protected:
     virtual void    initialise_editor_desc(line_editor::desc& desc) = 0;
 
 private:
+    void            save_perf_stats();
     void            purge_old_files();
     void            update_last_cwd();
     void            pop_queued_line();
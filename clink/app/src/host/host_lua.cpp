@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "host_lua.h"
+#include "argmatcher_index.h"
 #include "utils/app_context.h"
 
 #include <core/globber.h>
@@ -15,6 +16,7 @@
 #include <core/settings.h>
 #include <core/log.h>
 
+#include <memory>
 #include <vector>
 
 extern "C" {
@@ -26,6 +28,18 @@ extern bool is_force_reload_scripts();
 extern void clear_force_reload_scripts();
 extern void clear_macro_descriptions();
 
+//------------------------------------------------------------------------------
+static setting_bool g_lazy_argmatchers(
+    "lua.lazy_argmatchers",
+    "Defer loading argmatcher-only scripts",
+    "When enabled, scripts that do nothing except define argmatchers are not\n"
+    "loaded at startup.  Instead, each such script is loaded the first time its\n"
+    "command is typed.  Which scripts qualify is remembered in an index file in\n"
+    "the profile directory, and is rescanned when a script directory changes.\n"
+    "This can noticeably reduce startup time when many completion scripts are\n"
+    "installed.",
+    false);
+
 //------------------------------------------------------------------------------
 host_lua::host_lua()
 : m_generator(m_state)
@@ -103,6 +117,19 @@ bool host_lua::load_scripts(const char* paths)
     os::high_resolution_clock clock;
     unsigned num_loaded = 0;
     unsigned num_failed = 0;
+    unsigned num_deferred = 0;
+
+    std::unique_ptr<argmatcher_index> index;
+    if (g_lazy_argmatchers.get())
+    {
+        str<280> index_file;
+        app_context::get()->get_state_dir(index_file);
+        if (!index_file.empty())
+            path::append(index_file, "argmatcher_index");
+
+        index = std::make_unique<argmatcher_index>();
+        index->load(index_file.c_str());
+    }
 
     bool first = true;
 
@@ -149,7 +176,14 @@ bool host_lua::load_scripts(const char* paths)
         seen.emplace(out.c_str());
         seen_strings.emplace_back(std::move(out));
 
-        load_script(tmp.c_str(), num_loaded, num_failed);
+        load_script(tmp.c_str(), index.get(), num_loaded, num_failed, num_deferred);
+    }
+
+    if (index)
+    {
+        if (num_deferred || index->get_scanned_count())
+            LOG("Deferred %u argmatcher scripts (scanned %u)", num_deferred, index->get_scanned_count());
+        index->save();
     }
 
     if (num_failed)
@@ -161,7 +195,7 @@ bool host_lua::load_scripts(const char* paths)
 }
 
 //------------------------------------------------------------------------------
-void host_lua::load_script(const char* path, unsigned& num_loaded, unsigned& num_failed)
+void host_lua::load_script(const char* path, argmatcher_index* index, unsigned& num_loaded, unsigned& num_failed, unsigned& num_deferred)
 {
     str_moveable buffer;
     path::join(path, "*.lua", buffer);
@@ -169,11 +203,29 @@ void host_lua::load_script(const char* path, unsigned& num_loaded, unsigned& num
     globber lua_globs(buffer.c_str());
     lua_globs.directories(false);
 
-    while (lua_globs.next(buffer))
+    if (index)
+        index->begin_dir(path);
+
+    str<> commands;
+    globber::extrainfo info;
+    while (lua_globs.next(buffer, true, &info))
     {
         const char* s = path::get_name(buffer.c_str());
         if (stricmp(s, "clink.lua") != 0)
         {
+            if (index)
+            {
+                ULARGE_INTEGER mtime;
+                mtime.LowPart = info.modified.dwLowDateTime;
+                mtime.HighPart = info.modified.dwHighDateTime;
+                if (index->get_commands(buffer.c_str(), mtime.QuadPart, commands) &&
+                    defer_script(buffer.c_str(), commands.c_str()))
+                {
+                    num_deferred++;
+                    continue;
+                }
+            }
+
             if (m_state.do_file(buffer.c_str()))
                 num_loaded++;
             else
@@ -182,6 +234,22 @@ void host_lua::load_script(const char* path, unsigned& num_loaded, unsigned& num
     }
 }
 
+//------------------------------------------------------------------------------
+bool host_lua::defer_script(const char* script, const char* commands)
+{
+    lua_State* state = m_state.get_state();
+    save_stack_top ss(state);
+
+    lua_getglobal(state, "clink");
+    lua_pushliteral(state, "_defer_argmatcher_script");
+    lua_rawget(state, -2);
+
+    lua_pushstring(state, script);
+    lua_pushstring(state, commands);
+
+    return m_state.pcall(2, 0) == 0;
+}
+
 //------------------------------------------------------------------------------
 bool host_lua::is_script_path_changed() const
 {
@@ -10,6 +10,8 @@
 #include <lua/lua_state.h>
 #include <functional>
 
+class argmatcher_index;
+
 //------------------------------------------------------------------------------
 class host_lua
 {
@@ -37,7 +39,8 @@ public:
 
 private:
     bool                load_scripts(const char* paths);
-    void                load_script(const char* path, unsigned& num_loaded, unsigned& num_failed);
+    void                load_script(const char* path, argmatcher_index* index, unsigned& num_loaded, unsigned& num_failed, unsigned& num_deferred);
+    bool                defer_script(const char* script, const char* commands);
     lua_state           m_state;
     lua_match_generator m_generator;
     lua_word_classifier m_classifier;
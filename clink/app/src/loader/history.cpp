@@ -2,6 +2,7 @@
 // License: http://opensource.org/licenses/MIT
 
 #include "pch.h"
+#include "history.h"
 #include "utils/app_context.h"
 
 #include <core/base.h>
@@ -16,6 +17,10 @@
 #include <stdlib.h>
 #include <ctime>
 #include <assert.h>
+#include <algorithm>
+#include <memory>
+#include <regex>
+#include <vector>
 
 //------------------------------------------------------------------------------
 extern setting_bool g_save_history;
@@ -87,69 +92,194 @@ static bool is_console(HANDLE h)
 }
 
 //------------------------------------------------------------------------------
-static void print_history_item(HANDLE hout, const char* utf8, wstr_base* utf16)
+history_writer::history_writer(FILE* file)
+: m_file(file)
+, m_hout(reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file))))
+, m_console(is_console(m_hout))
 {
-    if (utf16)
+    if (m_console)
+        m_utf16.reserve(c_flush_size + 1024);
+    else
+        m_utf8.reserve(c_flush_size + 1024);
+}
+
+//------------------------------------------------------------------------------
+void history_writer::append(const char* text, unsigned int len)
+{
+    if (!m_console)
     {
-        DWORD written;
-        utf16->clear();
+        m_utf8.concat(text, int(len));
+        return;
+    }
 
-        // Translate to UTF16, and also translate control characters.
-        for (const char* walk = utf8; *walk;)
-        {
-            const char* begin = walk;
-            while (static_cast<unsigned char>(*walk) >= 0x20 || *walk == 0x09)
-                walk++;
-            if (walk > begin)
-            {
-                str_iter tmpi(begin, int(walk - begin));
-                to_utf16(*utf16, tmpi);
-            }
-            if (!*walk)
-                break;
-            wchar_t ctrl[3] = { '^', wchar_t(*walk + 'A' - 1) };
-            utf16->concat(ctrl, 2);
+    // Translate to UTF16, and also translate control characters.
+    const char* walk = text;
+    const char* end = text + len;
+    while (walk < end)
+    {
+        const char* begin = walk;
+        while (walk < end && (static_cast<unsigned char>(*walk) >= 0x20 || *walk == 0x09))
             walk++;
+        if (walk > begin)
+        {
+            str_iter tmpi(begin, int(walk - begin));
+            to_utf16(m_utf16, tmpi);
         }
+        if (walk >= end)
+            break;
+        wchar_t ctrl[3] = { '^', wchar_t(*walk + 'A' - 1) };
+        m_utf16.concat(ctrl, 2);
+        walk++;
+    }
+}
+
+//------------------------------------------------------------------------------
+void history_writer::end_line()
+{
+    if (m_console)
+        m_utf16.concat(L"\r\n", 2);
+    else
+        m_utf8.concat("\n", 1);
+
+    if ((m_console ? m_utf16.length() : m_utf8.length()) >= c_flush_size)
+        flush();
+}
 
-        utf16->concat(L"\r\n", 2);
-        WriteConsoleW(hout, utf16->c_str(), utf16->length(), &written, nullptr);
+//------------------------------------------------------------------------------
+void history_writer::flush()
+{
+    if (m_console)
+    {
+        DWORD written;
+        if (m_utf16.length())
+            WriteConsoleW(m_hout, m_utf16.c_str(), m_utf16.length(), &written, nullptr);
+        m_utf16.clear();
     }
     else
     {
-        puts(utf8);
+        if (m_utf8.length())
+            fwrite(m_utf8.c_str(), 1, m_utf8.length(), m_file);
+        m_utf8.clear();
     }
 }
 
+
+
 //------------------------------------------------------------------------------
-static void print_history(unsigned int tail_count, bool bare)
+static history_filter s_filter;
+
+//------------------------------------------------------------------------------
+bool history_filter::set_regex(const char* expr)
 {
-    history_scope history;
+    try
+    {
+        regex = std::make_unique<std::regex>(expr, std::regex_constants::ECMAScript);
+        return true;
+    }
+    catch (const std::regex_error&)
+    {
+        regex.reset();
+        return false;
+    }
+}
 
-    str_iter line;
-    history_read_buffer buffer;
+//------------------------------------------------------------------------------
+bool history_filter::test(const str_iter& line, const str_base& timestamp) const
+{
+    if (since || until)
+    {
+        if (timestamp.empty())
+            return false;
+        const time_t tt = time_t(atoi(timestamp.c_str()));
+        if ((since && tt < since) || (until && tt >= until))
+            return false;
+    }
+
+    const char* begin = line.get_pointer();
+    const char* end = begin + line.length();
+
+    if (!text.empty() && std::search(begin, end, text.c_str(), text.c_str() + text.length()) == end)
+        return false;
 
-    unsigned int count = 0;
-    unsigned int skip = 0;
-    if (tail_count != UINT_MAX)
+    if (regex && !std::regex_search(begin, end, *regex))
+        return false;
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+// Accepts seconds since the epoch, or a local date and time such as
+// "2022-03-14", "2022-03-14 15:09", or "2022-03-14T15:09:26".
+bool parse_history_time(const char* arg, time_t& out)
+{
+    if (!arg || !*arg)
+        return false;
+
+    const char* c = arg;
+    while (*c >= '0' && *c <= '9')
+        ++c;
+    if (!*c)
     {
-        history_db::iter iter = history->read_lines(buffer.data(), buffer.size());
-        while (iter.next(line))
-            ++count;
-        if (count > tail_count)
-            skip = count - tail_count;
+        out = time_t(_atoi64(arg));
+        return true;
+    }
+
+    struct tm tm = {};
+    int len = 0;
+    if (sscanf(arg, "%d-%d-%d%n", &tm.tm_year, &tm.tm_mon, &tm.tm_mday, &len) != 3)
+        return false;
+
+    const char* rest = arg + len;
+    if (*rest)
+    {
+        if (*rest != ' ' && *rest != 'T')
+            return false;
+        ++rest;
+        len = 0;
+        if (sscanf(rest, "%d:%d%n:%d%n", &tm.tm_hour, &tm.tm_min, &len, &tm.tm_sec, &len) < 2 || rest[len])
+            return false;
     }
 
-    unsigned int index = 1;
-    history_db::iter iter = history->read_lines(buffer.data(), buffer.size());
+    // mktime() would quietly normalize out of range fields.
+    if (tm.tm_mon < 1 || tm.tm_mon > 12 || tm.tm_mday < 1 || tm.tm_mday > 31 ||
+        tm.tm_hour < 0 || tm.tm_hour > 23 || tm.tm_min < 0 || tm.tm_min > 59 ||
+        tm.tm_sec < 0 || tm.tm_sec > 59)
+        return false;
+
+    tm.tm_year -= 1900;
+    tm.tm_mon -= 1;
+    tm.tm_isdst = -1;
+    out = mktime(&tm);
+    return out != time_t(-1);
+}
+
+//------------------------------------------------------------------------------
+struct history_item
+{
+    unsigned int    index;
+    unsigned int    bank;
+    str_moveable    line;
+    str_moveable    timestamp;
+};
+
+//------------------------------------------------------------------------------
+static void print_history(unsigned int tail_count, bool bare)
+{
+    history_scope history;
+
+    str_iter line;
+    history_read_buffer buffer;
 
-    for (unsigned int i = 0; i < skip; ++i, ++index, iter.next(line));
+    // A tail count applies to the items that pass the filter, so filtering
+    // has to scan from the beginning.  Otherwise seek to the tail, and only
+    // count the items ahead of it when they're going to be numbered.
+    const bool filtered = !s_filter.empty();
+    unsigned int skipped = 0;
+    history_db::iter iter = history->read_tail(buffer.data(), buffer.size(), filtered ? UINT_MAX : tail_count, bare ? nullptr : &skipped);
+    unsigned int index = 1 + skipped;
 
     char timebuf[128];
-    str<> utf8;
-    wstr<> utf16;
-    HANDLE hout = GetStdHandle(STD_OUTPUT_HANDLE);
-    bool translate = is_console(hout);
+    history_writer out(stdout);
 
     unsigned int timelen = 0;
     struct tm tm = {};
@@ -166,36 +296,91 @@ static void print_history(unsigned int tail_count, bool bare)
         timelen = cell_count(timebuf);
     }
 
-    str<32> timestamp;
+    str<> prefix;
     unsigned int num_from[2] = {};
-    for (; iter.next(line, &timestamp); ++index)
+    auto print_item = [&] (unsigned int number, unsigned int bank, const char* text, unsigned int len, const str_base& timestamp)
     {
         if (s_diag)
         {
-            assert(iter.get_bank() < sizeof_array(num_from));
-            num_from[iter.get_bank()]++;
+            assert(bank < sizeof_array(num_from));
+            num_from[bank]++;
         }
 
-        utf8.clear();
-        if (bare)
-            utf8.format("%.*s", line.length(), line.get_pointer());
-        else if (!s_showtime)
-            utf8.format("%5u  %.*s", index, line.length(), line.get_pointer());
-        else
+        if (!bare)
         {
-            timebuf[0] = '\0';
-            if (!timestamp.empty())
+            if (!s_showtime)
+            {
+                prefix.format("%5u  ", number);
+            }
+            else
             {
-                const time_t tt = time_t(atoi(timestamp.c_str()));
-                if (localtime_s(&tm, &tt) == 0)
-                    strftime(timebuf, sizeof_array(timebuf), s_timeformat.c_str(), &tm);
+                timebuf[0] = '\0';
+                if (!timestamp.empty())
+                {
+                    const time_t tt = time_t(atoi(timestamp.c_str()));
+                    if (localtime_s(&tm, &tt) == 0)
+                        strftime(timebuf, sizeof_array(timebuf), s_timeformat.c_str(), &tm);
+                }
+                prefix.format("%5u  %-*s", number, timelen, timebuf);
             }
-            utf8.format("%5u  %-*s%.*s", index, timelen, timebuf, line.length(), line.get_pointer());
+            out.append(prefix.c_str(), prefix.length());
+        }
+
+        out.append(text, len);
+        out.end_line();
+    };
+
+    // When a filter is combined with a tail count, only the last tail_count
+    // matches are kept.
+    std::vector<history_item> ring;
+    unsigned int ring_next = 0;
+    const bool keep_tail = filtered && tail_count != UINT_MAX;
+    if (keep_tail)
+        ring.reserve(min<unsigned int>(tail_count, 1024));
+
+    str<32> timestamp;
+    for (; iter.next(line, &timestamp); ++index)
+    {
+        if (filtered && !s_filter.test(line, timestamp))
+            continue;
+
+        if (!keep_tail)
+        {
+            print_item(index, iter.get_bank(), line.get_pointer(), line.length(), timestamp);
+            continue;
+        }
+
+        if (!tail_count)
+            break;
+
+        history_item* item;
+        if (ring.size() < tail_count)
+        {
+            ring.emplace_back();
+            item = &ring.back();
         }
+        else
+        {
+            item = &ring[ring_next];
+            ring_next = (ring_next + 1) % tail_count;
+        }
+
+        item->index = index;
+        item->bank = iter.get_bank();
+        item->line.clear();
+        item->line.concat(line.get_pointer(), int(line.length()));
+        item->timestamp = timestamp.c_str();
+    }
 
-        print_history_item(hout, utf8.c_str(), translate ? &utf16 : nullptr);
+    // Once the ring is full, ring_next is the oldest item.
+    for (unsigned int i = 0; i < ring.size(); ++i)
+    {
+        const history_item& item = ring[(ring_next + i) % ring.size()];
+        print_item(item.index, item.bank, item.line.c_str(), item.line.length(), item.timestamp);
     }
 
+    out.flush();
+
     if (s_diag)
     {
         if (history->has_bank(bank_master))
@@ -322,7 +507,11 @@ static int print_help()
     static const char* const help_options[] = {
         "--bare",        "Omit item numbers when printing history.",
         "--diag",        "Print diagnostic info to stderr.",
+        "--match <text>", "Only print items containing the text.",
+        "--regex <expr>", "Only print items matching the regular expression.",
         "--show-time",   "Show history item timestamps, if any.",
+        "--since <time>", "Only print items at or after the time.",
+        "--until <time>", "Only print items before the time.",
         "--time-format", "Override the format string for showing timestamps.",
         "--unique",      "Remove duplicates when compacting history.",
         nullptr
@@ -340,6 +529,11 @@ static int print_help()
     puts("The 'history' command can also emulate Bash's builtin history command. The\n"
         "arguments -c, -d <n>, -p <...> and -s <...> are supported.\n");
 
+    puts("The --since and --until options accept a local time such as 2022-03-14,\n"
+         "2022-03-14T15:09, or 2022-03-14T15:09:26, or seconds since 1970.  Items\n"
+         "without timestamps are omitted when either is used.  When filtering, [n]\n"
+         "prints only the last N items that match.\n");
+
     puts("The 'history compact' command can shrink the history file by removing any\n"
          "leftover placeholders for deleted items.  Use 'history compact <n>' to also\n"
          "prune the history to no more than N items.");
@@ -443,6 +637,37 @@ int history(int argc, char** argv)
             s_timeformat = argv[++i];
             remove++;
         }
+        else if (is_flag(argv[i], "--match", 3) || is_flag(argv[i], "--regex", 3))
+        {
+            const char* flag = argv[i];
+            const char* value = argv[++i];
+            if (!value || !*value)
+            {
+                fprintf(stderr, "history: argument required for option '%s'\n", flag);
+                return print_help();
+            }
+            if (flag[2] == 'm')
+            {
+                s_filter.text = value;
+            }
+            else if (!s_filter.set_regex(value))
+            {
+                fprintf(stderr, "history: invalid regular expression '%s'\n", value);
+                return 1;
+            }
+            remove++;
+        }
+        else if (is_flag(argv[i], "--since", 3) || is_flag(argv[i], "--until", 3))
+        {
+            const char* flag = argv[i];
+            const char* value = argv[++i];
+            if (!parse_history_time(value, (flag[2] == 's') ? s_filter.since : s_filter.until))
+            {
+                fprintf(stderr, "history: option '%s' requires a time, e.g. 2022-03-14 or 2022-03-14T15:09\n", flag);
+                return print_help();
+            }
+            remove++;
+        }
         else
             remove = 0;
 
@@ -0,0 +1,52 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <core/str.h>
+#include <core/str_iter.h>
+
+#include <stdio.h>
+#include <time.h>
+#include <memory>
+#include <regex>
+
+//------------------------------------------------------------------------------
+// Collects output and writes it in large blocks, instead of making a console
+// write for each history item.  Console output is translated to UTF16 and
+// control characters are shown as ^X.
+class history_writer
+{
+public:
+                    history_writer(FILE* file);
+                    ~history_writer() { flush(); }
+    void            append(const char* text, unsigned int len);
+    void            end_line();
+    void            flush();
+
+private:
+    static const unsigned int c_flush_size = 32768;
+    FILE*           m_file;
+    HANDLE          m_hout;
+    bool            m_console;
+    str_moveable    m_utf8;
+    wstr_moveable   m_utf16;
+};
+
+//------------------------------------------------------------------------------
+// Filters applied while scanning the history, so nothing is formatted or
+// written for items that don't match.
+struct history_filter
+{
+    bool            empty() const { return text.empty() && !regex && !since && !until; }
+    bool            set_regex(const char* expr);
+    bool            test(const str_iter& line, const str_base& timestamp) const;
+
+    str_moveable    text;
+    std::unique_ptr<std::regex> regex;
+    time_t          since = 0;
+    time_t          until = 0;
+};
+
+//------------------------------------------------------------------------------
+bool parse_history_time(const char* arg, time_t& out);
@@ -159,6 +159,20 @@ int clink_info(int argc, char** argv)
         }
     }
 
+    // Keystroke latency stats, saved by the session after each input line.
+    {
+        str<280> perf_file;
+        context->get_perf_stats_path(perf_file);
+        if (FILE* f = fopen(perf_file.c_str(), "rt"))
+        {
+            printf("\nkeystroke latency:\n");
+            char buffer[256];
+            while (fgets(buffer, sizeof(buffer), f))
+                printf("  %s", buffer);
+            fclose(f);
+        }
+    }
+
     // Automatic updates.
     {
         DWORD type;
@@ -674,6 +674,10 @@ int inject(int argc, char** argv)
         return ret;
     }
 
+    // Write out pending log messages before the DLL restarts the log file.
+    if (logger* logger = logger::get())
+        logger->flush();
+
     // Inject Clink's DLL
     remote_result remote_dll_base = inject_dll(target_pid, is_autorun, app_desc.force);
     if (remote_dll_base.ok <= 0)
@@ -7,6 +7,7 @@
 #include "version.h"
 
 #include <core/base.h>
+#include <core/log.h>
 #include <core/str.h>
 #include <core/str_iter.h>
 #include <terminal/ecma48_wrapper.h>
@@ -221,6 +222,13 @@ int loader(int argc, char** argv)
         // it when simulating an injected scenario.
         app_context* context = new app_context(app_desc);
         ret = dispatch_verb(argv[optind], argc - optind, argv + optind);
+
+        // Stop the logger's thread here rather than at exit; the loader runs
+        // inside the DLL, where joining a thread during DLL_PROCESS_DETACH can
+        // deadlock on the loader lock.
+        if (logger* logger = logger::get())
+            delete logger;
+
         delete context;
     }
     else
@@ -213,6 +213,16 @@ void app_context::get_log_path(str_base& out) const
     path::append(out, "clink.log");
 }
 
+//------------------------------------------------------------------------------
+void app_context::get_perf_stats_path(str_base& out) const
+{
+    get_state_dir(out);
+
+    str<32> name;
+    name.format("clink_perf_%d.txt", get_id());
+    path::append(out, name.c_str());
+}
+
 //------------------------------------------------------------------------------
 void app_context::get_default_settings_file(str_base& out) const
 {
@@ -33,6 +33,7 @@ public:
     void        get_state_dir(str_base& out) const;
     void        get_autostart_command(str_base& out) const;
     void        get_log_path(str_base& out) const;
+    void        get_perf_stats_path(str_base& out) const;
     void        get_default_settings_file(str_base& out) const;
     void        get_settings_path(str_base& out) const;
     void        get_history_path(str_base& out) const;
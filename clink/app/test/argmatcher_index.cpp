@@ -0,0 +1,158 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "fs_fixture.h"
+
+#include <core/globber.h>
+#include <core/os.h>
+#include <core/path.h>
+#include <core/str.h>
+#include <host/argmatcher_index.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Argmatcher index : scan")
+{
+    str<> commands;
+
+    SECTION("Argmatcher only")
+    {
+        REQUIRE(argmatcher_index::scan(
+            "local function foo() return {} end\n"
+            "clink.argmatcher(\"abc\", 'def')\n"
+            ":addarg(foo)\n"
+            "clink.argmatcher \"xyz\"\n"
+            "clink.argmatcher(10, \"pqr\"):addflags(\"-a\")\n", commands));
+        REQUIRE(commands.equals("abc;def;xyz;pqr"));
+    }
+
+    SECTION("Not argmatchers")
+    {
+        REQUIRE(!argmatcher_index::scan("local x = 1\n", commands));
+        REQUIRE(!argmatcher_index::scan("clink.argmatcher(name)\n", commands));
+        REQUIRE(!argmatcher_index::scan("clink.argmatcher()\n", commands));
+    }
+
+    SECTION("Side effects")
+    {
+        REQUIRE(!argmatcher_index::scan("clink.argmatcher(\"abc\")\nclink.onbeginedit(function() end)\n", commands));
+        REQUIRE(!argmatcher_index::scan("local m = require('abc')\nclink.argmatcher(\"abc\")\n", commands));
+        REQUIRE(!argmatcher_index::scan("function helper() end\nclink.argmatcher(\"abc\")\n", commands));
+        REQUIRE(!argmatcher_index::scan("shared = {}\nclink.argmatcher(\"abc\")\n", commands));
+        REQUIRE(!argmatcher_index::scan("function shared.helper() end\nclink.argmatcher(\"abc\")\n", commands));
+        REQUIRE(!argmatcher_index::scan("function shared:helper() end\nclink.argmatcher(\"abc\")\n", commands));
+        REQUIRE(!argmatcher_index::scan("local x = helper()\nclink.argmatcher(\"abc\")\n", commands));
+        REQUIRE(!argmatcher_index::scan("helper 'abc'\nclink.argmatcher(\"abc\")\n", commands));
+        REQUIRE(!argmatcher_index::scan("clink.argmatcher(\"abc\")\n    :addarg(helper())\n", commands));
+    }
+
+    SECTION("No side effects")
+    {
+        REQUIRE(argmatcher_index::scan("local args = { 'a', 'b' }\nclink.argmatcher(\"abc\"):addarg(args)\n", commands));
+        REQUIRE(argmatcher_index::scan("local function f()\n    return helper()\nend\nclink.argmatcher(\"abc\") -- helper()\n", commands));
+        REQUIRE(commands.equals("abc"));
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Argmatcher index : invalidation")
+{
+    static const char* lazy_fs[] = {
+        "scripts/abc.lua",
+        "scripts/other.lua",
+        nullptr,
+    };
+
+    fs_fixture fs(lazy_fs);
+
+    str<> dir;
+    os::get_current_dir(dir);
+    path::append(dir, "scripts");
+
+    str<> abc(dir.c_str());
+    path::append(abc, "abc.lua");
+
+    {
+        FILE* f = fopen(abc.c_str(), "wt");
+        REQUIRE(f);
+        fputs("clink.argmatcher(\"abc\")\n", f);
+        fclose(f);
+    }
+
+    argmatcher_index index;
+    index.load(nullptr);
+
+    str<> commands;
+    index.begin_dir(dir.c_str());
+    REQUIRE(index.get_commands(abc.c_str(), 1, commands));
+    REQUIRE(commands.equals("abc"));
+    REQUIRE(index.get_scanned_count() == 1);
+
+    // Same timestamp reuses the previous scan.
+    index.begin_dir(dir.c_str());
+    REQUIRE(index.get_commands(abc.c_str(), 1, commands));
+    REQUIRE(index.get_scanned_count() == 1);
+
+    // A new timestamp rescans.
+    {
+        FILE* f = fopen(abc.c_str(), "wt");
+        REQUIRE(f);
+        fputs("clink.argmatcher(\"abc\")\nclink.onbeginedit(function() end)\n", f);
+        fclose(f);
+    }
+    REQUIRE(!index.get_commands(abc.c_str(), 2, commands));
+    REQUIRE(index.get_scanned_count() == 2);
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Argmatcher index : save")
+{
+    static const char* lazy_fs[] = {
+        "scripts/abc.lua",
+        nullptr,
+    };
+
+    fs_fixture fs(lazy_fs);
+
+    str<> root;
+    os::get_current_dir(root);
+
+    str<> dir(root.c_str());
+    path::append(dir, "scripts");
+
+    str<> abc(dir.c_str());
+    path::append(abc, "abc.lua");
+
+    {
+        FILE* f = fopen(abc.c_str(), "wt");
+        REQUIRE(f);
+        fputs("clink.argmatcher(\"abc\")\n", f);
+        fclose(f);
+    }
+
+    str<> file(root.c_str());
+    path::append(file, "argmatcher_index");
+
+    str<> commands;
+    {
+        argmatcher_index index;
+        index.load(file.c_str());
+        index.begin_dir(dir.c_str());
+        REQUIRE(index.get_commands(abc.c_str(), 1, commands));
+        REQUIRE(index.save());
+    }
+
+    // The index replaces the temporary file it was written to.
+    str<> pattern(root.c_str());
+    path::append(pattern, "*.tmp");
+    globber tmp_files(pattern.c_str());
+    str<> tmp;
+    REQUIRE(!tmp_files.next(tmp));
+
+    argmatcher_index index;
+    index.load(file.c_str());
+    index.begin_dir(dir.c_str());
+    REQUIRE(index.get_commands(abc.c_str(), 1, commands));
+    REQUIRE(commands.equals("abc"));
+    REQUIRE(index.get_scanned_count() == 0);
+}
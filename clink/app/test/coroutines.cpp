@@ -5,6 +5,7 @@
 #include "fs_fixture.h"
 
 #include <core/base.h>
+#include <core/os.h>
 #include <core/str.h>
 #include <core/path.h>
 #include <core/settings.h>
@@ -75,6 +76,25 @@ static bool verify_ret_true(lua_state& lua, const char* func_name)
     return lua_toboolean(state, -1);
 }
 
+//------------------------------------------------------------------------------
+static int get_global_int(lua_state& lua, const char* name)
+{
+    lua_State* state = lua.get_state();
+    lua_getglobal(state, name);
+    const int value = int(lua_tointeger(state, -1));
+    lua_pop(state, 1);
+    return value;
+}
+
+//------------------------------------------------------------------------------
+static void write_file(const char* name, const char* content)
+{
+    FILE* file = fopen(name, "w");
+    REQUIRE(file);
+    fputs(content, file);
+    fclose(file);
+}
+
 //------------------------------------------------------------------------------
 TEST_CASE("Lua coroutines.")
 {
@@ -463,3 +483,136 @@ TEST_CASE("Lua coroutines.")
 
     set_autosuggest_async_default();
 }
+
+//------------------------------------------------------------------------------
+TEST_CASE("Prompt filter cache.")
+{
+    fs_fixture fs;
+
+    lua_state lua;
+    prompt_filter prompt_filter(lua);
+    lua_load_script(lua, app, prompt);
+
+    const char* script = "\
+    _calls = 0\
+    os.setenv('CLINK_TEST_CACHEKEY', 'abc')\
+    \
+    _pf = clink.promptfilter(1)\
+    _pf.cachekeys = { 'cwd', 'errorlevel', 'env:CLINK_TEST_CACHEKEY' }\
+    function _pf:filter(prompt)\
+        _calls = _calls + 1\
+        return prompt..'|'.._calls\
+    end\
+    \
+    function verify_unknown_key()\
+        local msg = ''\
+        local old_print = print\
+        print = function(s) msg = msg..tostring(s or '') end\
+        local ret = clink._filter_prompt('x', '')\
+        print = old_print\
+        return (ret == false and _calls == 1 and\
+                msg:find(\"unrecognized prompt filter cache key 'bogus'\", 1, true) ~= nil)\
+    end\
+    ";
+
+    REQUIRE(lua.do_string(script));
+    os::set_errorlevel(0);
+
+    str<> out;
+    lua.send_event("onbeginedit");
+    prompt_filter.filter("x", out);
+    REQUIRE(out.equals("x|1"));
+
+    SECTION("Hit")
+    {
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|1"));
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|1"));
+        REQUIRE(get_global_int(lua, "_calls") == 1);
+    }
+
+    SECTION("Prompt changed")
+    {
+        prompt_filter.filter("y", out);
+        REQUIRE(out.equals("y|2"));
+    }
+
+    SECTION("Cwd changed")
+    {
+        REQUIRE(lua.do_string("os.chdir('dir1')"));
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|2"));
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|2"));
+    }
+
+    SECTION("Errorlevel changed")
+    {
+        os::set_errorlevel(1);
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|2"));
+    }
+
+    SECTION("Env changed")
+    {
+        REQUIRE(lua.do_string("os.setenv('CLINK_TEST_CACHEKEY', 'xyz')"));
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|2"));
+
+        // Removing the variable is a change as well.
+        REQUIRE(lua.do_string("os.setenv('CLINK_TEST_CACHEKEY')"));
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|3"));
+    }
+
+    SECTION("Githead")
+    {
+        REQUIRE(os::make_dir(".git/refs/heads"));
+        write_file(".git/HEAD", "ref: refs/heads/main\n");
+        write_file(".git/refs/heads/main", "1111111111111111111111111111111111111111\n");
+        REQUIRE(lua.do_string("_pf.cachekeys = 'githead'"));
+
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|2"));
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|2"));
+
+        // A commit on the current branch only changes the branch's ref.
+        write_file(".git/refs/heads/main", "2222222222222222222222222222222222222222\n");
+        prompt_filter.filter("x", out);
+        REQUIRE(out.equals("x|3"));
+    }
+
+    SECTION("Unknown key")
+    {
+        REQUIRE(lua.do_string("_pf.cachekeys = { 'cwd', 'bogus' }"));
+        REQUIRE(verify_ret_true(lua, "verify_unknown_key"));
+    }
+
+    SECTION("Prompt coroutine")
+    {
+        // Output isn't stored while the filter has a prompt coroutine, since
+        // the output changes when the coroutine finishes.
+        set_prompt_async(true);
+
+        const char* co_script = "\
+        function _pf:filter(prompt)\
+            _calls = _calls + 1\
+            local result = clink.promptcoroutine(function() return 'done' end)\
+            return (result or prompt)..'|'.._calls\
+        end\
+        ";
+
+        REQUIRE(lua.do_string(co_script));
+        prompt_filter.filter("y", out);
+        REQUIRE(out.equals("y|2"));
+        prompt_filter.filter("y", out);
+        REQUIRE(out.equals("y|3"));
+
+        set_prompt_async_default();
+    }
+
+    lua.do_string("os.setenv('CLINK_TEST_CACHEKEY')");
+    os::set_errorlevel(0);
+}
@@ -12,6 +12,7 @@
 #include <core/settings.h>
 #include <core/str.h>
 #include <lib/history_db.h>
+#include <loader/history.h>
 #include <utils/app_context.h>
 
 #include <initializer_list>
@@ -926,3 +927,457 @@ TEST_CASE("history removals ctag")
         }
     }
 }
+
+//------------------------------------------------------------------------------
+// Shared setup for the read_tail() and lazy load tests:  a shared history with
+// timestamps, with or without the history index.  Settings are restored even
+// when a test fails.
+static const char* const c_tail_lines[] = {
+    "cmd1", "cmd2", "cmd3", "cmd4", "cmd5", "cmd6",
+};
+
+struct tail_fixture
+{
+    static const char*  empty_fs[];
+    static const char*  env_desc[];
+
+    static app_context::desc make_desc(const fs_fixture& fs)
+    {
+        app_context::desc context_desc;
+        context_desc.inherit_id = true;
+        str_base(context_desc.state_dir).copy(fs.get_root());
+        return context_desc;
+    }
+
+    tail_fixture(bool index, const char* lazy_load="0")
+    : fs(empty_fs)
+    , env(env_desc)
+    , context(make_desc(fs))
+    {
+        settings::find("history.shared")->set("true");
+        settings::find("history.max_lines")->set("0");
+        settings::find("history.dupe_mode")->set("add");
+        settings::find("history.time_stamp")->set("save");
+        settings::find("history.index")->set(index ? "true" : "false");
+        settings::find("history.lazy_load")->set(lazy_load);
+    }
+
+    ~tail_fixture()
+    {
+        static const char* const c_names[] = {
+            "history.shared", "history.max_lines", "history.dupe_mode",
+            "history.time_stamp", "history.index", "history.lazy_load",
+        };
+        for (const char* name : c_names)
+            settings::find(name)->set();
+        clear_history();
+    }
+
+    fs_fixture          fs;
+    env_fixture         env;    // Sets the state id to something explicit.
+    app_context         context;
+};
+
+const char* tail_fixture::empty_fs[] = { nullptr };
+const char* tail_fixture::env_desc[] = { "=clink.id", "493", nullptr };
+
+//------------------------------------------------------------------------------
+TEST_CASE("history index")
+{
+    const char* master_path = "clink_history";
+    const char* index_path = "clink_history.idx";
+
+    tail_fixture fixture(true/*index*/);
+
+    test_history_db history;
+    for (const char* line : c_tail_lines)
+        REQUIRE(history.add(line));
+
+    expect_files({master_path, index_path}, false);
+
+    char buffer[1024];
+    str_iter line;
+    str<32> timestamp;
+    unsigned int skipped;
+
+    SECTION("Tail")
+    {
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 2, &skipped);
+        REQUIRE(skipped == 4);
+        REQUIRE(iter.next(line, &timestamp));
+        REQUIRE(line.length() == 4);
+        REQUIRE(strncmp(line.get_pointer(), "cmd5", 4) == 0);
+        REQUIRE(!timestamp.empty());
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+        REQUIRE(!iter.next(line));
+    }
+
+    SECTION("All")
+    {
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 10, &skipped);
+        REQUIRE(skipped == 0);
+        for (const char* expected : c_tail_lines)
+        {
+            REQUIRE(iter.next(line));
+            REQUIRE(strncmp(line.get_pointer(), expected, line.length()) == 0);
+        }
+        REQUIRE(!iter.next(line));
+    }
+
+    SECTION("Tombstone")
+    {
+        REQUIRE(history.remove(c_tail_lines[4]) == 1);
+
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 2, &skipped);
+        REQUIRE(skipped == 3);
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd4", 4) == 0);
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+        REQUIRE(!iter.next(line));
+    }
+
+    SECTION("Foreign tombstone")
+    {
+        const int index_size = os::get_file_size(index_path);
+
+        // Something that doesn't maintain the index, such as an older version,
+        // writes a tombstone in place.  That doesn't change the size of the
+        // bank, only its write time.
+        HANDLE h = CreateFileW(L"clink_history", GENERIC_READ|GENERIC_WRITE, FILE_SHARE_READ|FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr);
+        REQUIRE(h != INVALID_HANDLE_VALUE);
+        DWORD bytes;
+        char content[1024];
+        REQUIRE(ReadFile(h, content, sizeof(content) - 1, &bytes, nullptr));
+        content[bytes] = '\0';
+        const char* found = strstr(content, "\ncmd5\n");
+        REQUIRE(found);
+        SetFilePointer(h, LONG(found + 1 - content), nullptr, FILE_BEGIN);
+        REQUIRE(WriteFile(h, "|", 1, &bytes, nullptr));
+        FILETIME ft;
+        REQUIRE(GetFileTime(h, nullptr, nullptr, &ft));
+        ft.dwHighDateTime++;
+        REQUIRE(SetFileTime(h, nullptr, nullptr, &ft));
+        CloseHandle(h);
+
+        // The stale index is ignored.
+        {
+            history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 2, &skipped);
+            REQUIRE(skipped == 3);
+            REQUIRE(iter.next(line));
+            REQUIRE(strncmp(line.get_pointer(), "cmd4", 4) == 0);
+            REQUIRE(iter.next(line));
+            REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+            REQUIRE(!iter.next(line));
+        }
+
+        // The next writer rebuilds it without the tombstoned line, instead of
+        // only appending a record.
+        REQUIRE(history.add("cmd7"));
+        REQUIRE(os::get_file_size(index_path) == index_size);
+        {
+            history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 2, &skipped);
+            REQUIRE(skipped == 4);
+            REQUIRE(iter.next(line));
+            REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+            REQUIRE(iter.next(line));
+            REQUIRE(strncmp(line.get_pointer(), "cmd7", 4) == 0);
+            REQUIRE(!iter.next(line));
+        }
+    }
+
+    SECTION("Compact")
+    {
+        REQUIRE(history.remove(c_tail_lines[0]) == 1);
+        history.compact(true/*force*/);
+
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 1, &skipped);
+        REQUIRE(skipped == 4);
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+        REQUIRE(!iter.next(line));
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("history tail")
+{
+    tail_fixture fixture(false/*index*/);
+
+    test_history_db history;
+    for (const char* line : c_tail_lines)
+        REQUIRE(history.add(line));
+
+    char buffer[1024];
+    str_iter line;
+    str<32> timestamp;
+    unsigned int skipped;
+
+    SECTION("Tail")
+    {
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 2, &skipped);
+        REQUIRE(skipped == 4);
+        REQUIRE(iter.next(line, &timestamp));
+        REQUIRE(strncmp(line.get_pointer(), "cmd5", 4) == 0);
+        REQUIRE(!timestamp.empty());
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+        REQUIRE(!iter.next(line));
+    }
+
+    SECTION("Uncounted")
+    {
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 1);
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+        REQUIRE(!iter.next(line));
+    }
+
+    SECTION("All")
+    {
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 10, &skipped);
+        REQUIRE(skipped == 0);
+        for (const char* expected : c_tail_lines)
+        {
+            REQUIRE(iter.next(line));
+            REQUIRE(strncmp(line.get_pointer(), expected, line.length()) == 0);
+        }
+        REQUIRE(!iter.next(line));
+    }
+
+    SECTION("Removed")
+    {
+        REQUIRE(history.remove(c_tail_lines[4]) == 1);
+        REQUIRE(history.remove(c_tail_lines[1]) == 1);
+
+        history_db::iter iter = history.read_tail(buffer, sizeof(buffer), 2, &skipped);
+        REQUIRE(skipped == 2);
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd4", 4) == 0);
+        REQUIRE(iter.next(line));
+        REQUIRE(strncmp(line.get_pointer(), "cmd6", 4) == 0);
+        REQUIRE(!iter.next(line));
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("history filter")
+{
+    history_filter filter;
+    str<32> timestamp;
+    REQUIRE(filter.empty());
+
+    auto test = [&] (const char* line, const char* time="")
+    {
+        timestamp = time;
+        return filter.test(str_iter(line), timestamp);
+    };
+
+    SECTION("Match")
+    {
+        filter.text = "abc";
+        REQUIRE(!filter.empty());
+        REQUIRE(test("xabcx"));
+        REQUIRE(test("abc"));
+        REQUIRE(!test("ABC"));
+        REQUIRE(!test("ab c"));
+    }
+
+    SECTION("Regex")
+    {
+        REQUIRE(filter.set_regex("^git (push|pull)"));
+        REQUIRE(!filter.empty());
+        REQUIRE(test("git push origin"));
+        REQUIRE(test("git pull"));
+        REQUIRE(!test("git status"));
+        REQUIRE(!test(" git push"));
+    }
+
+    SECTION("Invalid regex")
+    {
+        REQUIRE(!filter.set_regex("(abc"));
+        REQUIRE(!filter.set_regex("[z-a]"));
+        REQUIRE(filter.empty());
+    }
+
+    SECTION("Since and until")
+    {
+        filter.since = 1000;
+        filter.until = 2000;
+        REQUIRE(!test("cmd"));
+        REQUIRE(!test("cmd", "999"));
+        REQUIRE(test("cmd", "1000"));
+        REQUIRE(test("cmd", "1999"));
+        REQUIRE(!test("cmd", "2000"));
+    }
+
+    SECTION("Combined")
+    {
+        filter.text = "dir";
+        REQUIRE(filter.set_regex("/s$"));
+        filter.since = 1000;
+        REQUIRE(test("dir /s", "1000"));
+        REQUIRE(!test("dir /s", "999"));
+        REQUIRE(!test("dir /b", "1000"));
+        REQUIRE(!test("del /s", "1000"));
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("history parse time")
+{
+    time_t tt = 0;
+
+    SECTION("Seconds")
+    {
+        REQUIRE(parse_history_time("1647270000", tt));
+        REQUIRE(tt == 1647270000);
+        REQUIRE(parse_history_time("0", tt));
+        REQUIRE(tt == 0);
+    }
+
+    SECTION("Local time")
+    {
+        struct tm tm = {};
+        tm.tm_year = 2022 - 1900;
+        tm.tm_mon = 2;
+        tm.tm_mday = 14;
+        tm.tm_isdst = -1;
+        const time_t date = mktime(&tm);
+
+        REQUIRE(parse_history_time("2022-03-14", tt));
+        REQUIRE(tt == date);
+        REQUIRE(parse_history_time("2022-03-14 15:09", tt));
+        REQUIRE(tt == date + 15 * 3600 + 9 * 60);
+        REQUIRE(parse_history_time("2022-03-14T15:09:26", tt));
+        REQUIRE(tt == date + 15 * 3600 + 9 * 60 + 26);
+    }
+
+    SECTION("Invalid")
+    {
+        tt = 42;
+        REQUIRE(!parse_history_time(nullptr, tt));
+        REQUIRE(!parse_history_time("", tt));
+        REQUIRE(!parse_history_time("yesterday", tt));
+        REQUIRE(!parse_history_time("2022-03", tt));
+        REQUIRE(!parse_history_time("2022-03-14x", tt));
+        REQUIRE(!parse_history_time("2022-03-14T15", tt));
+        REQUIRE(!parse_history_time("2022-03-14T15:09junk", tt));
+        REQUIRE(!parse_history_time("2022-03-14T15:09:26:00", tt));
+        REQUIRE(!parse_history_time("2022-13-14", tt));
+        REQUIRE(!parse_history_time("2022-03-14T24:00", tt));
+        REQUIRE(tt == 42);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("history writer")
+{
+    const char* empty_fs[] = { nullptr };
+    fs_fixture fs(empty_fs);
+
+    str<> path;
+    path << fs.get_root() << "\\out.txt";
+
+    auto read_back = [&] (str_base& out)
+    {
+        out.clear();
+        FILE* file = fopen(path.c_str(), "rb");
+        REQUIRE(file);
+        char tmp[256];
+        for (size_t len; (len = fread(tmp, 1, sizeof(tmp), file)) > 0;)
+            out.concat(tmp, int(len));
+        fclose(file);
+    };
+
+    FILE* file = fopen(path.c_str(), "wb");
+    REQUIRE(file);
+
+    SECTION("Passthrough")
+    {
+        // Output that isn't a console is written as is, including control
+        // characters, and is flushed when the writer goes out of scope.
+        {
+            history_writer out(file);
+            out.append("cmd\x01one", 7);
+            out.end_line();
+            out.append("cmd two", 7);
+            out.end_line();
+            REQUIRE(ftell(file) == 0);
+        }
+        fclose(file);
+
+        str<> text;
+        read_back(text);
+        REQUIRE(text.equals("cmd\x01one\ncmd two\n"));
+    }
+
+    SECTION("Blocks")
+    {
+        str<> line;
+        while (line.length() < 20000)
+            line << "0123456789";
+
+        {
+            history_writer out(file);
+            out.append(line.c_str(), line.length());
+            out.end_line();
+            REQUIRE(ftell(file) == 0);
+            out.append(line.c_str(), line.length());
+            out.end_line();
+            REQUIRE(ftell(file) == long(line.length() + 1) * 2);
+        }
+        fclose(file);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("history lazy load")
+{
+    tail_fixture fixture(false/*index*/, "2"/*lazy_load*/);
+
+    test_history_db history;
+    for (const char* line : c_tail_lines)
+        REQUIRE(history.add(line));
+
+    history.load_rl_history(false);
+    REQUIRE(history.has_deferred_lines());
+    REQUIRE(history_length == 2);
+    REQUIRE(strcmp(history_get(1)->line, "cmd5") == 0);
+    REQUIRE(history_get(1)->timestamp);
+    REQUIRE(*history_get(1)->timestamp);
+    REQUIRE(strcmp(history_get(2)->line, "cmd6") == 0);
+
+    SECTION("Stable window")
+    {
+        REQUIRE(history.add("cmd7"));
+        history.load_rl_history(false);
+        REQUIRE(history_length == 3);
+        REQUIRE(strcmp(history_get(1)->line, "cmd5") == 0);
+        REQUIRE(strcmp(history_get(3)->line, "cmd7") == 0);
+    }
+
+    SECTION("Load deferred")
+    {
+        history_set_pos(1);
+        REQUIRE(history.load_deferred_lines() == 4);
+        REQUIRE(!history.has_deferred_lines());
+        REQUIRE(history.get_master_length() == 6);
+        REQUIRE(history_length == 6);
+        REQUIRE(where_history() == 5);
+        int index = 1;
+        for (const char* line : c_tail_lines)
+        {
+            REQUIRE(strcmp(history_get(index)->line, line) == 0);
+            REQUIRE(history_get(index)->timestamp);
+            ++index;
+        }
+
+        // The index map covers the deferred lines too.
+        REQUIRE(history.remove_by_index(0));
+        history.load_rl_history(false);
+        REQUIRE(history_length == 5);
+        REQUIRE(strcmp(history_get(1)->line, "cmd2") == 0);
+    }
+}
@@ -0,0 +1,70 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include "fs_fixture.h"
+#include "line_editor_tester.h"
+
+#include <core/settings.h>
+#include <lua/lua_match_generator.h>
+#include <lua/lua_word_classifier.h>
+#include <lua/lua_script_loader.h>
+#include <lua/lua_state.h>
+
+//------------------------------------------------------------------------------
+BENCHMARK("argmatcher")
+{
+    const char* empty_fs[] = { nullptr };
+    fs_fixture fs(empty_fs);
+
+    lua_state lua;
+    lua_match_generator lua_generator(lua); // This loads the required lua scripts.
+    lua_load_script(lua, app, cmd);
+    lua_load_script(lua, app, dir);
+    lua_word_classifier lua_classifier(lua);
+
+    // A large command with 200 subcommands, each with 50 flags and looping
+    // args, similar in size to argmatchers for tools like git.
+    const char* script = "\
+        local flags = {}\
+        for i = 1, 50 do\
+            table.insert(flags, '--flag'..i)\
+        end\
+        local subs = {}\
+        for i = 1, 200 do\
+            local sub = clink.argmatcher():addflags(flags):addarg('alpha', 'beta', 'gamma'):loop()\
+            table.insert(subs, ('sub'..i)..sub)\
+        end\
+        clink.argmatcher('benchcmd'):addflags('-a', '-b', '--help'):addarg(subs)\
+    ";
+    REQUIRE(lua.do_string(script));
+
+    settings::find("clink.colorize_input")->set("true");
+
+    line_editor::desc desc(nullptr, nullptr, nullptr, nullptr);
+    line_editor_tester tester(desc, "&|", nullptr);
+    tester.get_editor()->set_generator(lua_generator);
+    tester.get_editor()->set_classifier(lua_classifier);
+
+    b.measure("type_args", 20, [&] () {
+        tester.set_input("benchcmd -a sub150 --flag10 alpha --flag20 beta --flag30 gamma --flag40 alpha");
+        tester.replay();
+    });
+
+    b.measure("type_chained", 10, [&] () {
+        tester.set_input("benchcmd sub1 alpha & benchcmd sub2 beta | benchcmd sub3 --flag3 && benchcmd sub4 gamma");
+        tester.replay();
+    });
+
+    b.measure("tab_flags", 20, [&] () {
+        tester.set_input("benchcmd sub150 --flag1" DO_COMPLETE DO_COMPLETE);
+        tester.replay();
+    });
+
+    b.measure("tab_subcommands", 20, [&] () {
+        tester.set_input("benchcmd sub1" DO_COMPLETE DO_COMPLETE);
+        tester.replay();
+    });
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include <core/base.h>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+unsigned int bench::s_repeat = 1;
+
+//------------------------------------------------------------------------------
+bench::bench(const char* name, bench_func* func)
+: m_func(func)
+, m_name(name)
+{
+    if (get_head() == nullptr)
+        get_head() = this;
+
+    if (bench* tail = get_tail())
+        tail->m_next = this;
+    get_tail() = this;
+}
+
+//------------------------------------------------------------------------------
+long long bench::now()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+//------------------------------------------------------------------------------
+long long bench::alloc_number()
+{
+#ifdef USE_MEMORY_TRACKING
+    return (long long)dbggetallocnumber();
+#else
+    return -1;
+#endif
+}
+
+//------------------------------------------------------------------------------
+void bench::add_record(record&& rec)
+{
+    fprintf(stderr, "  %-24s %u iterations\n", rec.op, (unsigned int)rec.samples.size());
+    m_records.emplace_back(std::move(rec));
+}
+
+//------------------------------------------------------------------------------
+void bench::report(FILE* out, bool& first) const
+{
+    LARGE_INTEGER freq;
+    QueryPerformanceFrequency(&freq);
+
+    for (const record& rec : m_records)
+    {
+        std::vector<unsigned long long> us;
+        us.reserve(rec.samples.size());
+        unsigned long long total = 0;
+        for (unsigned long long ticks : rec.samples)
+        {
+            us.push_back(ticks * 1000000 / freq.QuadPart);
+            total += us.back();
+        }
+        std::sort(us.begin(), us.end());
+
+        const size_t n = us.size();
+        const auto pct = [&] (size_t p) { return us[min<size_t>(n - 1, (n * p + 99) / 100 - 1)]; };
+
+        fprintf(out, "%s\n    {\"bench\":\"%s\",\"op\":\"%s\",\"iterations\":%u,"
+                "\"min_us\":%llu,\"p50_us\":%llu,\"p95_us\":%llu,\"max_us\":%llu,\"mean_us\":%llu,",
+                first ? "" : ",", m_name, rec.op, (unsigned int)n,
+                us[0], pct(50), pct(95), us[n - 1], total / n);
+        if (rec.allocs < 0)
+            fputs("\"allocs\":null}", out);
+        else
+            fprintf(out, "\"allocs\":%lld}", rec.allocs);
+
+        first = false;
+    }
+}
+
+//------------------------------------------------------------------------------
+bool bench::run_all(const char* prefix, unsigned int repeat, FILE* out)
+{
+    s_repeat = max<unsigned int>(repeat, 1);
+
+    bool ok = true;
+    for (bench* b = get_head(); b != nullptr; b = b->m_next)
+    {
+        // Cheap lower-case prefix test.
+        const char* x = prefix, *y = b->m_name;
+        for (; *x && (*x & ~0x20) == (*y & ~0x20); ++x, ++y);
+        if (*x)
+            continue;
+
+        fprintf(stderr, "%s\n", b->m_name);
+
+        try
+        {
+            (b->m_func)(*b);
+        }
+        catch (...)
+        {
+            fprintf(stderr, "  FAILED\n");
+            ok = false;
+        }
+    }
+
+#if defined(_M_AMD64) || defined(__x86_64__)
+    static const char* const c_arch = "x64";
+#else
+    static const char* const c_arch = "x86";
+#endif
+#ifdef DEBUG
+    static const char* const c_config = "debug";
+#else
+    static const char* const c_config = "release";
+#endif
+
+    fprintf(out, "{\n  \"arch\":\"%s\",\n  \"config\":\"%s\",\n  \"results\":[", c_arch, c_config);
+    bool first = true;
+    for (bench* b = get_head(); b != nullptr; b = b->m_next)
+        b->report(out, first);
+    fputs("\n  ]\n}\n", out);
+
+    return ok;
+}
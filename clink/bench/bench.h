@@ -0,0 +1,83 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <core/debugheap.h>
+
+#include <stdio.h>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// A benchmark is a function that sets up a workload and calls measure() for
+// each operation it wants timed.  Each operation becomes one record in the
+// report, with latency percentiles across its iterations and the number of
+// allocations per iteration (only available when USE_MEMORY_TRACKING is
+// defined, i.e. debug builds).
+class bench
+{
+public:
+    typedef void    (bench_func)(bench&);
+
+                    bench(const char* name, bench_func* func);
+    const char*     get_name() const { return m_name; }
+    template <class F> void measure(const char* op, unsigned int iterations, F&& func);
+    static bool     run_all(const char* prefix, unsigned int repeat, FILE* out);
+
+private:
+    struct record
+    {
+        const char*                     op;
+        std::vector<unsigned long long> samples;
+        long long                       allocs;
+    };
+
+    static long long now();
+    static long long alloc_number();
+    void            add_record(record&& rec);
+    void            report(FILE* out, bool& first) const;
+
+    static bench*&  get_head() { static bench* s_head; return s_head; }
+    static bench*&  get_tail() { static bench* s_tail; return s_tail; }
+    bench*          m_next = nullptr;
+    bench_func*     m_func;
+    const char*     m_name;
+    std::vector<record> m_records;
+    static unsigned int s_repeat;
+};
+
+//------------------------------------------------------------------------------
+template <class F>
+void bench::measure(const char* op, unsigned int iterations, F&& func)
+{
+    // One untimed pass warms up caches and lazy initialization.
+    func();
+
+    iterations *= s_repeat;
+
+    record rec;
+    rec.op = op;
+    rec.samples.reserve(iterations);
+
+    const long long alloc_begin = alloc_number();
+    for (unsigned int i = 0; i < iterations; ++i)
+    {
+        const long long begin = now();
+        func();
+        rec.samples.push_back(now() - begin);
+    }
+    const long long alloc_end = alloc_number();
+
+    rec.allocs = (alloc_begin < 0) ? -1 : (alloc_end - alloc_begin) / iterations;
+    add_record(std::move(rec));
+}
+
+//------------------------------------------------------------------------------
+#define BENCH_IDENT__(d, b) _bench_##d##_##b
+#define BENCH_IDENT_(d, b)  BENCH_IDENT__(d, b)
+#define BENCH_IDENT(d)      BENCH_IDENT_(d, __LINE__)
+
+#define BENCHMARK(name)\
+    static void BENCH_IDENT(func)(bench&);\
+    static bench BENCH_IDENT(bench)(name, BENCH_IDENT(func));\
+    static void BENCH_IDENT(func)(bench& b)
@@ -0,0 +1,61 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include "column_widths.h"
+
+//------------------------------------------------------------------------------
+static void make_lens(unsigned int count, std::vector<width_t>& out)
+{
+    // Mostly short names with an occasional long one, like a directory.
+    unsigned int seed = 1;
+    out.clear();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        const unsigned int r = seed >> 16;
+        out.push_back(width_t((r % 64) ? 4 + r % 12 : 20 + r % 40));
+    }
+}
+
+//------------------------------------------------------------------------------
+static void bench_columns(bench& b, unsigned int count, unsigned int iterations)
+{
+    std::vector<width_t> lens;
+    std::vector<width_t> widths;
+    make_lens(count, lens);
+
+    // The triangle is limited to 50 columns, so give both the same limit.
+    const size_t max_cols = 50;
+    const size_t line_length = 400;
+
+    b.measure("triangle_vert", iterations, [&] () {
+        fit_columns_triangle(lens, max_cols, 2, line_length, true, widths);
+    });
+
+    b.measure("ranges_vert", iterations, [&] () {
+        fit_columns_ranges(lens, max_cols, 2, line_length, true, widths);
+    });
+
+    b.measure("triangle_horz", iterations, [&] () {
+        fit_columns_triangle(lens, max_cols, 2, line_length, false, widths);
+    });
+
+    b.measure("ranges_horz", iterations, [&] () {
+        fit_columns_ranges(lens, max_cols, 2, line_length, false, widths);
+    });
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("columns 1k")
+{
+    bench_columns(b, 1000, 100);
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("columns 100k")
+{
+    bench_columns(b, 100000, 3);
+}
@@ -0,0 +1,77 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include "fs_fixture.h"
+#include "line_editor_tester.h"
+
+#include <core/str.h>
+#include <lua/lua_match_generator.h>
+#include <lua/lua_state.h>
+
+extern "C" {
+#include <readline/readline.h>
+}
+
+//------------------------------------------------------------------------------
+static void bench_complete(bench& b, unsigned int count, unsigned int iterations)
+{
+    const char* empty_fs[] = { nullptr };
+    fs_fixture fs(empty_fs);
+
+    lua_state lua;
+    lua_match_generator lua_generator(lua); // This loads the required lua scripts.
+
+    str<> script;
+    script.format("\
+        local m = {}\
+        for i = 1, %u do\
+            m[i] = string.format('match%%06d', i)\
+        end\
+        local g = clink.generator(1)\
+        function g:generate(line_state, match_builder)\
+            match_builder:addmatches(m, 'word')\
+            return true\
+        end", count);
+    REQUIRE(lua.do_string(script.c_str()));
+
+    // List every match without asking or paging, since there is no one to
+    // answer.
+    rl_variable_bind("completion-query-items", "0");
+    rl_variable_bind("page-completions", "off");
+
+    line_editor_tester tester;
+    tester.get_editor()->set_generator(lua_generator);
+
+    // Generate, sort, and insert the common prefix.
+    b.measure("tab", iterations, [&] () {
+        tester.set_input("m" DO_COMPLETE);
+        tester.replay();
+    });
+
+    // Also list all of the matches.
+    b.measure("tab_list", iterations, [&] () {
+        tester.set_input("m" DO_COMPLETE DO_COMPLETE);
+        tester.replay();
+    });
+
+    // Narrow the matches after they've been generated.
+    b.measure("tab_narrow", iterations, [&] () {
+        tester.set_input("m" DO_COMPLETE "0042" DO_COMPLETE);
+        tester.replay();
+    });
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("complete 10k")
+{
+    bench_complete(b, 10000, 10);
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("complete 100k")
+{
+    bench_complete(b, 100000, 3);
+}
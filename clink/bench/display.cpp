@@ -0,0 +1,41 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include "line_editor_tester.h"
+
+#include <core/str.h>
+
+//------------------------------------------------------------------------------
+BENCHMARK("display")
+{
+    line_editor_tester tester;
+
+    // Enough text to wrap onto 20 rows of the 80 column test terminal.
+    str_moveable text;
+    while (text.length() < 20 * 80 - 10)
+        text.concat("echo some words ", 16);
+
+    // Pasting redisplays once, after the burst ends.
+    tester.set_burst(true);
+
+    b.measure("paste_20_rows", 20, [&] () {
+        tester.set_input(text.c_str());
+        tester.replay();
+    });
+
+    // Then the cursor moves back and forth at the end of the input, which
+    // redisplays once per keystroke (^B is backward-char, ^F is forward-char).
+    str_moveable moving(text.c_str());
+    for (int i = 0; i < 50; ++i)
+        moving.concat("\x02\x02\x06\x06", 4);
+
+    b.measure("cursor_at_end_20_rows", 20, [&] () {
+        tester.set_input(moving.c_str());
+        tester.replay();
+    });
+
+    tester.set_burst(false);
+}
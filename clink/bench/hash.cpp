@@ -0,0 +1,99 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include <core/flat_hash_map.h>
+#include <core/str.h>
+#include <core/str_unordered_set.h>
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+static void bench_hash(bench& b, unsigned int count, unsigned int iterations)
+{
+    std::vector<str_moveable> keys;
+    keys.reserve(count);
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        str_moveable key;
+        key.format("c:\\some\\directory\\match%08u.txt", i * 2654435761u);
+        keys.emplace_back(std::move(key));
+    }
+
+    unsigned int found = 0;
+
+    b.measure("str_hash", iterations, [&] () {
+        for (const auto& key : keys)
+            found += str_hash(key.c_str()) & 1;
+    });
+
+    b.measure("str_fast_hash", iterations, [&] () {
+        for (const auto& key : keys)
+            found += str_fast_hash(key.c_str(), key.length()) & 1;
+    });
+
+    {
+        str_unordered_set set;
+        b.measure("unordered_insert", iterations, [&] () {
+            set.clear();
+            for (const auto& key : keys)
+                set.insert(key.c_str());
+        });
+        b.measure("unordered_lookup", iterations, [&] () {
+            for (const auto& key : keys)
+                found += (set.find(key.c_str()) != set.end());
+        });
+    }
+
+    {
+        str_flat_set set;
+        b.measure("flat_insert", iterations, [&] () {
+            set.clear();
+            for (const auto& key : keys)
+                set.insert(key.c_str());
+        });
+        b.measure("flat_lookup", iterations, [&] () {
+            for (const auto& key : keys)
+                found += set.contains(key.c_str());
+        });
+    }
+
+    {
+        str_flat_set set(0x10000);
+        b.measure("flat_arena_insert", iterations, [&] () {
+            set.clear();
+            for (const auto& key : keys)
+                set.insert(key.c_str());
+        });
+    }
+
+    // Keep the loops from being optimized away.
+    if (!found)
+        fputs("", stderr);
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("hash 1k")
+{
+    bench_hash(b, 1000, 200);
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("hash 10k")
+{
+    bench_hash(b, 10000, 50);
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("hash 100k")
+{
+    bench_hash(b, 100000, 10);
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("hash 1m")
+{
+    bench_hash(b, 1000000, 3);
+}
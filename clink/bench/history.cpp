@@ -0,0 +1,64 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include "fs_fixture.h"
+#include "line_editor_tester.h"
+
+#include <core/str.h>
+
+extern "C" {
+#include <readline/history.h>
+};
+
+//------------------------------------------------------------------------------
+#define CTRL_E "\x05"
+#define CTRL_G "\x07"
+#define CTRL_R "\x12"
+
+//------------------------------------------------------------------------------
+static void bench_history(bench& b, unsigned int count, unsigned int iterations)
+{
+    const char* empty_fs[] = { nullptr };
+    fs_fixture fs(empty_fs);
+
+    clear_history();
+
+    str<> line;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        line.format("cmd%u --flag=%u \"c:\\some dir\\file%u.txt\" | findstr /i needle%u", i % 97, i % 13, i, i);
+        add_history(line.c_str());
+    }
+
+    line_editor_tester tester;
+
+    // Finds a line near the start, so nearly the whole history is searched.
+    b.measure("search_hit", iterations, [&] () {
+        line.format(CTRL_R "needle%u" CTRL_E, count / 10);
+        tester.set_input(line.c_str());
+        tester.replay();
+    });
+
+    // Searches the whole history once per keystroke.
+    b.measure("search_miss", iterations, [&] () {
+        tester.set_input(CTRL_R "not present" CTRL_G);
+        tester.replay();
+    });
+
+    clear_history();
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("history 10k")
+{
+    bench_history(b, 10000, 10);
+}
+
+//------------------------------------------------------------------------------
+BENCHMARK("history 100k")
+{
+    bench_history(b, 100000, 3);
+}
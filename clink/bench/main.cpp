@@ -0,0 +1,99 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include <core/settings.h>
+#include <core/os.h>
+
+extern "C" {
+#include <readline/readline.h>
+#include <readline/rldefs.h>
+#include <readline/rlprivate.h>
+}
+
+#include <stdlib.h>
+
+//------------------------------------------------------------------------------
+int main(int argc, char** argv)
+{
+    argc--, argv++;
+
+    const char* out_path = nullptr;
+    unsigned int repeat = 1;
+
+#ifdef DEBUG
+    settings::TEST_set_ever_loaded();
+#endif
+
+    os::set_shellname(L"clink_bench_harness");
+
+    _rl_bell_preference = VISIBLE_BELL;     // Because audible is annoying.
+    _rl_optimize_typeahead = false;         // Because not compatible with READLINE_CALLBACKS.
+
+    while (argc > 0)
+    {
+        if (!strcmp(argv[0], "-?") || !strcmp(argv[0], "--help"))
+        {
+            puts("Usage: clink_bench [options] [prefix]\n"
+                 "\n"
+                 "Options:\n"
+                 "  -?        Show this help.\n"
+                 "  -n <num>  Multiply the iterations of each operation by <num>.\n"
+                 "  -o <file> Write the JSON report to <file> instead of stdout.\n"
+                 "\n"
+                 "Runs the benchmarks whose names start with <prefix> and reports the\n"
+                 "latency of each operation in microseconds.  Allocation counts are\n"
+                 "only reported by debug builds.");
+            return 1;
+        }
+        else if (!strcmp(argv[0], "-n") && argc > 1)
+        {
+            argc--, argv++;
+            repeat = atoi(argv[0]);
+        }
+        else if (!strcmp(argv[0], "-o") && argc > 1)
+        {
+            argc--, argv++;
+            out_path = argv[0];
+        }
+        else if (!strcmp(argv[0], "--"))
+        {
+        }
+        else
+        {
+            break;
+        }
+
+        argc--, argv++;
+    }
+
+    FILE* out = stdout;
+    if (out_path)
+    {
+        out = fopen(out_path, "w");
+        if (!out)
+        {
+            fprintf(stderr, "Unable to open '%s'.\n", out_path);
+            return 1;
+        }
+    }
+
+    const char* prefix = (argc > 0) ? argv[0] : "";
+    int result = (bench::run_all(prefix, repeat, out) != true);
+
+    if (out != stdout)
+        fclose(out);
+
+    extern void shutdown_recognizer();
+    shutdown_recognizer();
+
+    extern void shutdown_exec_catalog();
+    shutdown_exec_catalog();
+
+    extern void shutdown_task_manager();
+    shutdown_task_manager();
+
+    return result;
+}
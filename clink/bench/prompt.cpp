@@ -0,0 +1,49 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include <core/str.h>
+#include <lua/lua_script_loader.h>
+#include <lua/lua_state.h>
+#include <lua/prompt.h>
+
+//------------------------------------------------------------------------------
+BENCHMARK("prompt")
+{
+    lua_state lua;
+    prompt_filter prompt_filter(lua);
+    lua_load_script(lua, app, prompt);
+
+    str_moveable out;
+
+    b.measure("no_filters", 500, [&] () {
+        prompt_filter.filter("C:\\Users\\bench\\repo>", out);
+    });
+
+    // Twenty filters doing the kind of string manipulation typical of prompt
+    // customizations, plus one that stops further filtering.
+    const char* script = "\
+        for i = 1, 20 do\
+            local pf = clink.promptfilter(i * 5)\
+            function pf:filter(prompt)\
+                local dir = prompt:match('^(.*)>$') or prompt\
+                local parts = {}\
+                for part in dir:gmatch('[^\\\\]+') do\
+                    table.insert(parts, part)\
+                end\
+                return '\\x1b[3'..(i % 8)..'m'..table.concat(parts, '\\\\')..'\\x1b[m>'\
+            end\
+        end\
+        local last = clink.promptfilter(999)\
+        function last:filter(prompt)\
+            return prompt..' ', false\
+        end\
+    ";
+    REQUIRE(lua.do_string(script));
+
+    b.measure("twenty_filters", 500, [&] () {
+        prompt_filter.filter("C:\\Users\\bench\\repo>", out);
+    });
+}
@@ -0,0 +1,71 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "bench.h"
+
+#include "fs_fixture.h"
+#include "line_editor_tester.h"
+
+#include <core/settings.h>
+#include <core/str.h>
+#include <lua/lua_match_generator.h>
+#include <lua/lua_word_classifier.h>
+#include <lua/lua_script_loader.h>
+#include <lua/lua_state.h>
+
+//------------------------------------------------------------------------------
+BENCHMARK("typing")
+{
+    const char* empty_fs[] = { nullptr };
+    fs_fixture fs(empty_fs);
+
+    lua_state lua;
+    lua_match_generator lua_generator(lua); // This loads the required lua scripts.
+    lua_load_script(lua, app, cmd);
+    lua_load_script(lua, app, dir);
+    lua_word_classifier lua_classifier(lua);
+
+    settings::find("clink.colorize_input")->set("true");
+
+    line_editor::desc desc(nullptr, nullptr, nullptr, nullptr);
+    line_editor_tester tester(desc, "&|", nullptr);
+    tester.get_editor()->set_generator(lua_generator);
+    tester.get_editor()->set_classifier(lua_classifier);
+
+    // Each character is a separate keystroke, so the whole line is collected,
+    // classified, and redisplayed once per character.
+    static const char c_short[] = "dir /s /b";
+    static const char c_pipeline[] =
+        "dir /s /b *.cpp | findstr /i /c:\"line_editor\" | sort /r | more"
+        " && echo done > nul & type \"some file.txt\" | find /v /c \"\""
+        " && cd /d \"%TEMP%\" & set /p answer=<nul | findstr /r \"^[0-9]*$\"";
+
+    b.measure("short_command", 100, [&] () {
+        tester.set_input(c_short);
+        tester.replay();
+    });
+
+    b.measure("long_pipeline", 20, [&] () {
+        tester.set_input(c_pipeline);
+        tester.replay();
+    });
+
+    // Pasted text arrives faster than it can be typed, so the editor defers
+    // everything that depends on the whole line until the burst ends.
+    str_moveable paste;
+    while (paste.length() < 4096)
+        paste.concat(c_pipeline, sizeof(c_pipeline) - 1);
+
+    b.measure("paste_4k_typed", 2, [&] () {
+        tester.set_input(paste.c_str());
+        tester.replay();
+    });
+
+    tester.set_burst(true);
+    b.measure("paste_4k_burst", 2, [&] () {
+        tester.set_input(paste.c_str());
+        tester.replay();
+    });
+    tester.set_burst(false);
+}
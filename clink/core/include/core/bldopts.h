@@ -20,6 +20,11 @@
 // fish shell completion.  Otherwise they move as in powershell completion.
 #define FISH_ARROW_KEYS
 
+//------------------------------------------------------------------------------
+// Define USE_PERF_STATS to measure how long each stage of handling a keystroke
+// takes (see clink-show-perf).  Undefine it to remove the instrumentation.
+#define USE_PERF_STATS
+
 //------------------------------------------------------------------------------
 // Define to use "..." rather than "…" when truncating things.
 //#define USE_ASCII_ELLIPSIS
@@ -0,0 +1,315 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include "linear_allocator.h"
+#include "str_hash.h"
+
+#include <memory>
+#include <utility>
+
+//------------------------------------------------------------------------------
+// Open addressing hash map with linear probing.  The slots are stored in one
+// flat array, and each slot caches its key's hash so that probing rarely needs
+// to compare keys and growing never needs to rehash them.
+//
+// Traits must provide:
+//  - static unsigned int hash(const Key& key);
+//  - static bool equals(const Key& a, const Key& b);
+//  - static bool store(linear_allocator& arena, const Key& key, Key& out);
+//
+// If an arena size is given, inserted keys are copied into an arena owned by
+// the map (via Traits::store), so callers don't need to keep them alive.  The
+// arena is only reclaimed by clear().
+//
+// Pointers returned by find() and emplace() are invalidated by any insertion
+// or removal.
+template <typename Key, typename Value, typename Traits>
+class flat_hash_map
+{
+public:
+                            flat_hash_map(unsigned int arena_size=0);
+                            ~flat_hash_map();
+                            flat_hash_map(const flat_hash_map&) = delete;
+    flat_hash_map&          operator = (const flat_hash_map&) = delete;
+
+    unsigned int            size() const { return m_count; }
+    bool                    empty() const { return !m_count; }
+    void                    clear();
+    void                    reserve(unsigned int count);
+
+    Value*                  find(const Key& key);
+    const Value*            find(const Key& key) const;
+    bool                    contains(const Key& key) const { return !!find(key); }
+    std::pair<Value*, bool> emplace(const Key& key, Value value=Value());
+    bool                    insert_or_assign(const Key& key, Value value);
+    bool                    erase(const Key& key);
+
+    template <class F> void for_each(F&& func) const;
+
+private:
+    struct slot
+    {
+        unsigned int        hash = 0;   // Zero means the slot is empty.
+        Key                 key = Key();
+        Value               value = Value();
+    };
+
+    static unsigned int     hash_key(const Key& key);
+    unsigned int            probe(const Key& key, unsigned int hash) const;
+    void                    rehash(unsigned int capacity);
+
+    slot*                   m_slots = nullptr;
+    unsigned int            m_mask = 0;
+    unsigned int            m_count = 0;
+    std::unique_ptr<linear_allocator> m_arena;
+};
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+flat_hash_map<Key, Value, Traits>::flat_hash_map(unsigned int arena_size)
+{
+    if (arena_size)
+        m_arena = std::make_unique<linear_allocator>(arena_size);
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+flat_hash_map<Key, Value, Traits>::~flat_hash_map()
+{
+    delete [] m_slots;
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+void flat_hash_map<Key, Value, Traits>::clear()
+{
+    delete [] m_slots;
+    m_slots = nullptr;
+    m_mask = 0;
+    m_count = 0;
+    if (m_arena)
+        m_arena->reset();
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+void flat_hash_map<Key, Value, Traits>::reserve(unsigned int count)
+{
+    // Keep the load factor at or below 3/4.
+    unsigned int capacity = 16;
+    while (capacity / 4 * 3 < count)
+        capacity <<= 1;
+    if (capacity > m_mask + 1)
+        rehash(capacity);
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+Value* flat_hash_map<Key, Value, Traits>::find(const Key& key)
+{
+    if (!m_count)
+        return nullptr;
+
+    slot& s = m_slots[probe(key, hash_key(key))];
+    return s.hash ? &s.value : nullptr;
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+const Value* flat_hash_map<Key, Value, Traits>::find(const Key& key) const
+{
+    return const_cast<flat_hash_map*>(this)->find(key);
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+std::pair<Value*, bool> flat_hash_map<Key, Value, Traits>::emplace(const Key& key, Value value)
+{
+    reserve(m_count + 1);
+
+    const unsigned int hash = hash_key(key);
+    slot& s = m_slots[probe(key, hash)];
+    if (s.hash)
+        return std::make_pair(&s.value, false);
+
+    if (m_arena)
+    {
+        if (!Traits::store(*m_arena, key, s.key))
+            return std::make_pair(nullptr, false);
+    }
+    else
+    {
+        s.key = key;
+    }
+
+    s.hash = hash;
+    s.value = std::move(value);
+    ++m_count;
+    return std::make_pair(&s.value, true);
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+bool flat_hash_map<Key, Value, Traits>::insert_or_assign(const Key& key, Value value)
+{
+    auto result = emplace(key);
+    if (!result.first)
+        return false;
+
+    *result.first = std::move(value);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+bool flat_hash_map<Key, Value, Traits>::erase(const Key& key)
+{
+    if (!m_count)
+        return false;
+
+    unsigned int i = probe(key, hash_key(key));
+    if (!m_slots[i].hash)
+        return false;
+
+    // Shift later entries in the same cluster back, so that no tombstones
+    // are needed.  An entry can move into the hole at i only if its ideal
+    // slot is not cyclically within (i, j].
+    for (unsigned int j = i;;)
+    {
+        j = (j + 1) & m_mask;
+        if (!m_slots[j].hash)
+            break;
+
+        const unsigned int k = m_slots[j].hash & m_mask;
+        const bool stays = (i <= j) ? (i < k && k <= j) : (i < k || k <= j);
+        if (!stays)
+        {
+            m_slots[i] = std::move(m_slots[j]);
+            i = j;
+        }
+    }
+
+    m_slots[i] = slot();
+    --m_count;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+template <class F>
+void flat_hash_map<Key, Value, Traits>::for_each(F&& func) const
+{
+    if (m_count)
+    {
+        for (unsigned int i = 0; i <= m_mask; ++i)
+            if (m_slots[i].hash)
+                func(m_slots[i].key, m_slots[i].value);
+    }
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+unsigned int flat_hash_map<Key, Value, Traits>::hash_key(const Key& key)
+{
+    const unsigned int hash = Traits::hash(key);
+    return hash ? hash : 1;
+}
+
+//------------------------------------------------------------------------------
+// Returns the index of the slot holding key, or else the empty slot where it
+// would be inserted.
+template <typename Key, typename Value, typename Traits>
+unsigned int flat_hash_map<Key, Value, Traits>::probe(const Key& key, unsigned int hash) const
+{
+    unsigned int i = hash & m_mask;
+    while (m_slots[i].hash)
+    {
+        if (m_slots[i].hash == hash && Traits::equals(m_slots[i].key, key))
+            break;
+        i = (i + 1) & m_mask;
+    }
+    return i;
+}
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Value, typename Traits>
+void flat_hash_map<Key, Value, Traits>::rehash(unsigned int capacity)
+{
+    slot* old_slots = m_slots;
+    const unsigned int old_capacity = m_slots ? m_mask + 1 : 0;
+
+    m_slots = new slot[capacity];
+    m_mask = capacity - 1;
+
+    for (unsigned int i = 0; i < old_capacity; ++i)
+    {
+        slot& old = old_slots[i];
+        if (!old.hash)
+            continue;
+
+        unsigned int j = old.hash & m_mask;
+        while (m_slots[j].hash)
+            j = (j + 1) & m_mask;
+        m_slots[j] = std::move(old);
+    }
+
+    delete [] old_slots;
+}
+
+
+
+//------------------------------------------------------------------------------
+struct flat_hash_empty {};
+
+//------------------------------------------------------------------------------
+template <typename Key, typename Traits>
+class flat_hash_set
+{
+public:
+                            flat_hash_set(unsigned int arena_size=0) : m_map(arena_size) {}
+    unsigned int            size() const { return m_map.size(); }
+    bool                    empty() const { return m_map.empty(); }
+    void                    clear() { m_map.clear(); }
+    void                    reserve(unsigned int count) { m_map.reserve(count); }
+    bool                    contains(const Key& key) const { return m_map.contains(key); }
+    bool                    insert(const Key& key) { return m_map.emplace(key).second; }
+    bool                    erase(const Key& key) { return m_map.erase(key); }
+
+    template <class F> void for_each(F&& func) const { m_map.for_each([&] (const Key& key, const flat_hash_empty&) { func(key); }); }
+
+private:
+    flat_hash_map<Key, flat_hash_empty, Traits> m_map;
+};
+
+
+
+//------------------------------------------------------------------------------
+struct str_flat_traits
+{
+    static unsigned int hash(const char* key) { return str_fast_hash(key); }
+    static bool equals(const char* a, const char* b) { return strcmp(a, b) == 0; }
+    static bool store(linear_allocator& arena, const char* key, const char*& out) { return !!(out = arena.store(key)); }
+};
+
+//------------------------------------------------------------------------------
+struct wstr_flat_traits
+{
+    static unsigned int hash(const wchar_t* key) { return wstr_fast_hash(key); }
+    static bool equals(const wchar_t* a, const wchar_t* b) { return wcscmp(a, b) == 0; }
+    static bool store(linear_allocator& arena, const wchar_t* key, const wchar_t*& out)
+    {
+        const unsigned int size = unsigned(wcslen(key) + 1) * sizeof(*key);
+        wchar_t* p = static_cast<wchar_t*>(arena.alloc(size));
+        if (p)
+            memcpy(p, key, size);
+        return !!(out = p);
+    }
+};
+
+//------------------------------------------------------------------------------
+typedef flat_hash_set<const char*, str_flat_traits> str_flat_set;
+typedef flat_hash_set<const wchar_t*, wstr_flat_traits> wstr_flat_set;
+template <typename ValTy> using str_flat_map = flat_hash_map<const char*, ValTy, str_flat_traits>;
+template <typename ValTy> using wstr_flat_map = flat_hash_map<const wchar_t*, ValTy, wstr_flat_traits>;
@@ -6,10 +6,22 @@
 #include "str.h"
 #include "singleton.h"
 
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <thread>
+
 //------------------------------------------------------------------------------
 #define LOG(...)    logger::info(__FUNCTION__, __LINE__, ##__VA_ARGS__)
 #define ERR(...)    logger::error(__FUNCTION__, __LINE__, ##__VA_ARGS__)
 
+// Records a timing span from here to the end of the enclosing scope.  The
+// category and name must be string literals.
+#define TRACE_SCOPE(category, name) \
+    const trace_scope TRACE_SCOPE_VAR(__LINE__)(category, name)
+#define TRACE_SCOPE_VAR(line)       TRACE_SCOPE_VAR_IMPL(line)
+#define TRACE_SCOPE_VAR_IMPL(line)  trace_scope_##line
+
 //------------------------------------------------------------------------------
 class logger
     : public singleton<logger>
@@ -18,19 +30,86 @@ public:
     virtual         ~logger();
     static void     info(const char* function, int line, const char* fmt, ...);
     static void     error(const char* function, int line, const char* fmt, ...);
+    static bool     is_tracing();
+    static void     trace(const char* category, const char* name, unsigned long long begin_us, unsigned long long end_us);
+    static unsigned long long now_us();
+    virtual bool    begin_trace(const char* trace_path) { return false; }
+    virtual void    end_trace() {}
+    virtual void    flush() {}
 
 protected:
     virtual void    emit(const char* function, int line, const char* fmt, va_list args) = 0;
+    virtual void    emit_trace(const char* category, const char* name, unsigned long long begin_us, unsigned long long end_us) {}
+    volatile bool   m_tracing = false;
+};
+
+//------------------------------------------------------------------------------
+class trace_scope
+{
+public:
+                    trace_scope(const char* category, const char* name);
+                    ~trace_scope();
+
+private:
+    const char*     m_category;
+    const char*     m_name;
+    unsigned long long m_begin = 0;
 };
 
 //------------------------------------------------------------------------------
+// Log messages and trace events are formatted into a fixed size lock-free ring
+// buffer, and a background thread drains the buffer and writes the records to
+// the log file (and trace file) in batches.  When the buffer is full, records
+// are dropped and the number dropped is logged.  When the log file exceeds the
+// max size it is renamed with a ".1" suffix and a new log file is started.
 class file_logger
     : public logger
 {
 public:
                     file_logger(const char* log_path);
+                    ~file_logger();
+    void            set_max_size(unsigned int max_size) { m_max_size = max_size; }
+    virtual bool    begin_trace(const char* trace_path) override;
+    virtual void    end_trace() override;
+    virtual void    flush() override;
+
+protected:
     virtual void    emit(const char* function, int line, const char* fmt, va_list args) override;
+    virtual void    emit_trace(const char* category, const char* name, unsigned long long begin_us, unsigned long long end_us) override;
 
 private:
+    enum { record_count = 1024 };   // Must be a power of 2.
+    enum record_kind { kind_log, kind_trace };
+
+    struct record
+    {
+        std::atomic<unsigned int> sequence;
+        unsigned char       kind;
+        DWORD               tid;
+        const char*         category;
+        const char*         name;
+        unsigned long long  begin_us;
+        unsigned long long  end_us;
+        char                text[460];
+    };
+
+    record*         reserve(unsigned int& pos);
+    void            commit(record* r, unsigned int pos);
+    void            drain(bool wait);
+    void            drain_locked();
+    void            write_log(const char* text, unsigned int len);
+    void            write_direct(const char* prefix, const char* fmt, va_list args);
+    static void     proc(file_logger* logger);
+
     str<256>        m_log_path;
+    str<256>        m_trace_path;
+    unsigned int    m_max_size = 16 * 1024 * 1024;
+    record*         m_records = nullptr;
+    std::atomic<unsigned int> m_head;
+    unsigned int    m_tail = 0;
+    std::atomic<unsigned int> m_dropped;
+    std::mutex      m_write_mutex;
+    std::unique_ptr<std::thread> m_thread;
+    HANDLE          m_wake = nullptr;
+    volatile bool   m_stop = false;
 };
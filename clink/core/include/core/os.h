@@ -63,6 +63,14 @@ struct cwd_restorer
     wchar_t m_path[288];
 };
 
+// While in scope, disambiguate_abbreviated_path() caches directory listings
+// (revalidated by directory modified time) and resolved path components.
+struct abbreviated_path_cache_scope
+{
+    abbreviated_path_cache_scope();
+    ~abbreviated_path_cache_scope();
+};
+
 DWORD   get_file_attributes(const wchar_t* path, bool* symlink=nullptr);
 DWORD   get_file_attributes(const char* path, bool* symlink=nullptr);
 int     get_path_type(const char* path);
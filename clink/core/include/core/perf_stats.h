@@ -0,0 +1,66 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+class str_base;
+
+//------------------------------------------------------------------------------
+// Stages of handling a keystroke, from reading the input to finishing the
+// display.  Stages can nest (e.g. update_matches happens within keystroke), so
+// the times are not additive.
+enum class perf_stage
+{
+    keystroke,
+    update_internal,
+    collect_words,
+    classify,
+    update_matches,
+    try_suggest,
+    coroutines,
+    display,
+    max
+};
+
+#ifdef USE_PERF_STATS
+
+//------------------------------------------------------------------------------
+// Records how long the enclosing scope takes into a histogram for the stage.
+// Histograms use buckets that grow geometrically, so percentiles are reported
+// within about 25%.  The stats are not thread safe; stages are only
+// measured on the main thread.  Nothing is recorded unless the stats have been
+// enabled by perf_stats_enable().
+class perf_timer
+{
+public:
+                    perf_timer(perf_stage stage);
+                    ~perf_timer();
+private:
+    const perf_stage m_stage;
+    long long       m_begin;
+};
+
+#define PERF_STAGE(stage) \
+    const perf_timer PERF_STAGE_VAR(__LINE__)(perf_stage::stage)
+#define PERF_STAGE_VAR(line)        PERF_STAGE_VAR_IMPL(line)
+#define PERF_STAGE_VAR_IMPL(line)   perf_timer_##line
+
+void perf_stats_enable(bool enable);
+bool perf_stats_enabled();
+void perf_stats_record(perf_stage stage, unsigned long long us);
+void perf_stats_record_popup_bytes(unsigned long long bytes);
+bool perf_stats_report(str_base& out);
+void perf_stats_reset();
+
+#else
+
+#define PERF_STAGE(stage)           ((void)0)
+
+inline void perf_stats_enable(bool) {}
+inline bool perf_stats_enabled() { return false; }
+inline void perf_stats_record(perf_stage, unsigned long long) {}
+inline void perf_stats_record_popup_bytes(unsigned long long) {}
+inline bool perf_stats_report(str_base&) { return false; }
+inline void perf_stats_reset() {}
+
+#endif
@@ -0,0 +1,99 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include "globber.h"
+#include "str.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Evaluates a glob pattern that may contain `**` (which matches across
+// directory boundaries) using wildmatch semantics.  The literal leading
+// directories of the pattern are the root of the traversal, and subtrees that
+// cannot match the pattern are not visited.  Directories are enumerated on a
+// small pool of worker threads, and results are collected by calling next()
+// until it returns false.  The traversal stops early if cancel() is called or
+// the object is destroyed.
+class recursive_globber
+{
+public:
+    struct entry
+    {
+        str_moveable        name;
+        globber::extrainfo  info;
+    };
+
+    // Enumerates the entries in a directory.  The default source uses
+    // globber; tests or other platforms can supply their own.
+    class source
+    {
+    public:
+        virtual             ~source() {}
+        virtual void        enumerate(const char* dir, bool hidden, bool system, std::vector<entry>& out) = 0;
+    };
+
+                        recursive_globber(const char* pattern, std::shared_ptr<source> src=nullptr);
+                        ~recursive_globber();
+    void                files(bool state)       { m_files = state; }
+    void                directories(bool state) { m_directories = state; }
+    void                suffix_dirs(bool state) { m_dir_suffix = state; }
+    void                hidden(bool state)      { m_hidden = state; }
+    void                system(bool state)      { m_system = state; }
+    void                threads(int count)      { m_num_threads = count; }
+    void                start();
+    bool                next(str_base& out, globber::extrainfo* extrainfo=nullptr, unsigned int timeout_ms=INFINITE);
+    bool                is_done() const;
+    void                cancel();
+    const char*         get_root() const        { return m_root.c_str(); }
+    const char*         get_pattern() const     { return m_pattern.c_str(); }
+
+private:
+                        recursive_globber(const recursive_globber&) = delete;
+    void                operator = (const recursive_globber&) = delete;
+    bool                can_descend(unsigned int depth, const char* name) const;
+    bool                is_match(const char* rel) const;
+    void                visit(const str_moveable& rel, unsigned int depth, std::vector<entry>& entries);
+    static void         proc(recursive_globber* rg);
+
+    struct work
+    {
+        str_moveable        rel;
+        unsigned int        depth = 0;
+    };
+
+    struct result
+    {
+        str_moveable        path;
+        globber::extrainfo  info;
+    };
+
+    std::shared_ptr<source> m_source;
+    str_moveable        m_root;
+    str_moveable        m_pattern;
+    std::vector<str_moveable> m_segments;
+    unsigned int        m_wildstar;
+    bool                m_files = true;
+    bool                m_directories = true;
+    bool                m_dir_suffix = true;
+    bool                m_hidden = false;
+    bool                m_system = false;
+    int                 m_num_threads = 0;
+
+    mutable std::mutex  m_mutex;
+    std::condition_variable m_work_ready;
+    std::condition_variable m_result_ready;
+    std::deque<work>    m_work;
+    std::deque<result>  m_results;
+    unsigned int        m_pending = 0;
+    std::vector<std::thread> m_threads;
+    std::atomic<bool>   m_canceled;
+    bool                m_started = false;
+};
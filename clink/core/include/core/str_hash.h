@@ -3,6 +3,12 @@
 
 #pragma once
 
+#include <string.h>
+#include <wchar.h>
+#if defined(_M_AMD64)
+#include <intrin.h>
+#endif
+
 //------------------------------------------------------------------------------
 template <typename T> unsigned int str_hash_impl(const T* in, unsigned int length)
 {
@@ -29,3 +35,120 @@ inline unsigned int wstr_hash(const wchar_t* in, int length=-1)
 {
     return str_hash_impl<wchar_t>(in, length);
 }
+
+
+
+//------------------------------------------------------------------------------
+// A word-at-a-time hash (in the style of wyhash) for hash tables.  Unlike
+// str_hash(), the values are not guaranteed to stay the same between versions,
+// so they must not be persisted or exposed to scripts.
+namespace str_hash_detail
+{
+
+//------------------------------------------------------------------------------
+inline unsigned long long read64(const unsigned char* p)
+{
+    unsigned long long v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//------------------------------------------------------------------------------
+inline unsigned long long read32(const unsigned char* p)
+{
+    unsigned int v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+//------------------------------------------------------------------------------
+// Multiplies to 128 bits and folds the halves together.
+inline unsigned long long mum(unsigned long long a, unsigned long long b)
+{
+#if defined(_M_AMD64)
+    unsigned long long hi;
+    const unsigned long long lo = _umul128(a, b, &hi);
+    return lo ^ hi;
+#elif defined(__SIZEOF_INT128__)
+    const unsigned __int128 r = (unsigned __int128)a * b;
+    return (unsigned long long)r ^ (unsigned long long)(r >> 64);
+#else
+    const unsigned long long ha = a >> 32, la = (unsigned int)a;
+    const unsigned long long hb = b >> 32, lb = (unsigned int)b;
+    const unsigned long long hh = ha * hb, hl = ha * lb, lh = la * hb, ll = la * lb;
+    const unsigned long long t = ll + (hl << 32);
+    const unsigned long long lo = t + (lh << 32);
+    const unsigned long long hi = hh + (hl >> 32) + (lh >> 32) + (t < ll) + (lo < t);
+    return lo ^ hi;
+#endif
+}
+
+static const unsigned long long c_p0 = 0xa0761d6478bd642full;
+static const unsigned long long c_p1 = 0xe7037ed1a0b428dbull;
+static const unsigned long long c_p2 = 0x8ebc6af09c88c6e3ull;
+
+} // namespace str_hash_detail
+
+//------------------------------------------------------------------------------
+inline unsigned int fast_hash(const void* data, size_t len)
+{
+    using namespace str_hash_detail;
+
+    const unsigned char* p = static_cast<const unsigned char*>(data);
+    unsigned long long h = c_p0 ^ mum(len ^ c_p0, c_p1);
+
+    size_t n = len;
+    for (; n > 16; n -= 16, p += 16)
+        h = mum(read64(p) ^ c_p1, read64(p + 8) ^ h);
+
+    // The remaining 1..16 bytes are read with (possibly overlapping) loads
+    // from each end, rather than a byte at a time.
+    unsigned long long a, b;
+    if (n >= 8)
+    {
+        a = read64(p);
+        b = read64(p + n - 8);
+    }
+    else if (n >= 4)
+    {
+        a = read32(p);
+        b = read32(p + n - 4);
+    }
+    else if (n > 0)
+    {
+        a = ((unsigned long long)p[0] << 16) | ((unsigned long long)p[n >> 1] << 8) | p[n - 1];
+        b = 0;
+    }
+    else
+    {
+        a = b = 0;
+    }
+
+    h = mum(a ^ c_p1, b ^ h);
+    h = mum(h ^ c_p2, len ^ c_p1);
+    return (unsigned int)(h ^ (h >> 32));
+}
+
+//------------------------------------------------------------------------------
+inline unsigned int str_fast_hash(const char* in, size_t length)
+{
+    return fast_hash(in, length);
+}
+
+//------------------------------------------------------------------------------
+inline unsigned int str_fast_hash(const char* in)
+{
+    return fast_hash(in, strlen(in));
+}
+
+//------------------------------------------------------------------------------
+inline unsigned int wstr_fast_hash(const wchar_t* in, size_t length)
+{
+    return fast_hash(in, length * sizeof(*in));
+}
+
+//------------------------------------------------------------------------------
+inline unsigned int wstr_fast_hash(const wchar_t* in)
+{
+    return fast_hash(in, wcslen(in) * sizeof(*in));
+}
@@ -12,11 +12,11 @@ struct match_hasher
 {
     size_t operator()(const char* match) const
     {
-        return str_hash(match);
+        return str_fast_hash(match);
     }
     size_t operator()(const wchar_t* match) const
     {
-        return wstr_hash(match);
+        return wstr_fast_hash(match);
     }
 };
 
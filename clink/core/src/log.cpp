@@ -3,8 +3,10 @@
 
 #include "pch.h"
 #include "log.h"
+#include "debugheap.h"
 
 #include <stdarg.h>
+#include <stdio.h>
 
 //------------------------------------------------------------------------------
 logger::~logger()
@@ -41,35 +43,343 @@ void logger::error(const char* function, int line, const char* fmt, ...)
     logger::info(function, line, "(last error = %d)", last_error);
 
     va_end(args);
+
+    // Errors often precede a crash or exit, so write them out immediately.
+    instance->flush();
+}
+
+//------------------------------------------------------------------------------
+bool logger::is_tracing()
+{
+    logger* instance = logger::get();
+    return instance && instance->m_tracing;
+}
+
+//------------------------------------------------------------------------------
+void logger::trace(const char* category, const char* name, unsigned long long begin_us, unsigned long long end_us)
+{
+    logger* instance = logger::get();
+    if (instance && instance->m_tracing)
+        instance->emit_trace(category, name, begin_us, end_us);
+}
+
+//------------------------------------------------------------------------------
+unsigned long long logger::now_us()
+{
+    static LARGE_INTEGER s_freq = {};
+    if (!s_freq.QuadPart)
+        QueryPerformanceFrequency(&s_freq);
+
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return (unsigned long long)(now.QuadPart / s_freq.QuadPart) * 1000000 +
+        (unsigned long long)(now.QuadPart % s_freq.QuadPart) * 1000000 / s_freq.QuadPart;
+}
+
+
+
+//------------------------------------------------------------------------------
+trace_scope::trace_scope(const char* category, const char* name)
+: m_category(category)
+, m_name(name)
+{
+    if (logger::is_tracing())
+        m_begin = logger::now_us();
+}
+
+//------------------------------------------------------------------------------
+trace_scope::~trace_scope()
+{
+    if (m_begin)
+        logger::trace(m_category, m_name, m_begin, logger::now_us());
 }
 
 
 
 //------------------------------------------------------------------------------
 file_logger::file_logger(const char* log_path)
+: m_head(0)
+, m_dropped(0)
 {
     m_log_path << log_path;
+
+    m_records = new record[record_count];
+    for (unsigned int i = 0; i < record_count; ++i)
+        m_records[i].sequence.store(i, std::memory_order_relaxed);
+
+    m_wake = CreateEvent(nullptr, false, false, nullptr);
+
+    {
+        dbg_ignore_scope(snapshot, "Logger thread");
+        m_thread = std::make_unique<std::thread>(&proc, this);
+    }
 }
 
 //------------------------------------------------------------------------------
-void file_logger::emit(const char* function, int line, const char* fmt, va_list args)
+file_logger::~file_logger()
 {
-    FILE* file;
+    m_stop = true;
+    if (m_wake)
+        SetEvent(m_wake);
+    if (m_thread)
+        m_thread->join();
 
-    file = fopen(m_log_path.c_str(), "at");
-    if (file == nullptr)
-        return;
+    // If the process is exiting, the thread may have been terminated while
+    // holding the lock, so don't wait for the lock.
+    drain(false);
 
+    if (m_wake)
+        CloseHandle(m_wake);
+    delete [] m_records;
+}
+
+//------------------------------------------------------------------------------
+void file_logger::emit(const char* function, int line, const char* fmt, va_list args)
+{
     str<24> func_name;
     func_name << function;
 
     DWORD pid = GetCurrentProcessId();
 
-    str<256> buffer;
-    buffer.format("%04x %-24s %4d ", pid, func_name.c_str(), line);
-    fputs(buffer.c_str(), file);
-    vfprintf(file, fmt, args);
-    fputs("\n", file);
+    str<64> prefix;
+    prefix.format("%04x %-24s %4d ", pid, func_name.c_str(), line);
+
+    unsigned int pos;
+    record* r = reserve(pos);
+    if (!r)
+    {
+        ++m_dropped;
+        return;
+    }
 
+    va_list args_copy;
+    va_copy(args_copy, args);
+
+    r->kind = kind_log;
+    memcpy(r->text, prefix.c_str(), prefix.length());
+    const int room = int(sizeof(r->text) - prefix.length());
+    const int len = vsnprintf(r->text + prefix.length(), room, fmt, args);
+    if (len < 0 || len >= room)
+    {
+        // Too long for a record; release the record empty, and write the
+        // message directly (after everything queued ahead of it).
+        r->text[0] = '\0';
+        commit(r, pos);
+        write_direct(prefix.c_str(), fmt, args_copy);
+    }
+    else
+    {
+        commit(r, pos);
+    }
+
+    va_end(args_copy);
+}
+
+//------------------------------------------------------------------------------
+void file_logger::emit_trace(const char* category, const char* name, unsigned long long begin_us, unsigned long long end_us)
+{
+    unsigned int pos;
+    record* r = reserve(pos);
+    if (!r)
+    {
+        ++m_dropped;
+        return;
+    }
+
+    r->kind = kind_trace;
+    r->tid = GetCurrentThreadId();
+    r->category = category;
+    r->name = name;
+    r->begin_us = begin_us;
+    r->end_us = end_us;
+    commit(r, pos);
+}
+
+//------------------------------------------------------------------------------
+bool file_logger::begin_trace(const char* trace_path)
+{
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+
+    // Chrome trace JSON array format; the closing bracket is optional.
+    FILE* file = fopen(trace_path, "wt");
+    if (!file)
+        return false;
+    fputs("[\n", file);
     fclose(file);
+
+    m_trace_path = trace_path;
+    m_tracing = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void file_logger::end_trace()
+{
+    m_tracing = false;
+    drain(true);
+
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    m_trace_path.clear();
+}
+
+//------------------------------------------------------------------------------
+void file_logger::flush()
+{
+    drain(true);
+}
+
+//------------------------------------------------------------------------------
+// Bounded multi-producer ring buffer; each record's sequence number says
+// whether it is free for the producer at pos (== pos), or ready for the
+// consumer at pos (== pos + 1).
+file_logger::record* file_logger::reserve(unsigned int& pos)
+{
+    pos = m_head.load(std::memory_order_relaxed);
+    while (true)
+    {
+        record* r = &m_records[pos & (record_count - 1)];
+        const unsigned int seq = r->sequence.load(std::memory_order_acquire);
+        const int diff = int(seq - pos);
+        if (diff == 0)
+        {
+            if (m_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                return r;
+        }
+        else if (diff < 0)
+        {
+            return nullptr;
+        }
+        else
+        {
+            pos = m_head.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void file_logger::commit(record* r, unsigned int pos)
+{
+    r->sequence.store(pos + 1, std::memory_order_release);
+
+    // Wake the writer thread early if the buffer is filling up; otherwise it
+    // wakes up periodically on its own.
+    if (!((pos + 1) & (record_count / 2 - 1)))
+        SetEvent(m_wake);
+}
+
+//------------------------------------------------------------------------------
+void file_logger::drain(bool wait)
+{
+    std::unique_lock<std::mutex> lock(m_write_mutex, std::defer_lock);
+    if (wait)
+        lock.lock();
+    else if (!lock.try_lock())
+        return;
+
+    drain_locked();
+}
+
+//------------------------------------------------------------------------------
+void file_logger::drain_locked()
+{
+    str_moveable log;
+    str_moveable trace;
+    str<128> tmp;
+
+    const DWORD pid = GetCurrentProcessId();
+
+    while (true)
+    {
+        record& r = m_records[m_tail & (record_count - 1)];
+        if (r.sequence.load(std::memory_order_acquire) != m_tail + 1)
+            break;
+
+        if (r.kind == kind_log)
+        {
+            if (r.text[0])
+            {
+                log << r.text;
+                log << "\n";
+            }
+        }
+        else if (!m_trace_path.empty())
+        {
+            tmp.format("{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%llu,\"dur\":%llu,\"pid\":%u,\"tid\":%u},\n",
+                       r.name, r.category, r.begin_us, r.end_us - r.begin_us, pid, r.tid);
+            trace << tmp;
+        }
+
+        r.sequence.store(m_tail + record_count, std::memory_order_release);
+        ++m_tail;
+    }
+
+    if (const unsigned int dropped = m_dropped.exchange(0))
+    {
+        tmp.format("%04x (%u log records dropped)\n", pid, dropped);
+        log << tmp;
+    }
+
+    if (log.length())
+        write_log(log.c_str(), log.length());
+
+    if (trace.length())
+    {
+        if (FILE* file = fopen(m_trace_path.c_str(), "at"))
+        {
+            fwrite(trace.c_str(), 1, trace.length(), file);
+            fclose(file);
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+void file_logger::write_log(const char* text, unsigned int len)
+{
+    FILE* file = fopen(m_log_path.c_str(), "at");
+    if (file == nullptr)
+        return;
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    if (size > 0 && (unsigned long long)size + len > m_max_size)
+    {
+        fclose(file);
+
+        str<256> old_path;
+        old_path << m_log_path << ".1";
+        remove(old_path.c_str());
+        rename(m_log_path.c_str(), old_path.c_str());
+
+        file = fopen(m_log_path.c_str(), "at");
+        if (file == nullptr)
+            return;
+    }
+
+    fwrite(text, 1, len, file);
+    fclose(file);
+}
+
+//------------------------------------------------------------------------------
+void file_logger::write_direct(const char* prefix, const char* fmt, va_list args)
+{
+    str_moveable text;
+    text << prefix;
+
+    str_moveable message;
+    message.vformat(fmt, args);
+    text << message << "\n";
+
+    std::lock_guard<std::mutex> lock(m_write_mutex);
+    drain_locked();
+    write_log(text.c_str(), text.length());
+}
+
+//------------------------------------------------------------------------------
+void file_logger::proc(file_logger* logger)
+{
+    while (!logger->m_stop)
+    {
+        WaitForSingleObject(logger->m_wake, 100);
+        logger->drain(true);
+    }
 }
@@ -7,12 +7,15 @@
 #include "str.h"
 #include "str_iter.h"
 #include "str_compare.h"
+#include "str_unordered_set.h"
 #include <locale.h>
 #include <io.h>
 #include <fcntl.h>
 #include <sys/stat.h>
 #include <assert.h>
 #include <share.h>
+#include <memory>
+#include <vector>
 
 #ifndef _MSC_VER
 #define USE_PORTABLE
@@ -1127,6 +1130,232 @@ HANDLE dup_handle(HANDLE process_handle, HANDLE h, bool inherit)
     return new_h;
 }
 
+//------------------------------------------------------------------------------
+// Directory listings used by disambiguate_abbreviated_path().  While an
+// abbreviated_path_cache_scope is active, listings are kept and revalidated
+// against each directory's last write time, and resolved path components are
+// memoized.  So expanding a deep path while typing only reads the directories
+// for new components.
+struct abbrev_resolved
+{
+    wstr_moveable       m_component;
+    wstr_moveable       m_result;
+    bool                m_unique;
+};
+
+//------------------------------------------------------------------------------
+struct abbrev_dir
+{
+    wstr_moveable       m_name;
+    wstr_moveable       m_short;        // 8.3 name, or empty if none.
+};
+
+//------------------------------------------------------------------------------
+struct abbrev_listing
+{
+    wstr_moveable       m_key;
+    FILETIME            m_mtime;
+    std::vector<abbrev_dir> m_dirs;
+    std::vector<abbrev_resolved> m_resolved;
+};
+
+// Resolved components are searched linearly, so only a few are kept for each
+// listing.
+static const size_t c_max_abbrev_resolved = 32;
+
+//------------------------------------------------------------------------------
+static int s_abbrev_cache_depth = 0;
+static wstr_unordered_map<std::unique_ptr<abbrev_listing>> s_abbrev_cache;
+
+//------------------------------------------------------------------------------
+abbreviated_path_cache_scope::abbreviated_path_cache_scope()
+{
+    ++s_abbrev_cache_depth;
+}
+
+//------------------------------------------------------------------------------
+abbreviated_path_cache_scope::~abbreviated_path_cache_scope()
+{
+    assert(s_abbrev_cache_depth > 0);
+    if (!--s_abbrev_cache_depth)
+        s_abbrev_cache.clear();
+}
+
+//------------------------------------------------------------------------------
+static bool read_abbrev_listing(const wchar_t* pattern, abbrev_listing& listing)
+{
+    WIN32_FIND_DATAW fd;
+    HANDLE h = FindFirstFileW(pattern, &fd);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+
+    do
+    {
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+        {
+            listing.m_dirs.emplace_back();
+            abbrev_dir& dir = listing.m_dirs.back();
+            dir.m_name = fd.cFileName;
+            if (fd.cAlternateFileName[0])
+                dir.m_short = fd.cAlternateFileName;
+        }
+    }
+    while (FindNextFileW(h, &fd));
+
+    FindClose(h);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+static abbrev_listing* get_abbrev_listing(const wchar_t* parent)
+{
+    if (!*parent)
+        parent = L".";
+
+    DWORD len = GetFullPathNameW(parent, 0, nullptr, nullptr);
+    if (!len)
+        return nullptr;
+
+    wstr_moveable key;
+    key.reserve(len);
+    len = GetFullPathNameW(parent, key.size() - 1, key.data(), nullptr);
+    if (!len)
+        return nullptr;
+    CharLowerBuffW(key.data(), key.length());
+
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (!GetFileAttributesExW(key.c_str(), GetFileExInfoStandard, &fad))
+        return nullptr;
+
+    auto const iter = s_abbrev_cache.find(key.c_str());
+    if (iter != s_abbrev_cache.end())
+    {
+        abbrev_listing* listing = iter->second.get();
+        if (CompareFileTime(&listing->m_mtime, &fad.ftLastWriteTime) == 0)
+            return listing;
+        s_abbrev_cache.erase(iter);
+    }
+
+    std::unique_ptr<abbrev_listing> listing = std::make_unique<abbrev_listing>();
+    listing->m_mtime = fad.ftLastWriteTime;
+
+    wstr_moveable pattern(parent);
+    pattern << L"*";
+    if (!read_abbrev_listing(pattern.c_str(), *listing))
+        return nullptr;
+
+    listing->m_key = std::move(key);
+    abbrev_listing* ret = listing.get();
+    s_abbrev_cache.emplace(ret->m_key.c_str(), std::move(listing));
+    return ret;
+}
+
+//------------------------------------------------------------------------------
+static bool resolve_abbreviated_component(const wchar_t* parent, const wchar_t* dir, wstr_moveable& out, bool& unique)
+{
+    // Wildcards can't be matched against a cached listing, so let the OS
+    // match them.
+    const bool wild = !!wcspbrk(dir, L"*?");
+
+    abbrev_listing uncached;
+    abbrev_listing* listing;
+    if (wild || !s_abbrev_cache_depth)
+    {
+        wstr_moveable pattern(parent);
+        pattern << dir << L"*";
+        if (!read_abbrev_listing(pattern.c_str(), uncached))
+            return false;
+        listing = &uncached;
+    }
+    else
+    {
+        listing = get_abbrev_listing(parent);
+        if (!listing)
+            return false;
+
+        for (auto const& resolved : listing->m_resolved)
+        {
+            if (resolved.m_component.equals(dir))
+            {
+                out = resolved.m_result.c_str();
+                unique = resolved.m_unique;
+                return true;
+            }
+        }
+    }
+
+    const unsigned int dir_len = static_cast<unsigned int>(wcslen(dir));
+    const wchar_t* best = nullptr;
+    unsigned int count = 0;
+    unique = false;
+    out.clear();
+
+    for (auto const& entry : listing->m_dirs)
+    {
+        // Like the OS does for wildcards, also match against 8.3 names.
+        const wstr_moveable& name = entry.m_name;
+        if (!wild &&
+            _wcsnicmp(name.c_str(), dir, dir_len) != 0 &&
+            (entry.m_short.empty() || _wcsnicmp(entry.m_short.c_str(), dir, dir_len) != 0))
+            continue;
+
+        // Check for an exact match.
+        if (name.iequals(dir) || entry.m_short.iequals(dir))
+        {
+            out = name.c_str();
+            unique = true;
+            break;
+        }
+
+        // Find lcd.
+        if (!count++)
+        {
+            out = name.c_str();
+        }
+        else
+        {
+            int match_len = str_compare<wchar_t, true/*compute_lcd*/>(out.c_str(), name.c_str());
+            if (match_len >= 0)
+                out.truncate(match_len);
+        }
+
+        // Find best match for the case of the original input.
+        if (!best && wcsncmp(name.c_str(), dir, dir_len) == 0)
+            best = name.c_str();
+    }
+
+    if (!unique)
+    {
+        if (!count)
+            return false;
+
+        unique = (count == 1);
+
+        if (best)
+        {
+            wstr_moveable tmp(best);
+            int match_len = str_compare<wchar_t, true/*compute_lcd*/>(tmp.c_str(), out.c_str());
+            if (match_len >= 0)
+                tmp.truncate(match_len);
+            out = std::move(tmp);
+        }
+    }
+
+    if (listing != &uncached)
+    {
+        if (listing->m_resolved.size() >= c_max_abbrev_resolved)
+            listing->m_resolved.clear();
+
+        abbrev_resolved resolved;
+        resolved.m_component = dir;
+        resolved.m_result = out.c_str();
+        resolved.m_unique = unique;
+        listing->m_resolved.emplace_back(std::move(resolved));
+    }
+
+    return true;
+}
+
 //------------------------------------------------------------------------------
 bool disambiguate_abbreviated_path(const char*& in, str_base& out)
 {
@@ -1221,81 +1450,18 @@ bool disambiguate_abbreviated_path(const char*& in, str_base& out)
             break;
         }
 
-        // Append star to check for ambiguous matches.
-        const unsigned int committed = disambiguated.length();
-        disambiguated << wnext << L"*";
-
-        // Lookup in file system.
-        WIN32_FIND_DATAW fd;
-        HANDLE h = FindFirstFileW(disambiguated.c_str(), &fd);
-        if (h == INVALID_HANDLE_VALUE)
-            return false;
-
-        while (!(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY))
-        {
-            if (!FindNextFileW(h, &fd))
-            {
-                FindClose(h);
-                return false;
-            }
-        }
-
         // Skip past the leading separator, if any, in the directory component.
+        const unsigned int committed = disambiguated.length();
         const wchar_t *dir = wnext.c_str();
         while (path::is_separator(*dir))
             ++dir;
-        const unsigned int dir_len = static_cast<unsigned int>(wcslen(dir));
-
-        // Copy file name because FindNextFileW will overwrite it.
-        wadd = fd.cFileName;
-
-        // Check for an exact or unique match.
-        unique = wadd.iequals(dir);
-        if (!unique)
-        {
-            wstr_moveable best;
-            bool have_best = false;
-
-            if (wcsncmp(dir, fd.cFileName, dir_len) == 0)
-            {
-                best = fd.cFileName;
-                have_best = true;
-            }
-
-            do
-            {
-                unique = !FindNextFileW(h, &fd);
-            }
-            while (!unique && !(fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY));
-
-            if (!unique)
-            {
-                // Find lcd.
-                int match_len = str_compare<wchar_t, true/*compute_lcd*/>(wadd.c_str(), fd.cFileName);
-                if (match_len >= 0)
-                    wadd.truncate(match_len);
 
-                // Find best match for the case of the original input.
-                do
-                {
-                    if (!have_best && wcsncmp(fd.cFileName, dir, dir_len) == 0)
-                    {
-                        best = fd.cFileName;
-                        have_best = true;
-                    }
-                }
-                while (FindNextFileW(h, &fd));
-            }
-
-            if (have_best)
-            {
-                int match_len = str_compare<wchar_t, true/*compute_lcd*/>(best.c_str(), wadd.c_str());
-                if (match_len >= 0)
-                    best.truncate(match_len);
-                wadd = std::move(best);
-            }
-        }
-        FindClose(h);
+        // Look up the component in its parent directory.
+        wstr_moveable parent;
+        parent.concat(disambiguated.c_str(), committed);
+        parent.concat(wnext.c_str(), int(dir - wnext.c_str()));
+        if (!resolve_abbreviated_component(parent.c_str(), dir, wadd, unique))
+            return false;
 
         // If lcd is empty, use the name from the input string (e.g. a leading
         // wildcard can cause this to happen).
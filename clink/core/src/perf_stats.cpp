@@ -0,0 +1,207 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "perf_stats.h"
+#include "str.h"
+
+#ifdef USE_PERF_STATS
+
+//------------------------------------------------------------------------------
+static const char* const c_stage_names[] =
+{
+    "keystroke",
+    "update_internal",
+    "collect_words",
+    "classify",
+    "update_matches",
+    "try_suggest",
+    "coroutines",
+    "display",
+};
+static_assert(sizeof_array(c_stage_names) == int(perf_stage::max), "c_stage_names must match perf_stage");
+
+//------------------------------------------------------------------------------
+// Values below 8 get a bucket each; above that, each power of 2 is split into
+// 4 buckets.
+static const unsigned int c_linear = 8;
+static const unsigned int c_sub_bits = 2;
+static const unsigned int c_num_buckets = c_linear + (64 - 3) * (1 << c_sub_bits);
+
+struct histogram
+{
+    unsigned int        buckets[c_num_buckets];
+    unsigned int        count;
+    unsigned long long  max;
+};
+
+static histogram s_histograms[int(perf_stage::max)];
+static bool s_enabled = false;
+
+// Bytes written by each popup list redraw; not a time, so it's kept apart
+// from the histograms.
+struct byte_count
+{
+    unsigned int        count;
+    unsigned long long  total;
+    unsigned long long  max;
+};
+
+static byte_count s_popup_bytes;
+
+//------------------------------------------------------------------------------
+static unsigned int bucket_index(unsigned long long us)
+{
+    if (us < c_linear)
+        return (unsigned int)us;
+
+    unsigned int e = 0;
+    for (unsigned long long v = us; v > 1; v >>= 1)
+        ++e;
+
+    const unsigned int sub = (unsigned int)(us >> (e - c_sub_bits)) & ((1 << c_sub_bits) - 1);
+    return c_linear + (e - 3) * (1 << c_sub_bits) + sub;
+}
+
+//------------------------------------------------------------------------------
+static unsigned long long bucket_upper_bound(unsigned int index)
+{
+    if (index < c_linear)
+        return index;
+
+    index -= c_linear;
+    const unsigned int e = index / (1 << c_sub_bits) + 3;
+    const unsigned long long sub = index % (1 << c_sub_bits);
+    const unsigned long long lower = ((1ull << c_sub_bits) + sub) << (e - c_sub_bits);
+    return lower + (1ull << (e - c_sub_bits)) - 1;
+}
+
+//------------------------------------------------------------------------------
+static unsigned long long percentile(const histogram& h, unsigned int pct)
+{
+    const unsigned long long target = ((unsigned long long)h.count * pct + 99) / 100;
+    unsigned long long seen = 0;
+    for (unsigned int i = 0; i < c_num_buckets; ++i)
+    {
+        seen += h.buckets[i];
+        if (seen >= target)
+            return min(bucket_upper_bound(i), h.max);
+    }
+    return h.max;
+}
+
+//------------------------------------------------------------------------------
+static long long perf_counter()
+{
+    LARGE_INTEGER now;
+    QueryPerformanceCounter(&now);
+    return now.QuadPart;
+}
+
+
+
+//------------------------------------------------------------------------------
+perf_timer::perf_timer(perf_stage stage)
+: m_stage(stage)
+, m_begin(s_enabled ? perf_counter() : 0)
+{
+}
+
+//------------------------------------------------------------------------------
+perf_timer::~perf_timer()
+{
+    if (!m_begin)
+        return;
+
+    static long long s_freq = 0;
+    if (!s_freq)
+    {
+        LARGE_INTEGER freq;
+        QueryPerformanceFrequency(&freq);
+        s_freq = freq.QuadPart;
+    }
+
+    const long long elapsed = perf_counter() - m_begin;
+    perf_stats_record(m_stage, (unsigned long long)(elapsed * 1000000 / s_freq));
+}
+
+//------------------------------------------------------------------------------
+void perf_stats_enable(bool enable)
+{
+    s_enabled = enable;
+}
+
+//------------------------------------------------------------------------------
+bool perf_stats_enabled()
+{
+    return s_enabled;
+}
+
+//------------------------------------------------------------------------------
+void perf_stats_record(perf_stage stage, unsigned long long us)
+{
+    if (!s_enabled)
+        return;
+
+    histogram& h = s_histograms[int(stage)];
+    h.buckets[bucket_index(us)]++;
+    h.count++;
+    if (h.max < us)
+        h.max = us;
+}
+
+//------------------------------------------------------------------------------
+void perf_stats_record_popup_bytes(unsigned long long bytes)
+{
+    if (!s_enabled)
+        return;
+
+    s_popup_bytes.count++;
+    s_popup_bytes.total += bytes;
+    if (s_popup_bytes.max < bytes)
+        s_popup_bytes.max = bytes;
+}
+
+//------------------------------------------------------------------------------
+bool perf_stats_report(str_base& out)
+{
+    out.clear();
+
+    str<128> line;
+    for (int i = 0; i < int(perf_stage::max); ++i)
+    {
+        const histogram& h = s_histograms[i];
+        if (!h.count)
+            continue;
+
+        if (out.empty())
+        {
+            line.format("%-16s %9s %9s %9s %9s %9s  (microseconds)\n",
+                        "stage", "count", "p50", "p95", "p99", "max");
+            out << line;
+        }
+
+        line.format("%-16s %9u %9llu %9llu %9llu %9llu\n",
+                    c_stage_names[i], h.count,
+                    percentile(h, 50), percentile(h, 95), percentile(h, 99), h.max);
+        out << line;
+    }
+
+    if (s_popup_bytes.count)
+    {
+        line.format("popup redraws: %u, bytes avg %llu, bytes max %llu\n",
+                    s_popup_bytes.count, s_popup_bytes.total / s_popup_bytes.count, s_popup_bytes.max);
+        out << line;
+    }
+
+    return !out.empty();
+}
+
+//------------------------------------------------------------------------------
+void perf_stats_reset()
+{
+    memset(s_histograms, 0, sizeof(s_histograms));
+    memset(&s_popup_bytes, 0, sizeof(s_popup_bytes));
+}
+
+#endif // USE_PERF_STATS
@@ -0,0 +1,297 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "recursive_globber.h"
+#include "debugheap.h"
+#include "path.h"
+
+#include <wildmatch.h>
+
+#include <chrono>
+
+//------------------------------------------------------------------------------
+class globber_source : public recursive_globber::source
+{
+public:
+    void enumerate(const char* dir, bool hidden, bool system, std::vector<recursive_globber::entry>& out) override
+    {
+        str<280> pattern(dir);
+        path::append(pattern, "*");
+
+        globber globber(pattern.c_str());
+        globber.suffix_dirs(false);
+        globber.hidden(hidden);
+        globber.system(system);
+
+        recursive_globber::entry e;
+        while (globber.next(e.name, false, &e.info))
+            out.emplace_back(std::move(e));
+    }
+};
+
+//------------------------------------------------------------------------------
+static bool has_wildcard(const char* s, const char* end)
+{
+    for (; s < end; ++s)
+        if (*s == '*' || *s == '?' || *s == '[')
+            return true;
+    return false;
+}
+
+
+
+//------------------------------------------------------------------------------
+recursive_globber::recursive_globber(const char* pattern, std::shared_ptr<source> src)
+: m_source(src ? src : std::make_shared<globber_source>())
+, m_canceled(false)
+{
+    str<280> tmp;
+    concat_strip_quotes(tmp, pattern);
+    for (char* p = tmp.data(); *p; ++p)
+        if (*p == '\\')
+            *p = '/';
+
+    // A trailing separator means only directories can match.
+    if (tmp.length() > 1 && tmp.c_str()[tmp.length() - 1] == '/')
+    {
+        tmp.truncate(tmp.length() - 1);
+        m_files = false;
+    }
+
+    // The leading directories without wildcards are the root of the traversal.
+    // The final segment always belongs to the pattern, even without wildcards.
+    const char* start = tmp.c_str();
+    const char* root_end = start;
+    for (const char* seg = start; true;)
+    {
+        const char* slash = strchr(seg, '/');
+        if (!slash || has_wildcard(seg, slash))
+            break;
+        root_end = slash + 1;
+        seg = slash + 1;
+    }
+
+    m_root.concat(start, int(root_end - start));
+    m_pattern = root_end;
+
+    // Split the pattern into segments for pruning.  Everything at or after the
+    // first segment containing `**` can span any number of directories.
+    for (const char* seg = m_pattern.c_str(); *seg;)
+    {
+        const char* slash = strchr(seg, '/');
+        const int len = slash ? int(slash - seg) : int(strlen(seg));
+        if (len)
+        {
+            str_moveable s;
+            s.concat(seg, len);
+            m_segments.emplace_back(std::move(s));
+        }
+        seg += len + (slash ? 1 : 0);
+    }
+
+    m_wildstar = (unsigned int)m_segments.size();
+    for (unsigned int i = 0; i < m_segments.size(); ++i)
+    {
+        if (strstr(m_segments[i].c_str(), "**"))
+        {
+            m_wildstar = i;
+            break;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+recursive_globber::~recursive_globber()
+{
+    cancel();
+    for (auto& thread : m_threads)
+        thread.join();
+}
+
+//------------------------------------------------------------------------------
+void recursive_globber::start()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    if (m_started)
+        return;
+    m_started = true;
+
+    if (m_segments.empty())
+        return;
+
+    work w;
+    w.depth = 0;
+    m_work.emplace_back(std::move(w));
+    m_pending = 1;
+
+    int count = m_num_threads;
+    if (count <= 0)
+        count = min<int>(4, max<int>(1, int(std::thread::hardware_concurrency())));
+
+    dbg_ignore_scope(snapshot, "Recursive globber threads");
+    for (int i = 0; i < count; ++i)
+        m_threads.emplace_back(&proc, this);
+}
+
+//------------------------------------------------------------------------------
+// Returns true and sets out to the next result.  Returns false if no result is
+// available within timeout_ms; is_done() tells whether more may arrive.
+bool recursive_globber::next(str_base& out, globber::extrainfo* extrainfo, unsigned int timeout_ms)
+{
+    start();
+
+    std::unique_lock<std::mutex> lock(m_mutex);
+
+    auto ready = [this]() {
+        return !m_results.empty() || !m_pending || m_canceled;
+    };
+
+    if (timeout_ms == INFINITE)
+        m_result_ready.wait(lock, ready);
+    else if (timeout_ms)
+        m_result_ready.wait_for(lock, std::chrono::milliseconds(timeout_ms), ready);
+
+    if (m_canceled || m_results.empty())
+        return false;
+
+    result& r = m_results.front();
+    out = r.path.c_str();
+    if (extrainfo)
+        *extrainfo = r.info;
+    m_results.pop_front();
+    return true;
+}
+
+//------------------------------------------------------------------------------
+bool recursive_globber::is_done() const
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_canceled || (m_started && !m_pending && m_results.empty());
+}
+
+//------------------------------------------------------------------------------
+void recursive_globber::cancel()
+{
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_canceled = true;
+    m_work.clear();
+    m_results.clear();
+    m_work_ready.notify_all();
+    m_result_ready.notify_all();
+}
+
+//------------------------------------------------------------------------------
+// Depth is the number of segments in the directory's path relative to the
+// root, and name is its last segment.
+bool recursive_globber::can_descend(unsigned int depth, const char* name) const
+{
+    const unsigned int index = depth - 1;
+    if (index >= m_wildstar)
+        return true;
+    if (depth >= m_segments.size())
+        return false;
+    return wildmatch(m_segments[index].c_str(), name, WM_PATHNAME|WM_CASEFOLD|WM_NOESCAPE) == WM_MATCH;
+}
+
+//------------------------------------------------------------------------------
+bool recursive_globber::is_match(const char* rel) const
+{
+    return wildmatch(m_pattern.c_str(), rel, WM_WILDSTAR|WM_CASEFOLD|WM_NOESCAPE) == WM_MATCH;
+}
+
+//------------------------------------------------------------------------------
+void recursive_globber::visit(const str_moveable& rel, unsigned int depth, std::vector<entry>& entries)
+{
+    str<280> dir(m_root.c_str());
+    dir.concat(rel.c_str(), rel.length());
+    if (dir.empty())
+        dir = ".";
+    path::normalise_separators(dir);
+
+    entries.clear();
+    m_source->enumerate(dir.c_str(), m_hidden, m_system, entries);
+
+    std::vector<result> found;
+    std::vector<work> more;
+    str_moveable child;
+    for (const auto& e : entries)
+    {
+        if (m_canceled)
+            return;
+
+        child = rel.c_str();
+        if (child.length())
+            child.concat("/", 1);
+        child.concat(e.name.c_str(), e.name.length());
+
+        const bool is_dir = !!(e.info.attr & FILE_ATTRIBUTE_DIRECTORY);
+        if ((is_dir ? m_directories : m_files) && is_match(child.c_str()))
+        {
+            result r;
+            r.path = m_root.c_str();
+            r.path.concat(child.c_str(), child.length());
+            path::normalise_separators(r.path);
+            if (is_dir && m_dir_suffix)
+                r.path << PATH_SEP;
+            r.info = e.info;
+            found.emplace_back(std::move(r));
+        }
+
+        // Don't follow symlinks or junctions; they can form cycles.
+        if (is_dir &&
+            !(e.info.attr & FILE_ATTRIBUTE_REPARSE_POINT) &&
+            can_descend(depth + 1, e.name.c_str()))
+        {
+            work w;
+            w.rel = std::move(child);
+            w.depth = depth + 1;
+            more.emplace_back(std::move(w));
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_canceled)
+        return;
+
+    for (auto& r : found)
+        m_results.emplace_back(std::move(r));
+    for (auto& w : more)
+        m_work.emplace_back(std::move(w));
+    m_pending += (unsigned int)more.size();
+
+    if (!more.empty())
+        m_work_ready.notify_all();
+    if (!found.empty())
+        m_result_ready.notify_all();
+}
+
+//------------------------------------------------------------------------------
+void recursive_globber::proc(recursive_globber* rg)
+{
+    std::vector<entry> entries;
+    while (true)
+    {
+        work w;
+        {
+            std::unique_lock<std::mutex> lock(rg->m_mutex);
+            rg->m_work_ready.wait(lock, [rg]() {
+                return !rg->m_work.empty() || !rg->m_pending || rg->m_canceled;
+            });
+            if (rg->m_canceled || rg->m_work.empty())
+                break;
+            w = std::move(rg->m_work.front());
+            rg->m_work.pop_front();
+        }
+
+        rg->visit(w.rel, w.depth, entries);
+
+        std::lock_guard<std::mutex> lock(rg->m_mutex);
+        if (--rg->m_pending == 0)
+        {
+            rg->m_work_ready.notify_all();
+            rg->m_result_ready.notify_all();
+        }
+    }
+}
@@ -0,0 +1,157 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/flat_hash_map.h>
+#include <core/str.h>
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+TEST_CASE("str_fast_hash")
+{
+    // Length-aware and NUL-terminated forms agree.
+    REQUIRE(str_fast_hash("abcdefghijklmnopqrstuvwxyz") == str_fast_hash("abcdefghijklmnopqrstuvwxyz", 26));
+    REQUIRE(str_fast_hash("abc") == str_fast_hash("abcdef", 3));
+    REQUIRE(wstr_fast_hash(L"abc") == wstr_fast_hash(L"abcdef", 3));
+
+    // Every byte contributes, including at the ends of each word.
+    str<> a, b;
+    for (unsigned int len = 1; len <= 40; ++len)
+    {
+        a.clear();
+        for (unsigned int i = 0; i < len; ++i)
+            a.concat("x", 1);
+        for (unsigned int i = 0; i < len; ++i)
+        {
+            b = a.c_str();
+            b.data()[i] = 'y';
+            REQUIRE(str_fast_hash(a.c_str()) != str_fast_hash(b.c_str()));
+        }
+    }
+
+    REQUIRE(str_fast_hash("") != str_fast_hash("\0", 1));
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("str_flat_map")
+{
+    str_flat_map<int> map(1024);
+    REQUIRE(map.empty());
+    REQUIRE(!map.find("a"));
+    REQUIRE(!map.erase("a"));
+
+    SECTION("Insert")
+    {
+        str<> key;
+        for (int i = 0; i < 1000; ++i)
+        {
+            key.format("key%d", i);
+            auto result = map.emplace(key.c_str(), i);
+            REQUIRE(result.second);
+            REQUIRE(*result.first == i);
+        }
+        REQUIRE(map.size() == 1000);
+
+        // Keys were copied into the map's arena.
+        key = "key10";
+        REQUIRE(!map.emplace(key.c_str(), -1).second);
+        key.data()[0] = 'K';
+        REQUIRE(map.find("key10"));
+        REQUIRE(*map.find("key10") == 10);
+
+        for (int i = 0; i < 1000; ++i)
+        {
+            key.format("key%d", i);
+            const int* value = map.find(key.c_str());
+            REQUIRE(value);
+            REQUIRE(*value == i);
+        }
+        REQUIRE(!map.find("key1000"));
+
+        REQUIRE(map.insert_or_assign("key10", 42));
+        REQUIRE(*map.find("key10") == 42);
+        REQUIRE(map.size() == 1000);
+
+        int count = 0;
+        map.for_each([&] (const char* k, const int&) {
+            REQUIRE(strncmp(k, "key", 3) == 0);
+            ++count;
+        });
+        REQUIRE(count == 1000);
+    }
+
+    SECTION("Erase")
+    {
+        str<> key;
+        for (int i = 0; i < 500; ++i)
+        {
+            key.format("key%d", i);
+            map.emplace(key.c_str(), i);
+        }
+
+        // Removing entries must not break the probe chains of the others.
+        for (int i = 0; i < 500; i += 2)
+        {
+            key.format("key%d", i);
+            REQUIRE(map.erase(key.c_str()));
+            REQUIRE(!map.erase(key.c_str()));
+        }
+        REQUIRE(map.size() == 250);
+
+        for (int i = 0; i < 500; ++i)
+        {
+            key.format("key%d", i);
+            const int* value = map.find(key.c_str());
+            if (i & 1)
+            {
+                REQUIRE(value);
+                REQUIRE(*value == i);
+            }
+            else
+            {
+                REQUIRE(!value);
+            }
+        }
+    }
+
+    SECTION("Clear")
+    {
+        map.emplace("a", 1);
+        map.emplace("b", 2);
+        map.clear();
+        REQUIRE(map.empty());
+        REQUIRE(!map.find("a"));
+        map.emplace("a", 3);
+        REQUIRE(*map.find("a") == 3);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("str_flat_set")
+{
+    // Without an arena, the caller owns the keys.
+    std::vector<str_moveable> keys;
+    for (int i = 0; i < 100; ++i)
+    {
+        str_moveable key;
+        key.format("%d", i);
+        keys.emplace_back(std::move(key));
+    }
+
+    str_flat_set set;
+    for (const auto& key : keys)
+        REQUIRE(set.insert(key.c_str()));
+    for (const auto& key : keys)
+        REQUIRE(!set.insert(key.c_str()));
+    REQUIRE(set.size() == 100);
+    REQUIRE(set.contains("42"));
+    REQUIRE(!set.contains("100"));
+
+    wstr_flat_set wset(256);
+    REQUIRE(wset.insert(L"abc"));
+    REQUIRE(!wset.insert(L"abc"));
+    REQUIRE(wset.contains(L"abc"));
+    REQUIRE(!wset.contains(L"ab"));
+}
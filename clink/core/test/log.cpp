@@ -0,0 +1,100 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "fs_fixture.h"
+
+#include <core/log.h>
+#include <core/os.h>
+#include <core/str.h>
+
+//------------------------------------------------------------------------------
+static void read_file(const char* name, str_base& out)
+{
+    out.clear();
+    if (FILE* f = fopen(name, "rt"))
+    {
+        char buffer[1024];
+        while (fgets(buffer, sizeof(buffer), f))
+            out.concat(buffer);
+        fclose(f);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("File logger")
+{
+    static const char* empty_fs[] = { nullptr };
+    fs_fixture fs(empty_fs);
+
+    REQUIRE(!logger::get());
+    file_logger* log = new file_logger("test.log");
+
+    str_moveable content;
+
+    SECTION("Buffered")
+    {
+        LOG("first %d", 1);
+        LOG("second %s", "two");
+        log->flush();
+
+        read_file("test.log", content);
+        REQUIRE(strstr(content.c_str(), "first 1\n"));
+        REQUIRE(strstr(content.c_str(), "second two\n"));
+        REQUIRE(strstr(content.c_str(), "first 1") < strstr(content.c_str(), "second two"));
+    }
+
+    SECTION("Longer than a record")
+    {
+        str_moveable long_text;
+        for (int i = 0; i < 100; ++i)
+            long_text << "0123456789";
+
+        LOG("short");
+        LOG("%s", long_text.c_str());
+        log->flush();
+
+        read_file("test.log", content);
+        REQUIRE(strstr(content.c_str(), long_text.c_str()));
+        REQUIRE(strstr(content.c_str(), "short") < strstr(content.c_str(), long_text.c_str()));
+    }
+
+    SECTION("Rotation")
+    {
+        log->set_max_size(200);
+        for (int i = 0; i < 10; ++i)
+        {
+            LOG("line %d of the rotation test", i);
+            log->flush();
+        }
+
+        REQUIRE(os::get_path_type("test.log.1") == os::path_type_file);
+        read_file("test.log", content);
+        REQUIRE(content.length() <= 200);
+        REQUIRE(strstr(content.c_str(), "line 9 "));
+    }
+
+    SECTION("Trace events")
+    {
+        REQUIRE(!logger::is_tracing());
+        {
+            TRACE_SCOPE("test", "not_traced");
+        }
+
+        REQUIRE(log->begin_trace("test_trace.json"));
+        REQUIRE(logger::is_tracing());
+        {
+            TRACE_SCOPE("test", "traced");
+        }
+        log->end_trace();
+        REQUIRE(!logger::is_tracing());
+
+        read_file("test_trace.json", content);
+        REQUIRE(strncmp(content.c_str(), "[\n", 2) == 0);
+        REQUIRE(strstr(content.c_str(), "\"name\":\"traced\",\"cat\":\"test\",\"ph\":\"X\""));
+        REQUIRE(!strstr(content.c_str(), "not_traced"));
+    }
+
+    delete log;
+    REQUIRE(!logger::get());
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/perf_stats.h>
+#include <core/str.h>
+
+#ifdef USE_PERF_STATS
+
+//------------------------------------------------------------------------------
+TEST_CASE("Perf stats")
+{
+    perf_stats_reset();
+
+    str_moveable report;
+    REQUIRE(!perf_stats_report(report));
+
+    // Nothing is recorded until the stats are enabled.
+    perf_stats_enable(false);
+    perf_stats_record(perf_stage::display, 1);
+    REQUIRE(!perf_stats_report(report));
+    perf_stats_enable(true);
+
+    for (unsigned int i = 1; i <= 1000; ++i)
+        perf_stats_record(perf_stage::display, i);
+    perf_stats_record(perf_stage::classify, 5);
+
+    REQUIRE(perf_stats_report(report));
+
+    const char* line = strstr(report.c_str(), "\ndisplay ");
+    REQUIRE(line);
+
+    char name[32];
+    unsigned int count;
+    unsigned long long p50, p95, p99, max;
+    REQUIRE(sscanf(line + 1, "%31s %u %llu %llu %llu %llu", name, &count, &p50, &p95, &p99, &max) == 6);
+    REQUIRE(count == 1000);
+    REQUIRE(max == 1000);
+
+    // Percentiles are bucket upper bounds, so they're within 25% above the
+    // exact values.
+    REQUIRE(p50 >= 500);
+    REQUIRE(p50 <= 625);
+    REQUIRE(p95 >= 950);
+    REQUIRE(p95 <= 1000);
+    REQUIRE(p99 >= 990);
+    REQUIRE(p99 <= 1000);
+
+    line = strstr(report.c_str(), "\nclassify ");
+    REQUIRE(line);
+    REQUIRE(sscanf(line + 1, "%31s %u %llu %llu %llu %llu", name, &count, &p50, &p95, &p99, &max) == 6);
+    REQUIRE(count == 1);
+    REQUIRE(p50 == 5);
+
+    // Stages without samples are omitted.
+    REQUIRE(!strstr(report.c_str(), "try_suggest"));
+    REQUIRE(!strstr(report.c_str(), "popup"));
+
+    // Popup output is counted in bytes, apart from the stage times.
+    perf_stats_record_popup_bytes(100);
+    perf_stats_record_popup_bytes(300);
+    REQUIRE(perf_stats_report(report));
+    REQUIRE(strstr(report.c_str(), "(microseconds)\n"));
+    REQUIRE(strstr(report.c_str(), "\npopup redraws: 2, bytes avg 200, bytes max 300\n"));
+
+    perf_stats_reset();
+    REQUIRE(!perf_stats_report(report));
+
+    // Popup output alone is reported too.
+    perf_stats_record_popup_bytes(50);
+    REQUIRE(perf_stats_report(report));
+    REQUIRE(strcmp(report.c_str(), "popup redraws: 1, bytes avg 50, bytes max 50\n") == 0);
+
+    perf_stats_reset();
+    REQUIRE(!perf_stats_report(report));
+    perf_stats_enable(false);
+}
+
+#endif // USE_PERF_STATS
@@ -0,0 +1,177 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/path.h>
+#include <core/recursive_globber.h>
+#include <core/str.h>
+
+#include <algorithm>
+#include <mutex>
+#include <string>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Enumerates an in-memory list of files, so the traversal and pruning can be
+// tested independently of the file system.
+class memory_source : public recursive_globber::source
+{
+public:
+    memory_source(const char* const* files) : m_files(files) {}
+
+    void enumerate(const char* dir, bool hidden, bool system, std::vector<recursive_globber::entry>& out) override
+    {
+        str<> prefix(dir);
+        path::normalise_separators(prefix, '/');
+        if (prefix.equals("."))
+            prefix.clear();
+        else if (prefix.length() && prefix.c_str()[prefix.length() - 1] == '/')
+            prefix.truncate(prefix.length() - 1);
+
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_visited.emplace_back(prefix.c_str());
+        }
+
+        if (prefix.length())
+            prefix << "/";
+
+        std::vector<std::string> seen;
+        for (const char* const* file = m_files; *file; ++file)
+        {
+            if (strncmp(*file, prefix.c_str(), prefix.length()) != 0)
+                continue;
+
+            const char* name = *file + prefix.length();
+            const char* slash = strchr(name, '/');
+            std::string s(name, slash ? slash - name : strlen(name));
+            if (std::find(seen.begin(), seen.end(), s) != seen.end())
+                continue;
+            seen.emplace_back(s);
+
+            recursive_globber::entry e;
+            e.name = s.c_str();
+            memset(&e.info, 0, sizeof(e.info));
+            e.info.attr = slash ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+            out.emplace_back(std::move(e));
+        }
+    }
+
+    std::vector<std::string> visited()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        std::vector<std::string> v = m_visited;
+        std::sort(v.begin(), v.end());
+        return v;
+    }
+
+private:
+    const char* const*  m_files;
+    std::mutex          m_mutex;
+    std::vector<std::string> m_visited;
+};
+
+//------------------------------------------------------------------------------
+static std::vector<std::string> collect(recursive_globber& rg)
+{
+    std::vector<std::string> out;
+    str<> file;
+    while (rg.next(file))
+    {
+        path::normalise_separators(file, '/');
+        out.emplace_back(file.c_str());
+    }
+    std::sort(out.begin(), out.end());
+    return out;
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Recursive globber")
+{
+    static const char* const files[] = {
+        "abc.csproj",
+        "readme.md",
+        "src/app/app.csproj",
+        "src/app/main.cs",
+        "src/lib/core/core.csproj",
+        "src/lib/core/impl.cs",
+        "test/unit/unit.csproj",
+        "docs/guide/intro.md",
+        nullptr,
+    };
+
+    auto source = std::make_shared<memory_source>(files);
+
+    SECTION("Wildstar")
+    {
+        recursive_globber rg("**/*.csproj", source);
+        rg.threads(3);
+        auto results = collect(rg);
+        REQUIRE(results == std::vector<std::string>({
+            "abc.csproj",
+            "src/app/app.csproj",
+            "src/lib/core/core.csproj",
+            "test/unit/unit.csproj",
+        }));
+        REQUIRE(rg.is_done());
+    }
+
+    SECTION("Literal root")
+    {
+        recursive_globber rg("src\\**\\*.CSPROJ", source);
+        REQUIRE(strcmp(rg.get_root(), "src/") == 0);
+        auto results = collect(rg);
+        REQUIRE(results == std::vector<std::string>({
+            "src/app/app.csproj",
+            "src/lib/core/core.csproj",
+        }));
+
+        // Nothing outside the root is enumerated.
+        auto visited = source->visited();
+        REQUIRE(visited == std::vector<std::string>({
+            "src",
+            "src/app",
+            "src/lib",
+            "src/lib/core",
+        }));
+    }
+
+    SECTION("Pruning")
+    {
+        recursive_globber rg("s*/a*/*.cs", source);
+        auto results = collect(rg);
+        REQUIRE(results == std::vector<std::string>({
+            "src/app/main.cs",
+        }));
+
+        // Subtrees whose names cannot match are not enumerated, and nothing
+        // deeper than the pattern is enumerated.
+        auto visited = source->visited();
+        REQUIRE(visited == std::vector<std::string>({
+            "",
+            "src",
+            "src/app",
+        }));
+    }
+
+    SECTION("Directories only")
+    {
+        recursive_globber rg("**/core/", source);
+        rg.suffix_dirs(false);
+        auto results = collect(rg);
+        REQUIRE(results == std::vector<std::string>({
+            "src/lib/core",
+        }));
+    }
+
+    SECTION("Cancel")
+    {
+        recursive_globber rg("**", source);
+        rg.start();
+        rg.cancel();
+        str<> file;
+        REQUIRE(!rg.next(file));
+        REQUIRE(rg.is_done());
+    }
+}
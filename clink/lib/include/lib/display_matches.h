@@ -34,6 +34,7 @@ extern const char *_rl_selected_color;
 void reset_tmpbuf(void);
 void mark_tmpbuf(void);
 const char* get_tmpbuf_rollback(void);
+const char* get_tmpbuf(int* len);
 void rollback_tmpbuf(void);
 void append_tmpbuf_char(char c);
 void append_tmpbuf_string(const char* s, int len);
@@ -52,6 +53,7 @@ int printable_len(const char* match, match_type type);
 #define MATCH_FLAG_APPEND_DISPLAY       0x01
 #define MATCH_FLAG_HAS_SUPPRESS_APPEND  0x02
 #define MATCH_FLAG_SUPPRESS_APPEND      0x04
+#define MATCH_FLAG_HAS_FILE_INFO        0x08    // A match_file_info record follows the DESCRIPTION.
 
 // For display_matches, the matches array must contain specially formatted
 // match entries:
@@ -1,6 +1,7 @@
 #pragma once
 
 class line_buffer;
+class printer;
 typedef struct _history_expansion history_expansion;
 
 extern void reset_readline_display();
@@ -35,6 +36,8 @@ extern unsigned int get_readline_display_top_offset();
 #define FACE_NONE           'n'
 
 //------------------------------------------------------------------------------
+// Coalesces Readline output in its scope into one write, which also joins the
+// printer's current frame (if any).
 class display_accumulator
 {
 public:
@@ -47,6 +50,7 @@ private:
     static void     fflush_proc(FILE*);
     void (*m_saved_fwrite)(FILE*, const char*, int) = nullptr;
     void (*m_saved_fflush)(FILE*) = nullptr;
+    printer*        m_printer = nullptr;
     bool            m_active = false;
     static int      s_nested;
 };
@@ -42,6 +42,7 @@ struct bank_handles
     explicit        operator bool () const;
     void*           m_handle_lines = nullptr;
     void*           m_handle_removals = nullptr;
+    void*           m_handle_index = nullptr;
 };
 
 //------------------------------------------------------------------------------
@@ -117,6 +118,8 @@ public:
                                 ~history_db();
     void                        initialise(str_base* error_message=nullptr);
     void                        load_rl_history(bool can_clean=true);
+    bool                        has_deferred_lines() const { return m_lazy_offset != 0; }
+    int                         load_deferred_lines();
     void                        clear();
     void                        compact(bool force=false, bool uniq=false, int limit=-1);
     bool                        add(const char* line);
@@ -126,6 +129,7 @@ public:
     line_id                     find(const char* line) const;
     template <int S> iter       read_lines(char (&buffer)[S]);
     iter                        read_lines(char* buffer, unsigned int buffer_size);
+    iter                        read_tail(char* buffer, unsigned int buffer_size, unsigned int tail_count, unsigned int* skipped=nullptr);
 
     void                        enable_diagnostic_output() { m_diagnostic = true; }
     bool                        has_bank(unsigned char bank) const;
@@ -137,7 +141,8 @@ private:
     friend                      class read_line_iter;
     bool                        is_valid() const;
     void                        get_file_path(str_base& out, bool session) const;
-    void                        load_internal();
+    void                        load_internal(unsigned int master_offset=0);
+    unsigned int                find_lazy_window(unsigned int count, bool& needs_maintenance);
     void                        reap();
     template <typename T> void  for_each_bank(T&& callback);
     template <typename T> void  for_each_bank(T&& callback) const;
@@ -156,6 +161,9 @@ private:
     std::vector<line_id>        m_index_map;
     size_t                      m_master_len;
     size_t                      m_master_deleted_count;
+    unsigned int                m_lazy_offset = 0;      // Master offset where loaded lines begin, or 0.
+    concurrency_tag             m_lazy_ctag;
+    bool                        m_lazy_full = false;    // Load everything for the rest of the session.
 
     size_t                      m_min_compact_threshold = 200;
 
@@ -176,4 +184,9 @@ public:
     history_database(const char* path, int id, bool use_master_bank);
 };
 
+//------------------------------------------------------------------------------
+// Loads history lines deferred by the history.lazy_load setting (implemented
+// in rl_module.cpp, since Readline's history list must be updated as well).
+void load_deferred_history();
+
 #define DIAG(fmt, ...)          do { if (m_diagnostic) fprintf(stderr, fmt, ##__VA_ARGS__); } while (false)
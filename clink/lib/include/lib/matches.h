@@ -88,6 +88,21 @@ inline bool is_zero(match_type type)
 
 
 
+//------------------------------------------------------------------------------
+// Optional file system metadata captured while enumerating matches, so that
+// resolving match types, displaying, coloring, and Lua handlers can use it
+// without touching the file system again.
+struct match_file_info
+{
+    unsigned int            attr;           // FILE_ATTRIBUTE_* flags.
+    bool                    symlink;        // Is a symlink.
+    bool                    orphaned;       // Is a symlink whose target does not exist.
+    unsigned long long      size;           // File size, in bytes.
+    long long               mtime;          // Modified time, compatible with os.time().
+};
+
+
+
 //------------------------------------------------------------------------------
 class shadow_bool
 {
@@ -132,6 +147,7 @@ public:
     match_type              get_match_type() const;
     const char*             get_match_display() const;
     const char*             get_match_description() const;
+    const match_file_info*  get_match_file_info() const;
     char                    get_match_append_char() const;
     shadow_bool             get_match_suppress_append() const;
     bool                    get_match_append_display() const;
@@ -180,6 +196,7 @@ public:
     virtual const char*     get_match_display(unsigned int index) const = 0;
     virtual const char*     get_match_description(unsigned int index) const = 0;
     virtual unsigned int    get_match_ordinal(unsigned int index) const = 0;
+    virtual const match_file_info* get_match_file_info(unsigned int index) const = 0;
     virtual char            get_match_append_char(unsigned int index) const = 0;
     virtual shadow_bool     get_match_suppress_append(unsigned int index) const = 0;
     virtual bool            get_match_append_display(unsigned int index) const = 0;
@@ -198,6 +215,7 @@ private:
     virtual match_type      get_unfiltered_match_type(unsigned int index) const { return match_type::none; }
     virtual const char*     get_unfiltered_match_display(unsigned int index) const { return nullptr; }
     virtual const char*     get_unfiltered_match_description(unsigned int index) const { return nullptr; }
+    virtual const match_file_info* get_unfiltered_match_file_info(unsigned int index) const { return nullptr; }
     virtual char            get_unfiltered_match_append_char(unsigned int index) const { return 0; }
     virtual shadow_bool     get_unfiltered_match_suppress_append(unsigned int index) const { return shadow_bool(false); }
     virtual bool            get_unfiltered_match_append_display(unsigned int index) const { return false; }
@@ -207,6 +225,7 @@ private:
 
 //------------------------------------------------------------------------------
 match_type to_match_type(DWORD attr, const char* path, bool symlink=false);
+match_type to_match_type(const match_file_info& info);
 match_type to_match_type(const char* type_name);
 void match_type_to_string(match_type type, str_base& out);
 bool compare_matches(const char* l, match_type l_type, const char* r, match_type r_type);
@@ -219,6 +238,7 @@ struct match_desc
     const char*             match;          // Match text.
     const char*             display;        // Display string.
     const char*             description;    // Description string.
+    const match_file_info*  file_info;      // File system metadata; nullptr means not available.
     match_type              type;           // Match type.
     char                    append_char;    // Append char after match; 0 means not specified.
     char                    suppress_append;// Suppress appending character after match; negative means not specified.
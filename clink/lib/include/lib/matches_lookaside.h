@@ -10,6 +10,7 @@ struct match_extra
 {
     unsigned short  display_offset;
     unsigned short  description_offset;
+    unsigned short  file_info_offset;   // Zero means no file info.
     match_type      type;
     char            append_char;
     unsigned char   flags;
@@ -27,6 +28,7 @@ public:
     const char*             get_description() const { return m_match ? m_match + m_extra->description_offset : nullptr; }
     char                    get_append_char() const { return m_extra->append_char; }
     unsigned char           get_flags() const { return m_extra->flags; }
+    bool                    get_file_info(match_file_info& out) const;
 private:
     const char*             m_match;
     const match_extra*      m_extra;
@@ -37,19 +39,22 @@ private:
 // Each match in 'matches' must conform to the PACKED MATCH FORMAT (except the
 // lcd entry in [0], which is omitted from the lookaside table).
 match_details lookup_match(const char* match);
+match_details lookup_match_at(char** matches, unsigned int index); // Faster.
 int create_matches_lookaside(char** matches);
 int destroy_matches_lookaside(char** matches);
 void set_matches_lookaside_oneoff(const char* match, match_type type, char append_char, unsigned char flags);
 void clear_matches_lookaside_oneoff();
 
+bool get_packed_match_file_info(const char* packed, match_file_info& out);
 const char* append_string_into_buffer(char*& buffer, const char* match, bool allow_tabs=false);
-size_t calc_packed_size(const char* match, const char* display, const char* description);
+size_t calc_packed_size(const char* match, const char* display, const char* description, const match_file_info* file_info=nullptr);
 bool pack_match(char* buffer, size_t packed_size,
                 const char* match, match_type type,
                 const char* display, const char* description,
                 char append_char, unsigned char flags,
                 match_display_filter_entry* entry,
-                bool strip_markup, bool lcd=false);
+                bool strip_markup, bool lcd=false,
+                const match_file_info* file_info=nullptr);
 
 extern "C" int lookup_match_type(const char* match);
 extern "C" void override_match_append(const char* match);
@@ -43,6 +43,58 @@ struct column_info
 /* Array with information about column filledness.  */
 static struct column_info *s_column_info = nullptr;
 
+//------------------------------------------------------------------------------
+// The column_info triangle costs O(matches * columns^2), so larger lists and
+// wider screens use fit_columns_ranges() instead.
+static const size_t c_max_triangle_cols = 50;
+static const size_t c_max_triangle_matches = 1000;
+
+//------------------------------------------------------------------------------
+// Sparse table that answers "widest match in [begin, end)" in constant time.
+// Levels are built on demand, so only ranges as long as the longest one that
+// is queried cost memory.
+class range_max
+{
+public:
+                    range_max(const std::vector<width_t>& values) : m_values(values) {}
+    width_t         query(size_t begin, size_t end);
+
+private:
+    const std::vector<width_t>& m_values;
+    std::vector<std::vector<width_t>> m_levels; // [k][i] = max of [i, i + 2^(k+1)).
+};
+
+//------------------------------------------------------------------------------
+width_t range_max::query(size_t begin, size_t end)
+{
+    assert(begin < end);
+    assert(end <= m_values.size());
+
+    const size_t len = end - begin;
+    if (len == 1)
+        return m_values[begin];
+
+    unsigned int k = 0;
+    while ((size_t(2) << (k + 1)) <= len)
+        ++k;
+
+    while (m_levels.size() <= k)
+    {
+        const size_t span = size_t(2) << m_levels.size();
+        const std::vector<width_t>& prev = m_levels.empty() ? m_values : m_levels.back();
+
+        std::vector<width_t> level;
+        level.resize(m_values.size() - span + 1);
+        for (size_t i = 0; i < level.size(); ++i)
+            level[i] = max<width_t>(prev[i], prev[i + span / 2]);
+        m_levels.emplace_back(std::move(level));
+    }
+
+    const size_t span = size_t(2) << k;
+    const std::vector<width_t>& level = m_levels[k];
+    return max<width_t>(level[begin], level[end - span]);
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -80,22 +132,16 @@ int printable_len(const char* match, match_type type)
 /* Allocate enough column info suitable for the current number of
    files and display columns, and initialize the info to represent the
    narrowest possible columns.  */
-static bool init_column_info(int max_matches, size_t& max_cols, size_t count, width_t col_padding)
+static bool init_column_info(size_t& max_cols, width_t col_padding)
 {
     size_t i;
 
     /* Currently allocated columns in column_info.  */
     static size_t column_info_alloc;
 
-    // Constrain number of matches.
-    if (max_matches < 0)
-        return false;
-    if (max_matches && count > max_matches)
-        return false;
-
     // Constrain memory usage and computation time.
-    if (max_cols > 50)
-        max_cols = 50;
+    if (max_cols > c_max_triangle_cols)
+        max_cols = c_max_triangle_cols;
 
     if (column_info_alloc < max_cols)
     {
@@ -167,7 +213,11 @@ column_widths calculate_columns(match_adapter* adapter, int max_matches, bool on
     const size_t count = adapter->get_match_count();
     size_t max_cols = count < max_idx ? count : max_idx;
 
-    const bool fixed_cols = !init_column_info(max_matches, max_cols, count, col_padding) || one_column;
+    // Constrain number of matches.
+    const bool fixed_cols = (one_column || max_matches < 0 || (max_matches && count > max_matches));
+    std::vector<width_t> lens;
+    if (!fixed_cols)
+        lens.reserve(count);
 
     // Find the length of the prefix common to all items: length as displayed
     // characters (common_length) and as a byte index into the matches (sind).
@@ -217,35 +267,32 @@ column_widths calculate_columns(match_adapter* adapter, int max_matches, bool on
         size_t len = extra;
 
         int cdelta = condense_delta;
-        match_type type = adapter->get_match_type(i);
-        const char *match = adapter->get_match(i);
-        bool append = adapter->is_append_display(i);
-        if (adapter->use_display(i, type, append))
+        const match_render_info& info = adapter->get_render_info(i);
+        if (info.use_display)
         {
-            if (append)
+            if (info.append)
             {
-                len += printable_len(match, type);
-                len += adapter->get_match_visible_display(i);
+                len += info.printable_cells;
+                len += info.display_cells;
             }
             else if (presuf)
             {
-                len += adapter->get_match_visible_display(i);
+                len += info.display_cells;
             }
             else
             {
-                len += adapter->get_match_visible_display(i);
+                len += info.display_cells;
                 cdelta = 0;
             }
         }
         else
         {
-            len += printable_len(match, type);
+            len += info.printable_cells;
         }
 
         if (cdelta)
         {
-            const char *visible = __printable_part(const_cast<char*>(match));
-            if (strlen(visible) > sind)
+            if (info.visible_len > sind)
             {
                 assert(len >= cdelta);
                 len -= cdelta;
@@ -257,7 +304,7 @@ column_widths calculate_columns(match_adapter* adapter, int max_matches, bool on
 
         if (has_descriptions)
         {
-            const unsigned int desc_cells = adapter->get_match_visible_description(i);
+            const unsigned int desc_cells = info.desc_cells;
             if (desc_cells)
             {
                 len += desc_padding + desc_cells;
@@ -272,8 +319,57 @@ column_widths calculate_columns(match_adapter* adapter, int max_matches, bool on
         if (max_len < len)
             max_len = len;
 
-        if (fixed_cols)
-            continue;
+        if (!fixed_cols)
+            lens.push_back(width_t(len));
+    }
+
+    std::vector<width_t> fitted;
+    size_t cols = 0;
+    if (!fixed_cols)
+    {
+        if (count > c_max_triangle_matches || max_cols > c_max_triangle_cols)
+            cols = fit_columns_ranges(lens, max_cols, col_padding, line_length, vertical, fitted);
+        else
+            cols = fit_columns_triangle(lens, max_cols, col_padding, line_length, vertical, fitted);
+    }
+
+    widths.m_col_padding = col_padding;
+    widths.m_desc_padding = desc_padding;
+    widths.m_sind = sind;
+    widths.m_max_len = max_len;
+    widths.m_max_match = max_match;
+    widths.m_max_desc = max_desc;
+    widths.m_can_condense = can_condense;
+
+    if (fixed_cols || cols <= 0)
+    {
+        const size_t col_max = max_len + col_padding;
+        const size_t limit = one_column ? 1 : max<size_t>((line_length + col_padding - 1) / col_max, 1);
+        for (size_t i = 0; i < limit; ++i)
+            widths.m_widths.push_back(col_max);
+    }
+    else
+    {
+        widths.m_widths = std::move(fitted);
+    }
+
+    widths.m_right_justify = widths.num_columns() > 1 || widths.m_max_match > (line_length * 4) / 10;
+
+    return widths;
+}
+
+//------------------------------------------------------------------------------
+size_t fit_columns_triangle(const std::vector<width_t>& lens, size_t max_cols, width_t col_padding, size_t line_length, bool vertical, std::vector<width_t>& out)
+{
+    out.clear();
+
+    const size_t count = lens.size();
+    if (!init_column_info(max_cols, col_padding))
+        return 0;
+
+    for (size_t filesno = 0; filesno < count; ++filesno)
+    {
+        const width_t len = lens[filesno];
 
         size_t max_valid = -1;
         for (size_t i = 0; i < max_cols; ++i)
@@ -301,37 +397,93 @@ column_widths calculate_columns(match_adapter* adapter, int max_matches, bool on
             max_cols = max_valid + 1;
     }
 
-    widths.m_col_padding = col_padding;
-    widths.m_desc_padding = desc_padding;
-    widths.m_sind = sind;
-    widths.m_max_len = max_len;
-    widths.m_max_match = max_match;
-    widths.m_max_desc = max_desc;
-    widths.m_can_condense = can_condense;
+    if (max_cols <= 0)
+        return 0;
 
-    if (fixed_cols || max_cols <= 0)
+    /* Find maximum allowed columns.  */
+    size_t cols;
+    for (cols = max_cols; 1 < cols; --cols)
     {
-        const size_t col_max = max_len + col_padding;
-        const size_t limit = one_column ? 1 : max<size_t>((line_length + col_padding - 1) / col_max, 1);
-        for (size_t i = 0; i < limit; ++i)
-            widths.m_widths.push_back(col_max);
+        if (s_column_info[cols - 1].valid_len)
+            break;
     }
-    else
+
+    size_t remove_padding = cols - 1;
+    for (size_t i = 0; i < cols; ++i, --remove_padding)
+        out.push_back(s_column_info[cols - 1].col_arr[i] - (remove_padding ? col_padding : 0));
+
+    return cols;
+}
+
+//------------------------------------------------------------------------------
+// Tests whether COLS columns fit, with the same rules as the column_info
+// triangle:  each column is at least 1 + COL_PADDING wide, and a layout only
+// stops fitting when a column grows while the line is too long.
+static bool fit_candidate(const std::vector<width_t>& lens, range_max& widest, size_t cols, width_t col_padding, size_t line_length, bool vertical, std::vector<width_t>& widths)
+{
+    const size_t count = lens.size();
+
+    widths.assign(cols, 1 + col_padding);
+    size_t line_len = cols * (1 + col_padding);
+
+    auto grow = [&] (size_t idx, width_t len) {
+        const width_t real_length = len + (idx + 1 == cols ? 0 : col_padding);
+        if (widths[idx] < real_length)
+        {
+            line_len += real_length - widths[idx];
+            widths[idx] = real_length;
+            if (line_len >= line_length)
+                return false;
+        }
+        return true;
+    };
+
+    if (vertical)
     {
-        /* Find maximum allowed columns.  */
-        size_t cols;
-        for (cols = max_cols; 1 < cols; --cols)
+        // Each column is a contiguous range of matches.
+        const size_t rows = (count + cols - 1) / cols;
+        for (size_t idx = 0; idx < cols; ++idx)
         {
-            if (s_column_info[cols - 1].valid_len)
+            const size_t begin = idx * rows;
+            if (begin >= count)
                 break;
+            if (!grow(idx, widest.query(begin, min<size_t>(begin + rows, count))))
+                return false;
+        }
+    }
+    else
+    {
+        // Usually gives up within the first row or two.
+        for (size_t filesno = 0; filesno < count; ++filesno)
+        {
+            if (!grow(filesno % cols, lens[filesno]))
+                return false;
         }
-
-        size_t remove_padding = cols - 1;
-        for (size_t i = 0; i < cols; ++i, --remove_padding)
-            widths.m_widths.push_back(s_column_info[cols - 1].col_arr[i] - (remove_padding ? col_padding : 0));
     }
 
-    widths.m_right_justify = widths.num_columns() > 1 || widths.m_max_match > (line_length * 4) / 10;
+    return true;
+}
 
-    return widths;
+//------------------------------------------------------------------------------
+size_t fit_columns_ranges(const std::vector<width_t>& lens, size_t max_cols, width_t col_padding, size_t line_length, bool vertical, std::vector<width_t>& out)
+{
+    out.clear();
+
+    // Whether a layout fits isn't monotonic in the number of columns, so
+    // bisecting could miss the answer the triangle finds.  Instead try from
+    // the most columns down; with range queries each try is cheap.
+    range_max widest(lens);
+    std::vector<width_t> widths;
+    for (size_t cols = max_cols; cols > 0; --cols)
+    {
+        if (fit_candidate(lens, widest, cols, col_padding, line_length, vertical, widths))
+        {
+            size_t remove_padding = cols - 1;
+            for (size_t i = 0; i < cols; ++i, --remove_padding)
+                out.push_back(widths[i] - (remove_padding ? col_padding : 0));
+            return cols;
+        }
+    }
+
+    return 0;
 }
@@ -43,3 +43,12 @@ column_widths calculate_columns(
     bool omit_desc=false,
     width_t extra=0,
     int presuf=0);
+
+//------------------------------------------------------------------------------
+// Find the most columns (up to MAX_COLS) that fit LENS in LINE_LENGTH cells,
+// and the widths of the columns.  Returns 0 if nothing fits.  The triangle
+// version is the coreutils ls algorithm and is limited to 50 columns; the
+// ranges version gives the same answer using range max queries, and is used
+// for long lists and wide screens.
+size_t fit_columns_triangle(const std::vector<width_t>& lens, size_t max_cols, width_t col_padding, size_t line_length, bool vertical, std::vector<width_t>& out);
+size_t fit_columns_ranges(const std::vector<width_t>& lens, size_t max_cols, width_t col_padding, size_t line_length, bool vertical, std::vector<width_t>& out);
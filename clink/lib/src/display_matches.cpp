@@ -188,6 +188,15 @@ const char* get_tmpbuf_rollback (void)
     return tmpbuf_allocated + tmpbuf_rollback_length;
 }
 
+//------------------------------------------------------------------------------
+const char* get_tmpbuf (int* len)
+{
+    grow_tmpbuf(1);
+    *tmpbuf_ptr = '\0';
+    *len = tmpbuf_length;
+    return tmpbuf_allocated;
+}
+
 //------------------------------------------------------------------------------
 void flush_tmpbuf(void)
 {
@@ -1104,20 +1113,20 @@ static int display_match_list_internal(match_adapter* adapter, const column_widt
                                  cols - 1 :
                                  widths.column_width(j));
 
-            const match_type type = adapter->get_match_type(l);
+            const match_render_info& info = adapter->get_render_info(l);
+            const match_type type = info.type;
             const char* const match = adapter->get_match(l);
             const char* const display = adapter->get_match_display(l);
-            const bool append = adapter->is_append_display(l);
 
-            if (adapter->use_display(l, type, append))
+            if (info.use_display)
             {
                 printed_len = 0;
-                if (append)
+                if (info.append)
                 {
-                    char* temp = __printable_part((char*)match);
+                    char* temp = const_cast<char*>(match) + info.visible_offset;
                     printed_len = append_filename(temp, match, widths.m_sind, widths.m_can_condense, type, 0, nullptr);
                     append_display(display, 0, _rl_arginfo_color);
-                    printed_len += adapter->get_match_visible_display(l);
+                    printed_len += info.display_cells;
                 }
                 else if (presuf)
                 {
@@ -1126,7 +1135,7 @@ static int display_match_list_internal(match_adapter* adapter, const column_widt
                 else
                 {
                     append_display(display, 0, _rl_filtered_color);
-                    printed_len += adapter->get_match_visible_display(l);
+                    printed_len += info.display_cells;
                 }
             }
             else
@@ -1147,7 +1156,7 @@ static int display_match_list_internal(match_adapter* adapter, const column_widt
                     const int parens = 0;
 #endif
                     const int pad_to = (right_justify ?
-                        max<int>(printed_len + widths.m_desc_padding, col_max - (adapter->get_match_visible_description(l) + parens)) :
+                        max<int>(printed_len + widths.m_desc_padding, col_max - (info.desc_cells + parens)) :
                         widths.m_max_match + 4);
                     if (pad_to < cols - 1)
                     {
@@ -1288,16 +1297,13 @@ extern "C" void display_matches(char** matches)
         presuf = bit_prefix|bit_suffix;
         for (int l = adapter->get_match_count(); presuf && l--;)
         {
-            if (adapter->is_append_display(l))
-                continue;
-
-            const match_type type = adapter->get_match_type(l);
-            if (!adapter->use_display(l, type, false))
+            const match_render_info& info = adapter->get_render_info(l);
+            if (info.append || !info.use_display)
                 continue;
 
             const char* const match = adapter->get_match(l);
             const char* const display = adapter->get_match_display(l);
-            const char* const visible = __printable_part(const_cast<char*>(match));
+            const char* const visible = match + info.visible_offset;
             const int bits = calc_prefix_or_suffix(visible, display);
             presuf &= bits;
         }
@@ -18,9 +18,12 @@
 #include <core/base.h>
 #include <core/os.h>
 #include <core/log.h>
+#include <core/perf_stats.h>
 #include <core/settings.h>
 #include <core/debugheap.h>
 #include <terminal/ecma48_iter.h>
+#include <terminal/printer.h>
+#include <terminal/terminal_helpers.h>
 
 #include <memory>
 
@@ -138,9 +141,10 @@ struct display_line
     void                append(char c, char face);
     void                appendspace();
     void                appendnul();
+    void                copy_from(const display_line& d);
 
     char*               m_chars = nullptr;  // Characters in line.
-    char*               m_faces = nullptr;  // Faces for characters in line.
+    char*               m_faces = nullptr;  // Faces for characters in line (shares the allocation with m_chars).
     unsigned int        m_len = 0;          // Bytes used in m_chars and m_faces.
     unsigned int        m_allocated = 0;    // Bytes allocated in m_chars and m_faces.
 
@@ -156,13 +160,13 @@ struct display_line
 
 private:
     void                appendinternal(char c, char face);
+    void                reserve(unsigned int len);
 };
 
 //------------------------------------------------------------------------------
 display_line::~display_line()
 {
     free(m_chars);
-    free(m_faces);
 }
 
 //------------------------------------------------------------------------------
@@ -197,29 +201,44 @@ void display_line::clear()
 }
 
 //------------------------------------------------------------------------------
-void display_line::appendinternal(char c, char face)
+void display_line::reserve(unsigned int len)
 {
-    if (m_len >= m_allocated)
-    {
+    if (len <= m_allocated)
+        return;
+
 #ifdef DEBUG
-        const unsigned int min_alloc = 40;
+    const unsigned int min_alloc = 40;
 #else
-        const unsigned int min_alloc = 160;
+    const unsigned int min_alloc = 160;
 #endif
 
-        const unsigned int alloc = max<unsigned int>(min_alloc, m_allocated * 3 / 2);
-        char* chars = static_cast<char*>(realloc(m_chars, alloc));
-        char* faces = static_cast<char*>(realloc(m_faces, alloc));
-        if (!chars || !faces)
-        {
-            free(chars);
-            free(faces);
-            return;
-        }
+    // The chars and faces share one allocation, with the faces in the second
+    // half, so growing a line costs one allocation instead of two.
+    const unsigned int alloc = max<unsigned int>(len, max<unsigned int>(min_alloc, m_allocated * 3 / 2));
+    char* chars = static_cast<char*>(malloc(alloc * 2));
+    if (!chars)
+        return;
 
-        m_chars = chars;
-        m_faces = faces;
-        m_allocated = alloc;
+    if (m_len)
+    {
+        memcpy(chars, m_chars, m_len);
+        memcpy(chars + alloc, m_faces, m_len);
+    }
+
+    free(m_chars);
+    m_chars = chars;
+    m_faces = chars + alloc;
+    m_allocated = alloc;
+}
+
+//------------------------------------------------------------------------------
+void display_line::appendinternal(char c, char face)
+{
+    if (m_len >= m_allocated)
+    {
+        reserve(m_len + 1);
+        if (m_len >= m_allocated)
+            return;
     }
 
     m_chars[m_len] = c;
@@ -248,6 +267,31 @@ void display_line::appendnul()
     --m_len;
 }
 
+//------------------------------------------------------------------------------
+void display_line::copy_from(const display_line& d)
+{
+    m_len = 0;
+    if (d.m_chars)
+    {
+        // Include the nul terminator added by appendnul().
+        reserve(d.m_len + 1);
+        if (m_allocated <= d.m_len)
+            return;
+        memcpy(m_chars, d.m_chars, d.m_len + 1);
+        memcpy(m_faces, d.m_faces, d.m_len + 1);
+    }
+
+    m_len = d.m_len;
+    m_start = d.m_start;
+    m_end = d.m_end;
+    m_x = d.m_x;
+    m_lastcol = d.m_lastcol;
+    m_lead = d.m_lead;
+    m_trail = d.m_trail;
+    m_newline = d.m_newline;
+    m_scroll_mark = d.m_scroll_mark;
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -257,7 +301,7 @@ public:
                         display_lines() = default;
                         ~display_lines() = default;
 
-    void                parse(unsigned int prompt_botlin, unsigned int col, const char* buffer, unsigned int len);
+    void                parse(unsigned int prompt_botlin, unsigned int col, const char* buffer, unsigned int len, const display_lines& ref);
     void                horz_parse(unsigned int prompt_botlin, unsigned int col, const char* buffer, unsigned int point, unsigned int len, const display_lines& ref);
     void                apply_scroll_markers(unsigned int top, unsigned int bottom);
     void                set_top(unsigned int top);
@@ -280,6 +324,7 @@ public:
 private:
     display_line*       next_line(unsigned int start);
     bool                adjust_columns(unsigned int& point, int delta, const char* buffer, unsigned int len) const;
+    unsigned int        reusable_lines(unsigned int col, unsigned int len, const display_lines& ref) const;
 
     std::vector<display_line> m_lines;
     unsigned int        m_width = 0;
@@ -291,25 +336,20 @@ private:
     unsigned int        m_horz_start = 0;
     bool                m_horz_scroll = false;
     str_moveable        m_comment_row;
+    std::vector<char>   m_text;             // Buffer text that parse() used.
+    std::vector<char>   m_text_faces;       // Face for each byte in m_text.
 };
 
 //------------------------------------------------------------------------------
-void display_lines::parse(unsigned int prompt_botlin, unsigned int col, const char* buffer, unsigned int len)
+void display_lines::parse(unsigned int prompt_botlin, unsigned int col, const char* buffer, unsigned int len, const display_lines& ref)
 {
     assert(col < _rl_screenwidth);
+    assert(&ref != this);
     dbg_ignore_scope(snapshot, "display_readline");
 
     clear();
     m_width = _rl_screenwidth;
 
-    m_prompt_botlin = prompt_botlin;
-    while (prompt_botlin--)
-        next_line(0);
-
-    display_line* d = next_line(0);
-    d->m_x = col;
-    m_cpos = col;
-
     int hl_begin = -1;
     int hl_end = -1;
 
@@ -322,12 +362,47 @@ void display_lines::parse(unsigned int prompt_botlin, unsigned int col, const ch
         }
     }
 
-    str<16> tmp;
+    // Remember the text and faces, so the next parse can tell which lines are
+    // unaffected by changes.
+    m_text.assign(buffer, buffer + len);
+    m_text_faces.resize(len);
+    for (unsigned int i = 0; i < len; ++i)
+        m_text_faces[i] = rl_get_face_func(i, hl_begin, hl_end);
+    const char* const faces = m_text_faces.data();
+
+    m_prompt_botlin = prompt_botlin;
+    const unsigned int reuse = reusable_lines(col, len, ref);
+
+    while (prompt_botlin--)
+        next_line(0);
+
+    // Lines before the first change are copied instead of parsed.
+    display_line* d;
     unsigned int index = 0;
+    if (reuse)
+    {
+        for (unsigned int i = m_prompt_botlin; i < m_prompt_botlin + reuse; ++i)
+        {
+            const display_line& o = ref.m_lines[i];
+            next_line(o.m_start)->copy_from(o);
+        }
+
+        index = ref.m_lines[m_prompt_botlin + reuse].m_start;
+        d = next_line(index);
+        col = 0;
+    }
+    else
+    {
+        d = next_line(0);
+        d->m_x = col;
+    }
+    m_cpos = col;
 
-    const char* chars = buffer;
+    str<16> tmp;
+
+    const char* chars = buffer + index;
     const char* end = nullptr;
-    str_iter iter(chars, len);
+    str_iter iter(chars, len - index);
     for (; true; chars = end)
     {
         const int c = iter.next();
@@ -401,14 +476,14 @@ void display_lines::parse(unsigned int prompt_botlin, unsigned int col, const ch
             }
 
             for (; chars < end; ++chars, ++index)
-                d->append(*chars, rl_get_face_func(index, hl_begin, hl_end));
+                d->append(*chars, faces[index]);
             col += wc_width;
             continue;
         }
 
         bool wrapped = false;
         const char* add = tmp.c_str();
-        const char face = rl_get_face_func(static_cast<unsigned int>(chars - buffer), hl_begin, hl_end);
+        const char face = faces[chars - buffer];
 
         if (index == rl_point)
         {
@@ -476,6 +551,44 @@ void display_lines::parse(unsigned int prompt_botlin, unsigned int col, const ch
     }
 }
 
+//------------------------------------------------------------------------------
+// Returns how many input lines from ref can be reused as-is.  A line can be
+// reused when neither the text nor the faces changed up to and including the
+// character that starts the following line, since that character decides
+// where the line wraps.
+unsigned int display_lines::reusable_lines(unsigned int col, unsigned int len, const display_lines& ref) const
+{
+    if (ref.m_horz_scroll ||
+        ref.m_width != m_width ||
+        ref.m_prompt_botlin != m_prompt_botlin ||
+        ref.m_count <= m_prompt_botlin ||
+        ref.m_lines[m_prompt_botlin].m_x != col)
+        return 0;
+
+    // Find the first byte whose text or face changed.
+    const unsigned int n = min<unsigned int>(len, static_cast<unsigned int>(ref.m_text.size()));
+    unsigned int same = 0;
+    while (same < n && m_text[same] == ref.m_text[same] && m_text_faces[same] == ref.m_text_faces[same])
+        ++same;
+
+    // The cursor position is only found while parsing, so reuse stops at the
+    // line that contains the cursor; lines before it can be reused.  Lines
+    // with scroll markers were modified after parsing.  And a line can't be
+    // resumed in the middle of a ^X that wrapped.
+    unsigned int reuse = 0;
+    for (unsigned int i = m_prompt_botlin; i + 1 < ref.m_count; ++i)
+    {
+        const display_line& next = ref.m_lines[i + 1];
+        if (next.m_start >= same ||
+            int(next.m_start) > rl_point ||
+            next.m_lead ||
+            ref.m_lines[i].m_scroll_mark)
+            break;
+        ++reuse;
+    }
+    return reuse;
+}
+
 //------------------------------------------------------------------------------
 void display_lines::horz_parse(unsigned int prompt_botlin, unsigned int col, const char* buffer, unsigned int point, unsigned int len, const display_lines& ref)
 {
@@ -741,6 +854,8 @@ void display_lines::swap(display_lines& d)
     std::swap(m_horz_start, d.m_horz_start);
     std::swap(m_horz_scroll, d.m_horz_scroll);
     std::swap(m_comment_row, d.m_comment_row);
+    m_text.swap(d.m_text);
+    m_text_faces.swap(d.m_text_faces);
 }
 
 //------------------------------------------------------------------------------
@@ -757,6 +872,8 @@ void display_lines::clear()
     m_horz_start = 0;
     m_horz_scroll = false;
     m_comment_row.clear();
+    m_text.clear();
+    m_text_faces.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -1041,6 +1158,10 @@ display_accumulator::display_accumulator()
     rl_fwrite_function = fwrite_proc;
     rl_fflush_function = fflush_proc;
     ++s_nested;
+
+    m_printer = g_printer;
+    if (m_printer)
+        m_printer->begin_frame();
 }
 
 //------------------------------------------------------------------------------
@@ -1055,6 +1176,9 @@ display_accumulator::~display_accumulator()
         assert(!m_active);
     }
     --s_nested;
+
+    if (m_printer)
+        m_printer->end_frame();
 }
 
 //------------------------------------------------------------------------------
@@ -1274,6 +1398,9 @@ void display_manager::display()
     if (!_rl_echoing_p)
         return;
 
+    TRACE_SCOPE("display", "display");
+    PERF_STAGE(display);
+
     // NOTE:  This implementation doesn't use _rl_quick_redisplay.  I'm not
     // clear on what practical benefit it would provide, or why it would be
     // worth adding that complexity.
@@ -1402,7 +1529,7 @@ void display_manager::display()
         if (m_horz_scroll)
             m_next.horz_parse(m_last_prompt_line_botlin, m_last_prompt_line_width, rl_line_buffer, rl_point, rl_end, m_curr);
         else
-            m_next.parse(m_last_prompt_line_botlin, m_last_prompt_line_width, rl_line_buffer, rl_end);
+            m_next.parse(m_last_prompt_line_botlin, m_last_prompt_line_width, rl_line_buffer, rl_end, m_curr);
         assert(m_next.count() > 0);
     }
 #define m_next __use_next_instead__
@@ -2195,6 +2322,7 @@ void resize_readline_display(const char* prompt, const line_buffer& buffer, cons
     // between the OS async terminal resize and cursor movement while refreshing
     // the Readline display.  The result is near-perfect resize behavior; but
     // perfection is beyond reach, due to the inherent async execution.
+    flush_printer_frame();
 #ifndef LOG_OUTPUT_CALLSTACKS
     display_accumulator coalesce;
 #endif
@@ -47,6 +47,28 @@ static setting_int g_max_history(
     10000);
 };
 
+static setting_bool g_history_index(
+    "history.index",
+    "Maintain a binary index of the history file",
+    "When enabled, Clink maintains a binary index file next to the master history\n"
+    "file.  The index records the offset, length, timestamp, and deleted state of\n"
+    "each history line, which lets 'clink history <n>' seek directly to the last\n"
+    "n lines instead of reading the whole history file.  The history file itself\n"
+    "remains plain text.",
+    false);
+
+static setting_int g_lazy_load(
+    "history.lazy_load",
+    "Number of recent history lines to load up front",
+    "When greater than 0, Clink loads only this many of the most recent lines\n"
+    "from the master history file at the beginning of a session, by scanning\n"
+    "backward from the end of the file.  Older lines are loaded when a history\n"
+    "command, history expansion, or a Lua script needs to reach past them.\n"
+    "Pruning and compacting the history file only happen when the file appears\n"
+    "to have outgrown the history.max_lines limit.  When 0, all history lines\n"
+    "are loaded at each prompt.",
+    0);
+
 static setting_bool g_ignore_space(
     "history.ignore_space",
     "Skip adding lines prefixed with whitespace",
@@ -216,6 +238,11 @@ bank_handles::operator bool () const
 //------------------------------------------------------------------------------
 void bank_handles::close()
 {
+    if (m_handle_index)
+    {
+        CloseHandle(m_handle_index);
+        m_handle_index = nullptr;
+    }
     if (m_handle_removals)
     {
         CloseHandle(m_handle_removals);
@@ -245,12 +272,14 @@ protected:
     bank_lock&      operator = (bank_lock&& other);
     void*           m_handle_lines = nullptr;       // From bank_master or bank_session.
     void*           m_handle_removals = nullptr;    // Always from bank_session, or nullptr.
+    void*           m_handle_index = nullptr;       // Always from bank_master, or nullptr.
 };
 
 //------------------------------------------------------------------------------
 bank_lock::bank_lock(const bank_handles& handles, bool exclusive)
 : m_handle_lines(handles.m_handle_lines)
 , m_handle_removals(handles.m_handle_removals)
+, m_handle_index(handles.m_handle_index)
 {
     if (m_handle_lines == nullptr)
         return;
@@ -291,8 +320,10 @@ bank_lock& bank_lock::operator = (bank_lock&& other)
 {
     m_handle_lines = other.m_handle_lines;
     m_handle_removals = other.m_handle_removals;
+    m_handle_index = other.m_handle_index;
     other.m_handle_lines = nullptr;
     other.m_handle_removals = nullptr;
+    other.m_handle_index = nullptr;
     return *this;
 }
 
@@ -306,6 +337,8 @@ bank_lock::operator bool () const
 
 //------------------------------------------------------------------------------
 class write_lock;
+struct bank_index_header;
+struct bank_index_record;
 
 //------------------------------------------------------------------------------
 class read_lock
@@ -347,12 +380,16 @@ public:
         line_id_impl        next(str_iter& out, str_base* timestamp=nullptr);
         void                set_file_offset(unsigned int offset);
         unsigned int        get_deleted_count() const { return m_deleted; }
+        unsigned int        get_entry_offset() const { return m_entry_offset; }
 
     private:
         bool                provision();
         file_iter           m_file_iter;
         unsigned int        m_remaining = 0;
         unsigned int        m_deleted = 0;
+        unsigned int        m_entry_offset = 0;
+        unsigned int        m_time_offset = 0;
+        bool                m_has_time = false;
         bool                m_first_line = true;
         bool                m_eating_ctag = false;
         std::unordered_set<unsigned int> m_removals;
@@ -363,7 +400,9 @@ public:
     line_id_impl            find(const char* line) const;
     template <class T> void find(const char* line, T&& callback) const;
     int                     apply_removals(write_lock& lock) const;
-    int                     collect_removals(write_lock& lock, std::vector<line_id_impl>& removals) const;
+    int                     collect_removals(const read_lock& lock, std::vector<line_id_impl>& removals) const;
+    unsigned int            find_tail_offset(unsigned int count, unsigned int* before=nullptr) const;
+    bool                    read_index(bank_index_header& header, std::vector<bank_index_record>& records) const;
 
 private:
     template <typename T> int for_each_removal(const read_lock& target, T&& callback) const;
@@ -376,10 +415,15 @@ class write_lock
 public:
                     write_lock() = default;
     explicit        write_lock(const bank_handles& handles);
+                    ~write_lock();
     void            clear();
     line_id_impl    add(const char* line);
     bool            remove(line_id_impl id);
     void            append(const read_lock& src);
+    bool            sync_index();
+
+private:
+    bool            m_index_dirty = false;
 };
 
 //------------------------------------------------------------------------------
@@ -440,7 +484,7 @@ int read_lock::apply_removals(write_lock& lock) const
 }
 
 //------------------------------------------------------------------------------
-int read_lock::collect_removals(write_lock& lock, std::vector<line_id_impl>& removals) const
+int read_lock::collect_removals(const read_lock& lock, std::vector<line_id_impl>& removals) const
 {
     return for_each_removal(lock, [&] (unsigned int offset)
     {
@@ -595,8 +639,9 @@ void read_lock::file_iter::set_file_offset(unsigned int offset)
     m_remaining = GetFileSize(m_handle, nullptr);
     offset = clamp(offset, (unsigned int)0, m_remaining);
     m_remaining -= offset;
-    // BUGBUG: Should this be `offset - m_buffer_offset`?
-    m_buffer_offset = static_cast<unsigned __int64>(0) - m_buffer_size;
+    // next() advances m_buffer_offset by m_buffer_size before reading, so the
+    // first buffer read reports offsets relative to the start of the file.
+    m_buffer_offset = static_cast<unsigned __int64>(offset) - m_buffer_size;
     SetFilePointer(m_handle, offset, nullptr, FILE_BEGIN);
     m_buffer[0] = '\0';
 }
@@ -709,6 +754,8 @@ line_id_impl read_lock::line_iter::next(str_iter& out, str_base* timestamp)
         {
             if (strncmp(start, "|\ttime=", 7) == 0)
             {
+                m_time_offset = offset;
+                m_has_time = true;
                 if (timestamp)
                 {
                     start += 7;
@@ -727,11 +774,14 @@ line_id_impl read_lock::line_iter::next(str_iter& out, str_base* timestamp)
         {
             if (!eating_ctag)
                 ++m_deleted;
+            m_has_time = false;
             continue;
         }
 
         new (&out) str_iter(start, int(end - start));
 
+        m_entry_offset = m_has_time ? m_time_offset : offset;
+        m_has_time = false;
         return line_id_impl(offset);
     }
 
@@ -742,7 +792,380 @@ line_id_impl read_lock::line_iter::next(str_iter& out, str_base* timestamp)
 void read_lock::line_iter::set_file_offset(unsigned int offset)
 {
     m_file_iter.set_file_offset(offset);
+    m_remaining = 0;
+    m_first_line = (offset == 0);
     m_eating_ctag = false;
+    m_has_time = false;
+}
+
+
+
+//------------------------------------------------------------------------------
+// Scans backward from the end of the bank to find where the last `count`
+// active lines begin.  Returns the offset of the first of those lines (or of
+// its timestamp), or 0 if the bank has no more than `count` active lines.
+// When `before` is given, the scan continues to the start of the bank to count
+// the active lines ahead of the window; a `count` of 0 then counts them all.
+unsigned int read_lock::find_tail_offset(unsigned int count, unsigned int* before) const
+{
+    unsigned int dummy;
+    unsigned int& ahead = before ? *before : dummy;
+    ahead = 0;
+
+    if (!count && !before)
+        return 0;
+
+    std::unordered_set<unsigned int> removals;
+    for_each_removal(*this, [&] (unsigned int offset)
+    {
+        removals.insert(offset);
+    });
+
+    history_read_buffer buffer;
+    char* data = buffer.data();
+
+    unsigned int found = 0;
+    unsigned int end = GetFileSize(m_handle_lines, nullptr);
+    unsigned int window = count ? 0 : end;
+    bool check_time = false;
+    while (end)
+    {
+        const unsigned int start = (end > buffer.size()) ? end - buffer.size() : 0;
+        const unsigned int len = end - start;
+
+        DWORD read = 0;
+        SetFilePointer(m_handle_lines, start, nullptr, FILE_BEGIN);
+        if (!ReadFile(m_handle_lines, data, len, &read, nullptr) || read != len)
+            return ahead = 0;
+
+        // Unless the block starts at the beginning of the file, its first
+        // line may be partial; the next block reads it again.
+        unsigned int first = 0;
+        if (start)
+        {
+            while (first < len && !is_line_breaker(data[first]))
+                ++first;
+            if (first == len)
+                return ahead = 0;
+        }
+
+        unsigned int line_end = len;
+        while (line_end > first)
+        {
+            unsigned int line_start = line_end;
+            while (line_start > first && !is_line_breaker(data[line_start - 1]))
+                --line_start;
+
+            if (line_start < line_end)
+            {
+                const char* line = data + line_start;
+                const unsigned int offset = start + line_start;
+                if (*line != '|')
+                {
+                    if (removals.find(offset) == removals.end())
+                    {
+                        // Stop at the first active line older than the window,
+                        // unless counting them.
+                        if (window)
+                        {
+                            if (!before)
+                                return window;
+                            ++ahead;
+                        }
+                        else if (++found == count)
+                        {
+                            window = offset;
+                            check_time = true;
+                            line_end = line_start ? line_start - 1 : 0;
+                            continue;
+                        }
+                    }
+                }
+                else if (check_time && line_end - line_start >= 7 && strncmp(line, "|\ttime=", 7) == 0)
+                {
+                    // The window's first line carries its timestamp with it.
+                    window = offset;
+                }
+                check_time = false;
+            }
+
+            line_end = line_start ? line_start - 1 : 0;
+        }
+
+        end = start + first;
+    }
+
+    return ahead ? window : 0;
+}
+
+
+
+//------------------------------------------------------------------------------
+// The master bank can optionally have a binary index file next to it.  The
+// bank itself stays plain text, so older versions and the removals files keep
+// working unchanged.  The index has a fixed size record for each active line,
+// in offset order, and is only ever appended to except for setting tombstone
+// bits.  Each sync records the bank's ctag, size, and last write time.  Older
+// versions, or instances with the index disabled, can append lines or write
+// tombstones in place without updating the index, which changes the bank's
+// write time; when anything doesn't match, readers ignore the index and the
+// next write lock rebuilds it.  All access happens while the master bank is
+// locked, so the index needs no lock of its own.
+static const char c_index_magic[8] = { 'C', 'L', 'K', 'H', 'I', 'D', 'X', '2' };
+static const unsigned int c_index_tombstone = 0x01;
+
+struct bank_index_header
+{
+    char                magic[8];
+    unsigned int        record_size;
+    unsigned int        count;          // Number of records.
+    unsigned int        covered;        // Bytes of the bank described by the records.
+    unsigned int        synced;         // Size of the bank when last synced.
+    FILETIME            stamp;          // Last write time of the bank when last synced.
+    char                ctag[max_ctag_size];
+};
+
+struct bank_index_record
+{
+    unsigned int        entry;          // Offset of the timestamp line, if any, else same as offset.
+    unsigned int        offset;         // Offset of the line; same as line_id_impl.offset.
+    unsigned int        length;
+    unsigned int        time;
+    unsigned int        flags;
+};
+
+//------------------------------------------------------------------------------
+static bool read_at(void* handle, unsigned int offset, void* data, unsigned int size)
+{
+    DWORD read;
+    if (SetFilePointer(handle, offset, nullptr, FILE_BEGIN) == INVALID_SET_FILE_POINTER)
+        return false;
+    return ReadFile(handle, data, size, &read, nullptr) && read == size;
+}
+
+//------------------------------------------------------------------------------
+static bool write_at(void* handle, unsigned int offset, const void* data, unsigned int size)
+{
+    DWORD written;
+    if (SetFilePointer(handle, offset, nullptr, FILE_BEGIN) == INVALID_SET_FILE_POINTER)
+        return false;
+    return WriteFile(handle, data, size, &written, nullptr) && written == size;
+}
+
+//------------------------------------------------------------------------------
+static bool get_bank_stamp(void* handle, concurrency_tag& ctag, unsigned int& size, FILETIME& stamp)
+{
+    char tmp[max_ctag_size];
+    read_lock::file_iter iter(handle, tmp);
+    if (!extract_ctag(iter, tmp, sizeof(tmp), ctag))
+        return false;
+
+    size = GetFileSize(handle, nullptr);
+    return size != INVALID_FILE_SIZE && GetFileTime(handle, nullptr, nullptr, &stamp);
+}
+
+//------------------------------------------------------------------------------
+class bank_index
+{
+public:
+                    bank_index(void* handle_index, void* handle_lines);
+    bool            check();
+    bool            sync();
+    void            clear();
+    void            mark_deleted(unsigned int offset);
+    bool            read(bank_index_header& header, std::vector<bank_index_record>& records) const;
+
+private:
+    bool            read_header(bank_index_header& header) const;
+    bool            is_current(const bank_index_header& header) const;
+    void*           m_handle_index;
+    void*           m_handle_lines;
+};
+
+//------------------------------------------------------------------------------
+bank_index::bank_index(void* handle_index, void* handle_lines)
+: m_handle_index(handle_index)
+, m_handle_lines(handle_lines)
+{
+}
+
+//------------------------------------------------------------------------------
+bool bank_index::read_header(bank_index_header& header) const
+{
+    if (!read_at(m_handle_index, 0, &header, sizeof(header)))
+        return false;
+    return (memcmp(header.magic, c_index_magic, sizeof(header.magic)) == 0 &&
+            header.record_size == sizeof(bank_index_record));
+}
+
+//------------------------------------------------------------------------------
+bool bank_index::is_current(const bank_index_header& header) const
+{
+    concurrency_tag ctag;
+    unsigned int size;
+    FILETIME stamp;
+    if (!get_bank_stamp(m_handle_lines, ctag, size, stamp))
+        return false;
+
+    return (strcmp(header.ctag, ctag.get()) == 0 &&
+            header.synced == size &&
+            CompareFileTime(&header.stamp, &stamp) == 0);
+}
+
+//------------------------------------------------------------------------------
+// Discards the index if something else has written to the bank since the
+// index was last synced, so that the next sync rebuilds it.
+bool bank_index::check()
+{
+    if (!m_handle_index || !m_handle_lines)
+        return false;
+
+    bank_index_header header;
+    if (read_header(header) && is_current(header))
+        return true;
+
+    clear();
+    return false;
+}
+
+//------------------------------------------------------------------------------
+bool bank_index::sync()
+{
+    if (!m_handle_index || !m_handle_lines)
+        return false;
+
+    concurrency_tag ctag;
+    unsigned int size;
+    FILETIME stamp;
+    if (!get_bank_stamp(m_handle_lines, ctag, size, stamp))
+        return false;
+
+    // Rebuild the index if it doesn't match the bank.
+    bank_index_header header;
+    if (!read_header(header) || strcmp(header.ctag, ctag.get()) != 0 || header.covered > size)
+    {
+        memset(&header, 0, sizeof(header));
+        memcpy(header.magic, c_index_magic, sizeof(header.magic));
+        header.record_size = sizeof(bank_index_record);
+        memcpy(header.ctag, ctag.get(), min<unsigned int>(ctag.size(), sizeof(header.ctag)));
+        header.ctag[sizeof(header.ctag) - 1] = '\0';
+        if (!write_at(m_handle_index, 0, &header, sizeof(header)))
+            return false;
+        SetEndOfFile(m_handle_index);
+    }
+
+    // Index lines appended since the last sync.  Lines that are already marked
+    // deleted are simply not indexed.
+    std::vector<bank_index_record> records;
+    if (header.covered < size)
+    {
+        history_read_buffer buffer;
+        read_lock::line_iter iter(m_handle_lines, buffer.data(), buffer.size());
+        iter.set_file_offset(header.covered);
+
+        str_iter out;
+        str<32> time;
+        while (const line_id_impl id = iter.next(out, &time))
+        {
+            if (id.offset >= c_max_line_id.offset)
+                break;
+
+            bank_index_record record;
+            record.entry = iter.get_entry_offset();
+            record.offset = id.offset;
+            record.length = out.length();
+            record.time = time.empty() ? 0 : unsigned(atoi(time.c_str()));
+            record.flags = 0;
+            records.push_back(record);
+
+            // A trailing timestamp line without its line is left uncovered,
+            // so the next sync picks it up together with its line.
+            header.covered = id.offset + out.length() + 1;
+        }
+    }
+
+    if (!records.empty())
+    {
+        const unsigned int pos = sizeof(header) + header.count * sizeof(bank_index_record);
+        if (!write_at(m_handle_index, pos, records.data(), unsigned(records.size() * sizeof(bank_index_record))))
+            return false;
+        header.count += unsigned(records.size());
+    }
+
+    if (header.synced == size && CompareFileTime(&header.stamp, &stamp) == 0 && records.empty())
+        return true;
+
+    header.synced = size;
+    header.stamp = stamp;
+    return write_at(m_handle_index, 0, &header, sizeof(header));
+}
+
+//------------------------------------------------------------------------------
+void bank_index::clear()
+{
+    if (!m_handle_index)
+        return;
+
+    SetFilePointer(m_handle_index, 0, nullptr, FILE_BEGIN);
+    SetEndOfFile(m_handle_index);
+}
+
+//------------------------------------------------------------------------------
+void bank_index::mark_deleted(unsigned int offset)
+{
+    bank_index_header header;
+    if (!sync() || !read_header(header))
+        return;
+
+    // Records are in offset order.
+    unsigned int lo = 0;
+    unsigned int hi = header.count;
+    while (lo < hi)
+    {
+        const unsigned int mid = (lo + hi) / 2;
+        const unsigned int pos = sizeof(header) + mid * sizeof(bank_index_record);
+
+        bank_index_record record;
+        if (!read_at(m_handle_index, pos, &record, sizeof(record)))
+            return;
+
+        if (record.offset < offset)
+            lo = mid + 1;
+        else if (record.offset > offset)
+            hi = mid;
+        else
+        {
+            record.flags |= c_index_tombstone;
+            write_at(m_handle_index, pos, &record, sizeof(record));
+            return;
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Fails if the index doesn't match the bank.
+bool bank_index::read(bank_index_header& header, std::vector<bank_index_record>& records) const
+{
+    records.clear();
+    if (!m_handle_index || !read_header(header) || !is_current(header))
+        return false;
+
+    records.resize(header.count);
+    if (!header.count)
+        return true;
+
+    return read_at(m_handle_index, sizeof(header), records.data(), header.count * sizeof(bank_index_record));
+}
+
+
+
+//------------------------------------------------------------------------------
+bool read_lock::read_index(bank_index_header& header, std::vector<bank_index_record>& records) const
+{
+    if (!m_handle_index)
+        return false;
+
+    return bank_index(m_handle_index, m_handle_lines).read(header, records);
 }
 
 
@@ -751,6 +1174,27 @@ void read_lock::line_iter::set_file_offset(unsigned int offset)
 write_lock::write_lock(const bank_handles& handles)
 : read_lock(handles, true)
 {
+    if (m_handle_lines && m_handle_index && !bank_index(m_handle_index, m_handle_lines).check())
+        m_index_dirty = true;
+}
+
+//------------------------------------------------------------------------------
+write_lock::~write_lock()
+{
+    // Batch index updates until the end of the lock scope, so that rewriting
+    // the whole bank doesn't update the index once per line.
+    if (m_index_dirty)
+        sync_index();
+}
+
+//------------------------------------------------------------------------------
+bool write_lock::sync_index()
+{
+    if (!m_handle_index)
+        return false;
+
+    m_index_dirty = false;
+    return bank_index(m_handle_index, m_handle_lines).sync();
 }
 
 //------------------------------------------------------------------------------
@@ -763,6 +1207,11 @@ void write_lock::clear()
         SetFilePointer(m_handle_removals, 0, nullptr, FILE_BEGIN);
         SetEndOfFile(m_handle_removals);
     }
+    if (m_handle_index)
+    {
+        bank_index(m_handle_index, m_handle_lines).clear();
+        m_index_dirty = true;
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -774,6 +1223,8 @@ line_id_impl write_lock::add(const char* line)
         return line_id_impl();
     WriteFile(m_handle_lines, line, int(strlen(line)), &written, nullptr);
     WriteFile(m_handle_lines, "\n", 1, &written, nullptr);
+    if (m_handle_index)
+        m_index_dirty = true;
     if (offset >= c_max_line_id.offset)
         return c_max_line_id;
     return line_id_impl(offset);
@@ -800,9 +1251,17 @@ bool write_lock::remove(line_id_impl id)
     }
     else
     {
+        if (m_handle_index)
+            bank_index(m_handle_index, m_handle_lines).mark_deleted(id.offset);
+
         DWORD written;
         SetFilePointer(m_handle_lines, id.offset, nullptr, FILE_BEGIN);
         WriteFile(m_handle_lines, "|", 1, &written, nullptr);
+
+        // Writing the tombstone changes the bank's write time, so the index
+        // needs to be stamped again.
+        if (m_handle_index)
+            m_index_dirty = true;
     }
 
     return true;
@@ -819,6 +1278,9 @@ void write_lock::append(const read_lock& src)
     read_lock::file_iter src_iter(src, buffer.data(), buffer.size());
     while (int bytes_read = src_iter.next())
         WriteFile(m_handle_lines, buffer.data(), bytes_read, &written, nullptr);
+
+    if (m_handle_index)
+        m_index_dirty = true;
 }
 
 
@@ -830,6 +1292,7 @@ public:
                             read_line_iter(const history_db& db, unsigned int this_size);
     history_db::line_id     next(str_iter& out, str_base* timestamp=nullptr);
     unsigned int            get_bank() const { return m_bank_index; }
+    void                    seek_master(unsigned int offset);
 
 private:
     bool                    next_bank();
@@ -868,6 +1331,13 @@ bool read_line_iter::next_bank()
     return false;
 }
 
+//------------------------------------------------------------------------------
+void read_line_iter::seek_master(unsigned int offset)
+{
+    if (m_bank_index == bank_master)
+        m_line_iter.set_file_offset(offset);
+}
+
 //------------------------------------------------------------------------------
 history_db::line_id read_line_iter::next(str_iter& out, str_base* timestamp)
 {
@@ -1263,6 +1733,23 @@ void history_db::initialise(str_base* error_message)
         }
         LOG("master bank ctag: %s", m_master_ctag.get());
 
+        // Open the optional binary index of the master bank, and bring it up
+        // to date.  Remove a stale index when it's disabled, so it can't get
+        // out of sync while nothing maintains it.
+        str<280> index_path;
+        index_path << path << ".idx";
+        if (g_history_index.get())
+        {
+            DIAG("... index file '%s'\n", index_path.c_str());
+            m_bank_handles[bank_master].m_handle_index = open_file(index_path.c_str());
+            write_lock lock(get_bank(bank_master));
+            lock.sync_index();
+        }
+        else if (os::get_path_type(index_path.c_str()) == os::path_type_file)
+        {
+            os::unlink(index_path.c_str());
+        }
+
         // If history is shared, there is only the master bank.
         if (g_shared.get())
             return;
@@ -1316,6 +1803,7 @@ bank_handles history_db::get_bank(unsigned int index) const
     if (index < sizeof_array(m_bank_handles) && is_valid())
     {
         handles.m_handle_lines = m_bank_handles[index].m_handle_lines;
+        handles.m_handle_index = m_bank_handles[index].m_handle_index;
         if (index == bank_master)
             handles.m_handle_removals = m_bank_handles[bank_session].m_handle_removals;
     }
@@ -1386,7 +1874,7 @@ void history_db::get_file_path(str_base& out, bool session) const
 }
 
 //------------------------------------------------------------------------------
-void history_db::load_internal()
+void history_db::load_internal(unsigned int master_offset)
 {
     clear_history();
     m_index_map.clear();
@@ -1412,6 +1900,15 @@ void history_db::load_internal()
         // prior to calling add_history.
         read_lock::line_iter iter(lock, buffer.data(), buffer.size() - 1);
 
+        // The lazy loading window is only meaningful while the ctag matches.
+        if (bank_index == bank_master && master_offset)
+        {
+            if (strcmp(m_master_ctag.get(), m_lazy_ctag.get()) == 0)
+                iter.set_file_offset(master_offset);
+            else
+                master_offset = 0;
+        }
+
         dbg_snapshot_heap(snapshot);
 
         str_iter out;
@@ -1448,15 +1945,72 @@ void history_db::load_internal()
         return true;
     });
 
+    m_lazy_offset = master_offset;
+
     DIAG("... total lines active %zu\n", m_index_map.size());
 }
 
+//------------------------------------------------------------------------------
+unsigned int history_db::find_lazy_window(unsigned int count, bool& needs_maintenance)
+{
+    needs_maintenance = false;
+
+    read_lock lock(get_bank(bank_master));
+    if (!lock)
+        return 0;
+
+    concurrency_tag ctag;
+    extract_ctag(lock, ctag);
+
+    // Keep the same window for the rest of the session so that history
+    // positions stay meaningful from one prompt to the next, unless the master
+    // bank has been compacted in the meantime.
+    if (m_lazy_offset && strcmp(ctag.get(), m_lazy_ctag.get()) == 0)
+        return m_lazy_offset;
+
+    const unsigned int window = lock.find_tail_offset(count);
+    if (!window)
+        return 0;
+
+    m_lazy_ctag.clear();
+    m_lazy_ctag.set(ctag.get());
+
+    // Pruning and compacting need to see the whole bank.  Estimate the size of
+    // the bank at the limits from the average size of the lines in the window,
+    // and only ask for maintenance when the bank has likely outgrown that.
+    const size_t limit = get_max_history();
+    const size_t threshold = max(limit, m_min_compact_threshold);
+    const unsigned int size = GetFileSize(get_bank(bank_master).m_handle_lines, nullptr);
+    const double per_line = double(size - window) / count;
+    needs_maintenance = (double(size) > per_line * double(limit + threshold));
+
+    DIAG("... lazy window at offset %u of %u%s\n", window, size, needs_maintenance ? ", needs maintenance" : "");
+    return window;
+}
+
 //------------------------------------------------------------------------------
 void history_db::load_rl_history(bool can_clean)
 {
     if (!is_valid())
         return;
 
+    const int lazy = g_lazy_load.get();
+    if (lazy > 0 && m_use_master_bank && !m_lazy_full)
+    {
+        bool needs_maintenance;
+        const unsigned int window = find_lazy_window(lazy, needs_maintenance);
+        if (window && !(can_clean && needs_maintenance))
+        {
+            load_internal(window);
+            if (m_lazy_offset)
+                return;
+        }
+
+        // Once everything has been loaded, keep loading everything so that
+        // history positions stay meaningful for the rest of the session.
+        m_lazy_full = true;
+    }
+
     load_internal();
 
     // The `clink history` command needs to be able to avoid cleaning the master
@@ -1468,6 +2022,95 @@ void history_db::load_rl_history(bool can_clean)
     }
 }
 
+//------------------------------------------------------------------------------
+// Loads the master lines that precede the lazy loading window, and inserts them
+// ahead of the lines already in Readline's history.  The existing entries are
+// kept as-is, so edits in progress and undo lists survive.  Returns the number
+// of lines inserted.
+int history_db::load_deferred_lines()
+{
+    if (!m_lazy_offset)
+        return 0;
+
+    const unsigned int window = m_lazy_offset;
+    m_lazy_offset = 0;
+    m_lazy_full = true;
+
+    std::vector<HIST_ENTRY*> entries;
+    std::vector<line_id> ids;
+    {
+        read_lock lock(get_bank(bank_master));
+        if (!lock)
+            return 0;
+
+        concurrency_tag ctag;
+        extract_ctag(lock, ctag);
+        if (strcmp(ctag.get(), m_master_ctag.get()) != 0)
+        {
+            LOG("can't load deferred history; ctag '%s' doesn't match '%s'", ctag.get(), m_master_ctag.get());
+            return 0;
+        }
+
+        history_read_buffer buffer;
+        read_lock::line_iter iter(lock, buffer.data(), buffer.size() - 1);
+
+        dbg_snapshot_heap(snapshot);
+
+        str_iter out;
+        str<32> time;
+        line_id_impl id;
+        while (id = iter.next(out, &time))
+        {
+            if (id.offset >= window)
+                break;
+
+            char* line = buffer.data() + (out.get_pointer() - buffer.data());
+            line[out.length()] = '\0';
+
+            char* ts = nullptr;
+            if (!time.empty())
+            {
+                ts = (char*)malloc(time.length() + 1);
+                memcpy(ts, time.c_str(), time.length() + 1);
+            }
+
+            entries.push_back(alloc_history_entry(line, ts));
+            id.bank_index = bank_master;
+            ids.push_back(id.outer);
+        }
+
+        dbg_ignore_since_snapshot(snapshot, "History");
+    }
+
+    if (entries.empty())
+        return 0;
+
+    DIAG("... loaded %zu deferred lines\n", entries.size());
+
+    const int count = int(entries.size());
+    HISTORY_STATE* state = history_get_history_state();
+    HIST_ENTRY** list = (HIST_ENTRY**)malloc(sizeof(*list) * (count + state->length + 1));
+    memcpy(list, entries.data(), sizeof(*list) * count);
+    if (state->length)
+        memcpy(list + count, state->entries, sizeof(*list) * state->length);
+    list[count + state->length] = nullptr;
+    free(state->entries);
+
+    // history_set_history_state() resets history_prev_use_curr.
+    const int prev_use_curr = history_prev_use_curr;
+    state->entries = list;
+    state->offset += count;
+    state->length += count;
+    state->size = state->length + 1;
+    history_set_history_state(state);
+    history_prev_use_curr = prev_use_curr;
+    free(state);
+
+    m_index_map.insert(m_index_map.begin(), ids.begin(), ids.end());
+    m_master_len += count;
+    return count;
+}
+
 //------------------------------------------------------------------------------
 void history_db::clear()
 {
@@ -1493,6 +2136,7 @@ void history_db::clear()
     m_index_map.clear();
     m_master_len = 0;
     m_master_deleted_count = 0;
+    m_lazy_offset = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -1781,7 +2425,11 @@ bool history_db::remove_internal(line_id id, bool guard_ctag)
             ++m_master_deleted_count;
         }
         else
-            assert(m_index_map.empty()); // Index map is empty when using `clink history delete`.
+        {
+            // Index map is empty when using `clink history delete`, and lines
+            // before the lazy loading window aren't in the index map.
+            assert(m_index_map.empty() || id_impl.offset < m_lazy_offset);
+        }
     }
     else
     {
@@ -1858,6 +2506,9 @@ history_db::line_id history_db::find(const char* line) const
 //------------------------------------------------------------------------------
 history_db::expand_result history_db::expand(const char* line, str_base& out)
 {
+    // History expansion can refer to any line, so load deferred lines first.
+    load_deferred_history();
+
     using_history();
 
     char* expanded = nullptr;
@@ -1879,6 +2530,128 @@ history_db::iter history_db::read_lines(char* buffer, unsigned int size)
     return ret;
 }
 
+//------------------------------------------------------------------------------
+history_db::iter history_db::read_tail(char* buffer, unsigned int size, unsigned int tail_count, unsigned int* _skipped)
+{
+    unsigned int dummy;
+    unsigned int& skipped = _skipped ? *_skipped : dummy;
+    skipped = 0;
+
+    unsigned int seek = 0;
+    unsigned int skip = 0;
+    bool indexed = false;
+
+    // The session bank only holds the current session's lines, so counting
+    // them is cheap compared to reading the master bank.
+    auto count_session_lines = [this] ()
+    {
+        unsigned int count = 0;
+        read_lock lock(get_bank(bank_session));
+        if (lock)
+        {
+            str_iter line;
+            history_read_buffer tmp;
+            read_lock::line_iter iter(lock, tmp.data(), tmp.size());
+            while (iter.next(line))
+                ++count;
+        }
+        return count;
+    };
+
+    if (tail_count != UINT_MAX && m_bank_handles[bank_master].m_handle_index)
+    {
+        // The index gives the offset of each master line without reading the
+        // master bank.  Deferred removals still have to be honored, but the
+        // removals file is small.  An index that's out of date is left for the
+        // next writer to rebuild, and the master bank is scanned instead.
+        bank_index_header header;
+        std::vector<bank_index_record> records;
+        std::unordered_set<unsigned int> removed;
+        {
+            read_lock lock(get_bank(bank_master));
+            if (lock && lock.read_index(header, records))
+            {
+                std::vector<line_id_impl> removals;
+                lock.collect_removals(lock, removals);
+                for (const auto& id : removals)
+                    removed.insert(id.offset);
+                indexed = true;
+            }
+        }
+
+        if (indexed)
+        {
+            const unsigned int session_count = count_session_lines();
+
+            std::vector<unsigned int> entries;
+            entries.reserve(records.size());
+            for (const auto& record : records)
+            {
+                if (!(record.flags & c_index_tombstone) && removed.find(record.offset) == removed.end())
+                    entries.push_back(record.entry);
+            }
+
+            const unsigned int master_count = unsigned(entries.size());
+            const unsigned int total = master_count + session_count;
+            if (tail_count < total)
+            {
+                skipped = total - tail_count;
+                if (skipped < master_count)
+                {
+                    seek = entries[skipped];
+                }
+                else
+                {
+                    seek = header.covered;
+                    skip = skipped - master_count;
+                }
+            }
+
+            DIAG("... index:  %u master lines, %u session lines, seek to offset %u\n", master_count, session_count, seek);
+        }
+    }
+
+    if (!indexed && tail_count != UINT_MAX)
+    {
+        // Without an index, scan backward from the end of the master bank to
+        // find where the tail begins.  Only the caller's line numbering needs
+        // the lines ahead of the tail to be counted, and the same backward
+        // scan counts them.
+        const unsigned int session_count = count_session_lines();
+        read_lock lock(get_bank(bank_master));
+        if (!lock)
+        {
+            if (session_count > tail_count)
+                skip = skipped = session_count - tail_count;
+        }
+        else if (tail_count > session_count)
+        {
+            seek = lock.find_tail_offset(tail_count - session_count, _skipped);
+        }
+        else
+        {
+            unsigned int master_count = 0;
+            if (_skipped)
+                lock.find_tail_offset(0, &master_count);
+            seek = GetFileSize(get_bank(bank_master).m_handle_lines, nullptr);
+            skip = session_count - tail_count;
+            skipped = skip + master_count;
+        }
+
+        DIAG("... tail:  %u session lines, seek to offset %u\n", session_count, seek);
+    }
+
+    iter ret = read_lines(buffer, size);
+    if (seek && ret.impl)
+        ((read_line_iter*)ret.impl)->seek_master(seek);
+
+    str_iter line;
+    for (; skip; --skip)
+        ret.next(line);
+
+    return ret;
+}
+
 //------------------------------------------------------------------------------
 bool history_db::has_bank(unsigned char bank) const
 {
@@ -15,11 +15,14 @@
 #include "display_readline.h"
 
 #include <core/base.h>
+#include <core/log.h>
+#include <core/perf_stats.h>
 #include <core/os.h>
 #include <core/path.h>
 #include <core/str_iter.h>
 #include <core/str_tokeniser.h>
 #include <core/settings.h>
+#include <terminal/printer.h>
 #include <terminal/terminal_in.h>
 #include <terminal/terminal_out.h>
 #include <terminal/input_idle.h>
@@ -608,6 +611,23 @@ bool line_editor_impl::update()
     if (!check_flag(flag_editing))
         return false;
 
+    // While pasted text is arriving, defer everything that depends on the
+    // whole line until the burst ends.
+    if (m_burst)
+        return true;
+
+    // An input that ends a burst is classified in update_input().  This catches
+    // a burst that ended without dispatching anything, such as when it was
+    // followed by the start of a chord, or by no key at all.
+    if (m_burst_deferred)
+    {
+        m_burst_deferred = false;
+        if (g_classify_words.get())
+            classify();
+        m_buffer.set_need_draw();
+        m_buffer.draw();
+    }
+
     update_internal();
     return true;
 }
@@ -662,6 +682,9 @@ bool line_editor_impl::notify_matches_ready(int generation_id, matches* matches)
 //------------------------------------------------------------------------------
 void line_editor_impl::update_matches()
 {
+    TRACE_SCOPE("generate", "update_matches");
+    PERF_STAGE(update_matches);
+
     if (m_matches.is_volatile())
         reset_generate_matches();
 
@@ -803,6 +826,12 @@ void line_editor_impl::set_keyseq_len(int len)
 // to help dispatch() be able to dispatch an entire chord.
 bool line_editor_impl::update_input()
 {
+    PERF_STAGE(keystroke);
+
+    bool burst = false;
+    if (!m_dispatching)
+        m_burst = false;
+
     if (clink_is_signaled())
     {
         const int sig = clink_is_signaled();
@@ -819,6 +848,10 @@ bool line_editor_impl::update_input()
 
     if (!m_module.is_input_pending())
     {
+        // A nested dispatch reads input while the outer frame is still open,
+        // so show what has been drawn so far before waiting for input.
+        m_printer.flush_frame();
+
         int key = m_desc.input->read();
 
         if (key == terminal_in::input_terminal_resize)
@@ -854,6 +887,10 @@ bool line_editor_impl::update_input()
         if (key < 0)
             return true;
 
+        // Plain text followed by more plain text is a burst, e.g. pasting.
+        if (!m_dispatching && key >= 0x20 && key != 0x7f)
+            burst = m_desc.input->in_burst();
+
         // `quoted-insert` should always behave as though the key resolved a
         // binding, to ensure that Readline gets to handle the key (even Esc).
         if (!m_bind_resolver.step(key) &&
@@ -882,6 +919,13 @@ bool line_editor_impl::update_input()
         unsigned char   flags;  // = 0;   <! issues about C2905
     };
 
+    if (!m_dispatching)
+        m_module.set_defer_display(burst);
+
+    // Everything drawn in response to the input (the input line, popup lists,
+    // etc) is written to the terminal at once when the frame ends.
+    printer_frame frame(m_printer);
+
     while (auto binding = m_bind_resolver.next())
     {
         // Binding found, dispatch it off to the module.
@@ -902,7 +946,11 @@ bool line_editor_impl::update_input()
             module->on_input(input, result, context);
 
             if (clink_is_signaled())
+            {
+                if (!m_dispatching)
+                    m_module.set_defer_display(false);
                 return true;
+            }
         }
 
         m_bind_resolver.set_group(result.group);
@@ -933,9 +981,20 @@ bool line_editor_impl::update_input()
         }
         else
         {
-            // Classify words in the input line (if configured).
-            if (g_classify_words.get())
-                classify();
+            if (!burst)
+            {
+                // Classify words in the input line (if configured).
+                if (g_classify_words.get())
+                    classify();
+
+                // That also covers a burst that this input ends, so update()
+                // doesn't need to classify and redraw again.
+                if (m_burst_deferred)
+                {
+                    m_burst_deferred = false;
+                    m_buffer.set_need_draw();
+                }
+            }
 
             if (result.flags & result_impl::flag_done)
             {
@@ -946,13 +1005,27 @@ bool line_editor_impl::update_input()
             }
 
             if (!check_flag(flag_editing))
+            {
+                m_module.set_defer_display(false);
                 return true;
+            }
         }
 
         if (result.flags & result_impl::flag_redraw)
             m_buffer.redraw();
     }
 
+    if (!m_dispatching)
+    {
+        m_module.set_defer_display(false);
+        if (burst)
+        {
+            m_burst = true;
+            m_burst_deferred = true;
+            return true;
+        }
+    }
+
     m_buffer.draw();
     return true;
 }
@@ -960,6 +1033,8 @@ bool line_editor_impl::update_input()
 //------------------------------------------------------------------------------
 void line_editor_impl::collect_words()
 {
+    PERF_STAGE(collect_words);
+
     m_command_offset = collect_words(m_words, &m_matches, collect_words_mode::stop_at_cursor, m_commands);
 }
 
@@ -1092,6 +1167,9 @@ void line_editor_impl::classify()
     if (!m_classifier)
         return;
 
+    TRACE_SCOPE("classify", "classify");
+    PERF_STAGE(classify);
+
     rollback<int> rb_end(rl_end);
     if (g_suggestion_offset >= 0)
         rl_end = g_suggestion_offset;
@@ -1372,6 +1450,8 @@ matches* get_mutable_matches(bool nosort=false)
 //------------------------------------------------------------------------------
 void line_editor_impl::update_internal()
 {
+    PERF_STAGE(update_internal);
+
     // This is responsible for updating the matches for the word under the
     // cursor.  It tries to call match generators only once for the current
     // word, and then repeatedly filter the results as the word is edited.
@@ -1463,6 +1543,8 @@ void line_editor_impl::update_internal()
 //------------------------------------------------------------------------------
 void line_editor_impl::try_suggest()
 {
+    PERF_STAGE(try_suggest);
+
     const line_states& lines = m_commands.get_linestates(m_buffer);
     line_state line = lines.back();
     if (host_can_suggest(line))
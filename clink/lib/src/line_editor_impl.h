@@ -178,6 +178,10 @@ private:
 
     const char*         m_insert_on_begin = nullptr;
 
+    // State for bursts of input (e.g. pasting).
+    bool                m_burst = false;            // The last key was part of a burst.
+    bool                m_burst_deferred = false;   // Updates were deferred and are still owed.
+
     // State for dispatch().
     unsigned char       m_dispatching = 0;
     bool                m_invalid_dispatch;
@@ -106,6 +106,7 @@ void match_adapter::set_filtered_matches(match_display_filter_entry** filtered_m
 void match_adapter::init_has_descriptions()
 {
     m_cached.clear();
+    m_render_info.clear();
 }
 
 //------------------------------------------------------------------------------
@@ -211,7 +212,7 @@ const char* match_adapter::get_match_display_internal(unsigned int index) const
     if (m_filtered_matches)
         return m_filtered_matches[index + 1]->display;
     if (m_alt_matches)
-        return lookup_match(m_alt_matches[index + 1]).get_display();
+        return lookup_match_at(m_alt_matches, index + 1).get_display();
     else if (m_matches)
         return m_matches->get_match_display(index);
     return nullptr;
@@ -251,7 +252,7 @@ unsigned int match_adapter::get_match_visible_display(unsigned int index) const
 
     const char* display;
     if (m_alt_matches)
-        display = lookup_match(m_alt_matches[index + 1]).get_display();
+        display = lookup_match_at(m_alt_matches, index + 1).get_display();
     else if (m_matches)
         display = m_matches->get_match_display(index);
     else
@@ -272,7 +273,7 @@ const char* match_adapter::get_match_description(unsigned int index) const
 
     const char *description;
     if (m_alt_matches)
-        description = lookup_match(m_alt_matches[index + 1]).get_description();
+        description = lookup_match_at(m_alt_matches, index + 1).get_description();
     else if (m_matches)
         description = m_matches->get_match_description(index);
     else
@@ -290,13 +291,32 @@ unsigned int match_adapter::get_match_visible_description(unsigned int index) co
     return description ? cell_count(description) : 0;
 }
 
+//------------------------------------------------------------------------------
+bool match_adapter::get_match_file_info(unsigned int index, match_file_info& out) const
+{
+    if (m_filtered_matches)
+        return get_packed_match_file_info(m_filtered_matches[index + 1]->buffer, out);
+    if (m_alt_matches)
+        return lookup_match_at(m_alt_matches, index + 1).get_file_info(out);
+    if (m_matches)
+    {
+        const match_file_info* info = m_matches->get_match_file_info(index);
+        if (info)
+        {
+            out = *info;
+            return true;
+        }
+    }
+    return false;
+}
+
 //------------------------------------------------------------------------------
 match_type match_adapter::get_match_type(unsigned int index) const
 {
     if (m_filtered_matches)
         return static_cast<match_type>(m_filtered_matches[index + 1]->type);
     if (m_alt_matches)
-        return lookup_match(m_alt_matches[index + 1]).get_type();
+        return lookup_match_at(m_alt_matches, index + 1).get_type();
     if (m_matches)
         return m_matches->get_match_type(index);
     return match_type::none;
@@ -308,7 +328,7 @@ char match_adapter::get_match_append_char(unsigned int index) const
     if (m_filtered_matches)
         return m_filtered_matches[index + 1]->append_char;
     if (m_alt_matches)
-        return lookup_match(m_alt_matches[index + 1]).get_append_char();
+        return lookup_match_at(m_alt_matches, index + 1).get_append_char();
     if (m_matches)
         return m_matches->get_append_character();
     return 0;
@@ -320,7 +340,7 @@ unsigned char match_adapter::get_match_flags(unsigned int index) const
     if (m_filtered_matches)
         return m_filtered_matches[index + 1]->flags;
     if (m_alt_matches)
-        return lookup_match(m_alt_matches[index + 1]).get_flags();
+        return lookup_match_at(m_alt_matches, index + 1).get_flags();
     if (m_matches)
     {
         unsigned char flags = 0;
@@ -376,6 +396,17 @@ bool match_adapter::use_display(unsigned int index, match_type type, bool append
             (is_custom_display(index)));
 }
 
+//------------------------------------------------------------------------------
+const match_render_info& match_adapter::get_render_info(unsigned int index) const
+{
+    // The real matches can be regenerated in place, so also check the count.
+    if (m_render_info.size() != get_match_count())
+        build_render_info();
+
+    assert(index < m_render_info.size());
+    return m_render_info[index];
+}
+
 //------------------------------------------------------------------------------
 bool match_adapter::is_display_filtered() const
 {
@@ -395,9 +426,9 @@ bool match_adapter::has_descriptions() const
         if (m_alt_cached.m_has_descriptions < 0)
         {
             m_alt_cached.m_has_descriptions = false;
-            for (char** matches = m_alt_matches; *(++matches);)
+            for (unsigned int i = 1; m_alt_matches[i]; ++i)
             {
-                match_details details = lookup_match(*matches);
+                match_details details = lookup_match_at(m_alt_matches, i);
                 if (details)
                 {
                     const char* desc = details.get_description();
@@ -434,6 +465,7 @@ bool match_adapter::has_descriptions() const
 //------------------------------------------------------------------------------
 void match_adapter::free_filtered()
 {
+    m_render_info.clear();
     if (m_filtered_matches)
     {
         free_filtered_matches(m_filtered_matches);
@@ -445,6 +477,7 @@ void match_adapter::free_filtered()
 //------------------------------------------------------------------------------
 void match_adapter::clear_alt()
 {
+    m_render_info.clear();
     if (m_alt_own)
     {
         _rl_free_match_list(m_alt_matches);
@@ -453,3 +486,43 @@ void match_adapter::clear_alt()
     m_alt_matches = nullptr;
     m_alt_cached.clear();
 }
+
+//------------------------------------------------------------------------------
+void match_adapter::build_render_info() const
+{
+    const unsigned int count = get_match_count();
+
+    m_render_info.clear();
+    m_render_info.reserve(count);
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        match_render_info info = {};
+
+        const char* match = get_match(i);
+        const char* visible = __printable_part(const_cast<char*>(match));
+        info.visible_offset = static_cast<unsigned int>(visible - match);
+        info.visible_len = static_cast<unsigned int>(strlen(visible));
+
+        info.type = get_match_type(i);
+
+        // The display routines stat "none" matches to color and mark them, so
+        // use the metadata from enumeration instead when it's available.
+        match_file_info file_info;
+        if (is_match_type(info.type, match_type::none) && get_match_file_info(i, file_info))
+            info.type = to_match_type(file_info);
+
+        info.append = is_append_display(i);
+        info.use_display = use_display(i, info.type, info.append);
+
+        // printable_len() can stat the file, so only measure what the
+        // display routines will actually use.
+        if (info.use_display)
+            info.display_cells = get_match_visible_display(i);
+        if (info.append || !info.use_display)
+            info.printable_cells = printable_len(match, info.type);
+        info.desc_cells = get_match_visible_description(i);
+
+        m_render_info.emplace_back(info);
+    }
+}
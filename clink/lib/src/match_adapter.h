@@ -5,11 +5,30 @@
 
 #include <core/str.h>
 
+#include <vector>
+
 struct match_display_filter_entry;
 class matches;
 class matches_iter;
+struct match_file_info;
 enum class match_type : unsigned char;
 
+//------------------------------------------------------------------------------
+// Measurements of a match that are needed each time the match list is laid
+// out or printed.  They're computed once per match set, since some involve
+// parsing escape codes or even querying the file system.
+struct match_render_info
+{
+    unsigned int    display_cells;      // get_match_visible_display(); only if use_display.
+    unsigned int    printable_cells;    // printable_len(); only if append or !use_display.
+    unsigned int    desc_cells;         // get_match_visible_description().
+    unsigned int    visible_offset;     // Bytes before the __printable_part() of the match.
+    unsigned int    visible_len;        // Bytes in the __printable_part() of the match.
+    match_type      type;               // get_match_type(), or from the file info for "none" matches.
+    bool            append;             // is_append_display().
+    bool            use_display;        // use_display().
+};
+
 //------------------------------------------------------------------------------
 class match_adapter
 {
@@ -33,11 +52,13 @@ public:
     unsigned int    get_match_visible_display(unsigned int index) const;
     const char*     get_match_description(unsigned int index) const;
     unsigned int    get_match_visible_description(unsigned int index) const;
+    bool            get_match_file_info(unsigned int index, match_file_info& out) const;
     char            get_match_append_char(unsigned int index) const;
     unsigned char   get_match_flags(unsigned int index) const;
     bool            is_custom_display(unsigned int index) const;
     bool            is_append_display(unsigned int index) const;
     bool            use_display(unsigned int index, match_type type, bool append) const;
+    const match_render_info& get_render_info(unsigned int index) const;
 
     bool            is_display_filtered() const;
     bool            has_descriptions() const;
@@ -46,6 +67,7 @@ private:
     const char*     get_match_display_internal(unsigned int index) const;
     void            free_filtered();
     void            clear_alt();
+    void            build_render_info() const;
 
 private:
     struct cached_info
@@ -65,4 +87,5 @@ private:
     mutable cached_info m_cached;
     mutable cached_info m_alt_cached;
     mutable cached_info m_filtered_cached;
+    mutable std::vector<match_render_info> m_render_info;
 };
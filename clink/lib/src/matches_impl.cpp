@@ -55,21 +55,23 @@ extern setting_bool g_match_wild;
 
 
 //------------------------------------------------------------------------------
-struct matches_impl::match_lookup_hasher
+struct matches_impl::match_lookup_traits
 {
-    size_t operator()(const match_lookup& info) const
+    static unsigned int hash(const match_lookup& info)
     {
-        return str_hash(info.match);
+        return str_fast_hash(info.match);
     }
-};
 
-//------------------------------------------------------------------------------
-struct matches_impl::match_lookup_comparator
-{
-    bool operator()(const match_lookup& i1, const match_lookup& i2) const
+    static bool equals(const match_lookup& i1, const match_lookup& i2)
     {
         return (i1.type == i2.type && strcmp(i1.match, i2.match) == 0);
     }
+
+    static bool store(linear_allocator& arena, const match_lookup& in, match_lookup& out)
+    {
+        out.type = in.type;
+        return !!(out.match = arena.store(in.match));
+    }
 };
 
 
@@ -114,6 +116,31 @@ match_type to_match_type(DWORD attr, const char* path, bool symlink)
     return type;
 }
 
+//------------------------------------------------------------------------------
+match_type to_match_type(const match_file_info& info)
+{
+    match_type type;
+
+    if (info.attr & FILE_ATTRIBUTE_DIRECTORY)
+        type = match_type::dir;
+    else
+        type = match_type::file;
+
+    if (info.attr & FILE_ATTRIBUTE_HIDDEN)
+        type |= match_type::hidden;
+    if (info.attr & FILE_ATTRIBUTE_READONLY)
+        type |= match_type::readonly;
+
+    if (info.symlink)
+    {
+        type |= match_type::link;
+        if (info.orphaned)
+            type |= match_type::orphaned;
+    }
+
+    return type;
+}
+
 //------------------------------------------------------------------------------
 match_type backcompat_match_type(const char* path)
 {
@@ -218,6 +245,7 @@ match_desc::match_desc(const char* match, const char* display, const char* descr
 : match(match)
 , display(display)
 , description(description)
+, file_info(nullptr)
 , type(type)
 {
     append_char = 0;
@@ -462,6 +490,14 @@ const char* matches_iter::get_match_description() const
     return has_match() ? m_matches.get_match_description(m_index) : nullptr;
 }
 
+//------------------------------------------------------------------------------
+const match_file_info* matches_iter::get_match_file_info() const
+{
+    if (m_has_pattern)
+        return has_match() ? m_matches.get_unfiltered_match_file_info(m_index) : nullptr;
+    return has_match() ? m_matches.get_match_file_info(m_index) : nullptr;
+}
+
 //------------------------------------------------------------------------------
 char matches_iter::get_match_append_char() const
 {
@@ -530,6 +566,21 @@ matches_impl::store_impl::store_impl(unsigned int size)
 {
 }
 
+//------------------------------------------------------------------------------
+const match_file_info* matches_impl::store_impl::store_file_info(const match_file_info& info)
+{
+    // The store packs strings without padding, so over-allocate enough to be
+    // able to align the record.
+    const unsigned int align = alignof(match_file_info);
+    char* ptr = static_cast<char*>(alloc(sizeof(info) + align - 1));
+    if (!ptr)
+        return nullptr;
+
+    ptr += (align - (reinterpret_cast<UINT_PTR>(ptr) % align)) % align;
+    memcpy(ptr, &info, sizeof(info));
+    return reinterpret_cast<const match_file_info*>(ptr);
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -645,6 +696,15 @@ unsigned int matches_impl::get_match_ordinal(unsigned int index) const
     return m_infos[index].ordinal;
 }
 
+//------------------------------------------------------------------------------
+const match_file_info* matches_impl::get_match_file_info(unsigned int index) const
+{
+    if (index >= get_match_count())
+        return nullptr;
+
+    return m_infos[index].file_info;
+}
+
 //------------------------------------------------------------------------------
 char matches_impl::get_match_append_char(unsigned int index) const
 {
@@ -712,6 +772,15 @@ const char* matches_impl::get_unfiltered_match_description(unsigned int index) c
     return m_infos[index].description;
 }
 
+//------------------------------------------------------------------------------
+const match_file_info* matches_impl::get_unfiltered_match_file_info(unsigned int index) const
+{
+    if (index >= get_info_count())
+        return nullptr;
+
+    return m_infos[index].file_info;
+}
+
 //------------------------------------------------------------------------------
 char matches_impl::get_unfiltered_match_append_char(unsigned int index) const
 {
@@ -982,9 +1051,9 @@ bool matches_impl::add_match(const match_desc& desc, bool already_normalized)
     }
 
     if (!m_dedup)
-        m_dedup = new match_lookup_unordered_set;
+        m_dedup = new match_lookup_set;
 
-    if (m_dedup->find({ match, type }) != m_dedup->end())
+    if (m_dedup->contains({ match, type }))
         return false;
 
     if (is_none)
@@ -1012,13 +1081,13 @@ bool matches_impl::add_match(const match_desc& desc, bool already_normalized)
 
     const char* store_display = (desc.display && *desc.display) ? m_store.store_front(desc.display) : nullptr;
     const char* store_description = (desc.description && *desc.description) ? m_store.store_front(desc.description) : nullptr;
+    const match_file_info* store_file_info = desc.file_info ? m_store.store_file_info(*desc.file_info) : nullptr;
     bool append_display = (desc.append_display && store_display);
 
-    match_lookup lookup = { store_match, type };
-    m_dedup->emplace(std::move(lookup));
+    m_dedup->insert({ store_match, type });
 
     unsigned int ordinal = static_cast<unsigned int>(m_infos.size());
-    match_info info = { store_match, store_display, store_description, ordinal, type, desc.append_char, desc.suppress_append, append_display, false/*select*/ };
+    match_info info = { store_match, store_display, store_description, store_file_info, ordinal, type, desc.append_char, desc.suppress_append, append_display, false/*select*/ };
     m_infos.emplace_back(std::move(info));
     ++m_count;
 
@@ -1060,8 +1129,13 @@ void matches_impl::done_building()
                 // Remove it from the dup map before modifying it.
                 m_dedup->erase(lookup);
 
-                // Apply backward compatibility logic to the match type.
-                lookup.type = backcompat_match_type(lookup.match);
+                // Apply backward compatibility logic to the match type.  Use
+                // the metadata from enumeration when available, to avoid
+                // touching the file system again.
+                if (m_infos[i].file_info)
+                    lookup.type = to_match_type(*m_infos[i].file_info);
+                else
+                    lookup.type = backcompat_match_type(lookup.match);
                 m_infos[i].type = lookup.type;
 
                 // If it's a directory, add a trailing path separator.
@@ -1073,10 +1147,10 @@ void matches_impl::done_building()
                 }
 
                 // Check if it has become a duplicate.
-                if (m_dedup->find(lookup) != m_dedup->end())
+                if (m_dedup->contains(lookup))
                     m_infos.erase(m_infos.begin() + i);
                 else
-                    m_dedup->emplace(std::move(lookup));
+                    m_dedup->insert(lookup);
             }
         }
     }
@@ -6,8 +6,8 @@
 #include "matches.h"
 
 #include "core/array.h"
+#include "core/flat_hash_map.h"
 #include "core/linear_allocator.h"
-#include <unordered_set>
 #include <vector>
 
 //------------------------------------------------------------------------------
@@ -16,6 +16,7 @@ struct match_info
     const char*     match;
     const char*     display;
     const char*     description;
+    const match_file_info* file_info;   // Null when no metadata is available.
     unsigned        ordinal;            // Original unsorted order.
     match_type      type;
     char            append_char;        // Zero means not specified.
@@ -50,11 +51,10 @@ class match_generator;
 class matches_impl
     : DBGOBJECT_ public matches
 {
-    struct match_lookup_hasher;
-    struct match_lookup_comparator;
+    struct match_lookup_traits;
 
 public:
-    typedef std::unordered_set<match_lookup, match_lookup_hasher, match_lookup_comparator> match_lookup_unordered_set;
+    typedef flat_hash_set<match_lookup, match_lookup_traits> match_lookup_set;
 
                             matches_impl(unsigned int store_size=0x10000);
                             ~matches_impl();
@@ -68,6 +68,7 @@ public:
     virtual const char*     get_match_display(unsigned int index) const override;
     virtual const char*     get_match_description(unsigned int index) const override;
     virtual unsigned int    get_match_ordinal(unsigned int index) const override;
+    virtual const match_file_info* get_match_file_info(unsigned int index) const override;
     virtual char            get_match_append_char(unsigned int index) const override;
     virtual shadow_bool     get_match_suppress_append(unsigned int index) const override;
     virtual bool            get_match_append_display(unsigned int index) const override;
@@ -96,6 +97,7 @@ private:
     virtual match_type      get_unfiltered_match_type(unsigned int index) const override;
     virtual const char*     get_unfiltered_match_display(unsigned int index) const override;
     virtual const char*     get_unfiltered_match_description(unsigned int index) const override;
+    virtual const match_file_info* get_unfiltered_match_file_info(unsigned int index) const override;
     virtual char            get_unfiltered_match_append_char(unsigned int index) const override;
     virtual shadow_bool     get_unfiltered_match_suppress_append(unsigned int index) const override;
     virtual bool            get_unfiltered_match_append_display(unsigned int index) const override;
@@ -123,6 +125,7 @@ private:
     public:
                             store_impl(unsigned int size);
         const char*         store_front(const char* str) { return store(str); }
+        const match_file_info* store_file_info(const match_file_info& info);
     };
 
     typedef std::vector<match_info> infos;
@@ -145,7 +148,7 @@ private:
     shadow_bool             m_filename_completion_desired;
     shadow_bool             m_filename_display_desired;
 
-    match_lookup_unordered_set* m_dedup = nullptr;
+    match_lookup_set*       m_dedup = nullptr;
 };
 
 //------------------------------------------------------------------------------
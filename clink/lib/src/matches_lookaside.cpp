@@ -4,11 +4,12 @@
 #include "pch.h"
 #include "display_matches.h"
 #include "matches_lookaside.h"
-#include <core/linear_allocator.h>
 #include <terminal/ecma48_iter.h>
 
+#include <algorithm>
+#include <functional>
 #include <list>
-#include <unordered_map>
+#include <vector>
 #include <assert.h>
 
 extern "C" {
@@ -73,7 +74,7 @@ static int plainify(const char* s, char** strip)
 }
 
 //------------------------------------------------------------------------------
-size_t calc_packed_size(const char* match, const char* display, const char* description)
+size_t calc_packed_size(const char* match, const char* display, const char* description, const match_file_info* file_info)
 {
     size_t alloc_size = 3;              // For the 3 NUL terminators.
     alloc_size++;                       // For the match type.
@@ -85,6 +86,7 @@ size_t calc_packed_size(const char* match, const char* display, const char* desc
 #endif
     if (display) alloc_size += strlen(display);
     if (description) alloc_size += strlen(description);
+    if (file_info) alloc_size += sizeof(*file_info);
     return alloc_size;
 }
 
@@ -94,7 +96,8 @@ bool pack_match(char* buffer, size_t packed_size,
                 const char* display, const char* description,
                 char append_char, unsigned char flags,
                 match_display_filter_entry* entry,
-                bool strip_markup, bool lcd)
+                bool strip_markup, bool lcd,
+                const match_file_info* file_info)
 {
 #ifdef DEBUG
     assert(match || display);
@@ -114,6 +117,13 @@ bool pack_match(char* buffer, size_t packed_size,
     if (display && !display[0] && !lcd)
         return false;
 
+    if (file_info)
+        flags |= MATCH_FLAG_HAS_FILE_INFO;
+    else
+        flags &= ~MATCH_FLAG_HAS_FILE_INFO;
+    if (entry)
+        entry->flags = flags;
+
     *(buffer++) = (char)type;   // Match type.
     *(buffer++) = append_char;  // Append char.
     *(buffer++) = flags;        // Match flags.
@@ -153,6 +163,14 @@ bool pack_match(char* buffer, size_t packed_size,
         append_string_into_buffer(buffer, description);
     }
 
+    // File info is copied unaligned; match_details::get_file_info() copies it
+    // back out.
+    if (file_info)
+    {
+        memcpy(buffer, file_info, sizeof(*file_info));
+        buffer += sizeof(*file_info);
+    }
+
     assert(orig_buffer + packed_size == buffer);
 
     return true;
@@ -161,7 +179,32 @@ bool pack_match(char* buffer, size_t packed_size,
 
 
 //------------------------------------------------------------------------------
-const match_extra match_details::s_empty_extra = { 0, 0, match_type::none };
+bool get_packed_match_file_info(const char* packed, match_file_info& out)
+{
+    if (!packed)
+        return false;
+
+    packed += strlen(packed) + 1;
+    const unsigned char flags = static_cast<unsigned char>(packed[2]);
+    if (!(flags & MATCH_FLAG_HAS_FILE_INFO))
+        return false;
+
+    packed += 3;
+#ifdef DEBUG
+    assert(strnicmp(packed, ":LA:", 4) == 0);
+    packed += 4;
+#endif
+    packed += strlen(packed) + 1;       // Skip display.
+    packed += strlen(packed) + 1;       // Skip description.
+
+    memcpy(&out, packed, sizeof(out));
+    return true;
+}
+
+
+
+//------------------------------------------------------------------------------
+const match_extra match_details::s_empty_extra = { 0, 0, 0, match_type::none };
 
 //------------------------------------------------------------------------------
 match_details::match_details(const char* match, const match_extra* extra)
@@ -170,22 +213,44 @@ match_details::match_details(const char* match, const match_extra* extra)
 {
 }
 
+//------------------------------------------------------------------------------
+bool match_details::get_file_info(match_file_info& out) const
+{
+    if (!m_match || !m_extra->file_info_offset)
+        return false;
+
+    memcpy(&out, m_match + m_extra->file_info_offset, sizeof(out));
+    return true;
+}
+
 
 
 //------------------------------------------------------------------------------
+// Side data for a Readline match array.  Nothing is parsed up front; each
+// match's extra info is parsed from the PACKED MATCH FORMAT the first time it
+// is looked up, so huge match arrays don't pay for matches that are never
+// displayed.  Lookups by index go straight to the entry; lookups by pointer
+// use an index sorted by address, which is only built if needed.
 class matches_lookaside
 {
-    typedef std::unordered_map<UINT_PTR, match_extra*> match_extra_map;
+    struct entry
+    {
+        const char*         match;
+        match_extra         extra;
+        bool                parsed;
+    };
+
 public:
                             matches_lookaside(char** matches);
-                            ~matches_lookaside();
     bool                    associated(char** matches) const;
-    const match_extra*      find(const char* match) const;
+    const match_extra*      find(const char* match);
+    const match_extra*      find_at(unsigned int index);
 private:
-    bool                    add(const char* match);
+    const match_extra*      get_extra(entry& e);
+    static void             parse(const char* match, match_extra& extra);
     char**                  m_matches;
-    match_extra_map         m_map;
-    linear_allocator        m_allocator;
+    std::vector<entry>      m_entries;      // In the original order, without the lcd.
+    std::vector<unsigned int> m_by_address; // Indices into m_entries.
 };
 
 //------------------------------------------------------------------------------
@@ -194,17 +259,19 @@ static std::list<matches_lookaside*> s_lookasides;
 //------------------------------------------------------------------------------
 matches_lookaside::matches_lookaside(char** matches)
 : m_matches(matches)
-, m_allocator(8192)
 {
     assert(matches);
     if (matches[1]) // Ignore lcd (the [0] entry); list is always >= 2 entries.
-        while (add(*(++matches))) {}
-};
+    {
+        unsigned int count = 0;
+        while (matches[count + 1])
+            ++count;
 
-//------------------------------------------------------------------------------
-matches_lookaside::~matches_lookaside()
-{
-}
+        m_entries.reserve(count);
+        while (const char* match = *(++matches))
+            m_entries.push_back({ match, {}, false });
+    }
+};
 
 //------------------------------------------------------------------------------
 bool matches_lookaside::associated(char** matches) const
@@ -213,39 +280,71 @@ bool matches_lookaside::associated(char** matches) const
 }
 
 //------------------------------------------------------------------------------
-const match_extra* matches_lookaside::find(const char* match) const
+const match_extra* matches_lookaside::find(const char* match)
 {
-    auto const iter = m_map.find(reinterpret_cast<UINT_PTR>(match));
-    if (iter == m_map.end())
+    if (m_by_address.size() != m_entries.size())
+    {
+        m_by_address.resize(m_entries.size());
+        for (unsigned int i = 0; i < m_entries.size(); ++i)
+            m_by_address[i] = i;
+        std::sort(m_by_address.begin(), m_by_address.end(), [this] (unsigned int a, unsigned int b) {
+            return std::less<const char*>()(m_entries[a].match, m_entries[b].match);
+        });
+    }
+
+    auto const iter = std::lower_bound(m_by_address.begin(), m_by_address.end(), match, [this] (unsigned int a, const char* b) {
+        return std::less<const char*>()(m_entries[a].match, b);
+    });
+    if (iter == m_by_address.end() || m_entries[*iter].match != match)
         return nullptr;
-    return iter->second;
+    return get_extra(m_entries[*iter]);
 }
 
 //------------------------------------------------------------------------------
-bool matches_lookaside::add(const char* match)
+const match_extra* matches_lookaside::find_at(unsigned int index)
 {
-    if (!match)
-        return false;
+    // Readline may have sorted the array in place since the lookaside was
+    // created, so the entry only applies if it's still the same match.
+    const char* match = m_matches[index];
+    if (index >= 1 && index <= m_entries.size() && m_entries[index - 1].match == match)
+        return get_extra(m_entries[index - 1]);
+    return find(match);
+}
 
-    UINT_PTR key = reinterpret_cast<UINT_PTR>(match);
-    match_extra* extra = (match_extra*)m_allocator.alloc(sizeof(*extra));
-    if (!extra)
-        return false;
+//------------------------------------------------------------------------------
+const match_extra* matches_lookaside::get_extra(entry& e)
+{
+    if (!e.parsed)
+    {
+        parse(e.match, e.extra);
+        e.parsed = true;
+    }
+    return &e.extra;
+}
 
+//------------------------------------------------------------------------------
+void matches_lookaside::parse(const char* match, match_extra& extra)
+{
     size_t len = strlen(match) + 1;
-    extra->type = static_cast<match_type>(match[len++]);
-    extra->append_char = match[len++];
-    extra->flags = static_cast<unsigned char>(match[len++]);
+    extra.type = static_cast<match_type>(match[len++]);
+    extra.append_char = match[len++];
+    extra.flags = static_cast<unsigned char>(match[len++]);
 #ifdef DEBUG
     const bool is_magic = (strnicmp(match + len, ":LA:", 4) == 0);
     assert(is_magic);
     len += 4;
 #endif
-    extra->display_offset = static_cast<unsigned short>(len);
-    extra->description_offset = static_cast<unsigned short>(len + strlen(match + len) + 1);
-
-    m_map.emplace(key, extra);
-    return true;
+    extra.display_offset = static_cast<unsigned short>(len);
+    extra.description_offset = static_cast<unsigned short>(len + strlen(match + len) + 1);
+    if (extra.flags & MATCH_FLAG_HAS_FILE_INFO)
+    {
+        const char* description = match + extra.description_offset;
+        extra.file_info_offset = static_cast<unsigned short>(extra.description_offset + strlen(description) + 1);
+    }
+    else
+    {
+        extra.file_info_offset = 0;
+    }
 }
 
 
@@ -270,6 +369,24 @@ assert(false);
     return match_details(nullptr, nullptr);
 }
 
+//------------------------------------------------------------------------------
+match_details lookup_match_at(char** matches, unsigned int index)
+{
+    assert(matches);
+    assert(index > 0);
+    for (auto iter : s_lookasides)
+    {
+        if (iter->associated(matches))
+        {
+            const match_extra* extra = iter->find_at(index);
+            if (extra)
+                return match_details(matches[index], extra);
+            break;
+        }
+    }
+    return lookup_match(matches[index]);
+}
+
 //------------------------------------------------------------------------------
 int create_matches_lookaside(char** matches)
 {
@@ -317,7 +434,8 @@ void set_matches_lookaside_oneoff(const char* match, match_type type, char appen
     s_match = match;
     s_extra.type = type;
     s_extra.append_char = append_char;
-    s_extra.flags = flags;
+    s_extra.flags = flags & ~MATCH_FLAG_HAS_FILE_INFO;
+    s_extra.file_info_offset = 0;
 }
 
 //------------------------------------------------------------------------------
@@ -0,0 +1,85 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "popup_row_cache.h"
+
+#include <assert.h>
+
+//------------------------------------------------------------------------------
+bool popup_row_key::operator == (const popup_row_key& other) const
+{
+    return (index == other.index &&
+            selected == other.selected &&
+            width == other.width &&
+            column == other.column &&
+            horz_offset == other.horz_offset);
+}
+
+
+
+//------------------------------------------------------------------------------
+void popup_row_cache::clear()
+{
+    m_screen.clear();
+    m_rendered.clear();
+    m_next_evict = 0;
+}
+
+//------------------------------------------------------------------------------
+void popup_row_cache::forget_screen()
+{
+    m_screen.clear();
+}
+
+//------------------------------------------------------------------------------
+bool popup_row_cache::is_displayed(int row, const popup_row_key& key) const
+{
+    return (row >= 0 && row < int(m_screen.size()) && m_screen[row] == key);
+}
+
+//------------------------------------------------------------------------------
+void popup_row_cache::set_displayed(int row, const popup_row_key& key)
+{
+    assert(row >= 0);
+    if (row >= int(m_screen.size()))
+    {
+        // Rows that haven't been drawn yet get a key that can't match.
+        popup_row_key unknown = { -1, -1, -1, -1, -1 };
+        m_screen.resize(row + 1, unknown);
+    }
+    m_screen[row] = key;
+}
+
+//------------------------------------------------------------------------------
+const str_base* popup_row_cache::find(const popup_row_key& key) const
+{
+    // There are few enough rows that a linear search is cheaper than hashing.
+    for (const auto& rendered : m_rendered)
+    {
+        if (rendered.key == key)
+            return &rendered.bytes;
+    }
+    return nullptr;
+}
+
+//------------------------------------------------------------------------------
+const str_base& popup_row_cache::store(const popup_row_key& key, const char* bytes, unsigned int len)
+{
+    rendered_row* rendered;
+    if (m_rendered.size() < max_rendered)
+    {
+        m_rendered.emplace_back();
+        rendered = &m_rendered.back();
+    }
+    else
+    {
+        rendered = &m_rendered[m_next_evict];
+        m_next_evict = (m_next_evict + 1) % max_rendered;
+    }
+
+    rendered->key = key;
+    rendered->bytes.clear();
+    rendered->bytes.concat(bytes, len);
+    return rendered->bytes;
+}
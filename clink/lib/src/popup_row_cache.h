@@ -0,0 +1,53 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <core/str.h>
+
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Everything that determines the bytes emitted for one row of a popup list.
+struct popup_row_key
+{
+    bool            operator == (const popup_row_key& other) const;
+    bool            operator != (const popup_row_key& other) const { return !(*this == other); }
+
+    int             index;          // First item on the row.
+    int             selected;       // Selected item on the row, or -1.
+    int             width;          // Width of the row in cells.
+    int             column;         // Screen column where the row starts.
+    int             horz_offset;    // Horizontal scroll offset.
+};
+
+//------------------------------------------------------------------------------
+// Retains the rendered bytes of popup rows, and which row key was last shown
+// on each screen row.  Redrawing the popup then only emits rows whose key
+// changed, and scrolling reuses rows that were already rendered.
+//
+// The owner must call clear() whenever the items or column layout change, and
+// forget_screen() whenever something else may have drawn over the popup.
+class popup_row_cache
+{
+public:
+    void            clear();
+    void            forget_screen();
+    bool            is_displayed(int row, const popup_row_key& key) const;
+    void            set_displayed(int row, const popup_row_key& key);
+    const str_base* find(const popup_row_key& key) const;
+    const str_base& store(const popup_row_key& key, const char* bytes, unsigned int len);
+
+private:
+    enum { max_rendered = 128 };
+
+    struct rendered_row
+    {
+        popup_row_key   key;
+        str_moveable    bytes;
+    };
+
+    std::vector<popup_row_key> m_screen;
+    std::vector<rendered_row> m_rendered;
+    unsigned int    m_next_evict = 0;
+};
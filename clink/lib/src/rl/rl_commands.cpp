@@ -18,6 +18,7 @@
 #include <core/base.h>
 #include <core/log.h>
 #include <core/path.h>
+#include <core/perf_stats.h>
 #include <core/settings.h>
 #include <core/debugheap.h>
 #include <terminal/printer.h>
@@ -2186,6 +2187,9 @@ int clink_diagnostics(int count, int invoking_key)
     extern void task_manager_diagnostics();
     task_manager_diagnostics();
 
+    extern void lua_memory_diagnostics();
+    lua_memory_diagnostics();
+
     if (!rl_explicit_arg)
         g_printer->print("\n(Use a numeric argument for additional diagnostics; e.g. press Alt+1 first.)\n");
 
@@ -2193,6 +2197,35 @@ int clink_diagnostics(int count, int invoking_key)
     return 0;
 }
 
+//------------------------------------------------------------------------------
+int clink_show_perf(int count, int invoking_key)
+{
+    end_prompt(true/*crlf*/);
+
+    str_moveable s;
+    if (!perf_stats_report(s))
+    {
+#ifdef USE_PERF_STATS
+        if (!perf_stats_enabled())
+            s = "Keystroke timings are off; run 'clink set debug.perf_stats true' to record them.\n";
+        else
+            s = "No keystroke timings have been recorded yet.\n";
+#else
+        s = "Keystroke timings are not available in this build.\n";
+#endif
+    }
+    g_printer->print(s.c_str(), s.length());
+
+    if (rl_explicit_arg)
+    {
+        perf_stats_reset();
+        g_printer->print("(The timings have been reset.)\n");
+    }
+
+    rl_forced_update_display();
+    return 0;
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -2211,6 +2244,9 @@ int macro_hook_func(const char* macro)
         extern void reset_generate_matches();
         reset_generate_matches();
 
+        // Lua scripts can query or write to the console directly.
+        flush_printer_frame();
+
         HANDLE std_handles[2] = { GetStdHandle(STD_INPUT_HANDLE), GetStdHandle(STD_OUTPUT_HANDLE) };
         DWORD prev_mode[2];
         static_assert(_countof(std_handles) == _countof(prev_mode), "array sizes must match");
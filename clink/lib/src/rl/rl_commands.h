@@ -26,6 +26,7 @@ enum
     keycat_MAX
 };
 void    clink_add_funmap_entry(const char *name, rl_command_func_t *function, int cat, const char* desc);
+int     get_function_category(rl_command_func_t* func);
 
 //------------------------------------------------------------------------------
 int     macro_hook_func(const char* macro);
@@ -144,3 +145,4 @@ int     magic_space(int count, int invoking_key);
 
 //------------------------------------------------------------------------------
 int     clink_diagnostics(int count, int invoking_key);
+int     clink_show_perf(int count, int invoking_key);
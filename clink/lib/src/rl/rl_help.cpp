@@ -412,6 +412,16 @@ static bool get_function_info(int (*func_addr)(int, int), const char** desc, int
     return false;
 }
 
+//------------------------------------------------------------------------------
+int get_function_category(rl_command_func_t* func)
+{
+    ensure_keydesc_map();
+
+    int cat = keycat_none;
+    get_function_info(func, nullptr, &cat);
+    return cat;
+}
+
 //------------------------------------------------------------------------------
 static void concat_key_string(int i, str<32>& keyseq)
 {
@@ -4,6 +4,7 @@
 #include "pch.h"
 #include "rl_module.h"
 #include "rl_commands.h"
+#include "history_db.h"
 #include "line_buffer.h"
 #include "line_state.h"
 #include "matches.h"
@@ -505,6 +506,22 @@ bool get_sticky_search_add_history(const char* line)
     return false;
 }
 
+//------------------------------------------------------------------------------
+// Loads history lines deferred by the history.lazy_load setting.  They're
+// inserted ahead of the loaded lines, so history positions shift accordingly.
+void load_deferred_history()
+{
+    history_database* h = history_database::get();
+    const int count = h ? h->load_deferred_lines() : 0;
+    if (count <= 0)
+        return;
+
+    if (s_init_history_pos >= 0)
+        s_init_history_pos += count;
+    if (s_history_search_pos >= 0)
+        s_history_search_pos += count;
+}
+
 
 
 //------------------------------------------------------------------------------
@@ -553,6 +570,28 @@ static void last_func_hook_func()
     host_send_event("onaftercommand");
 }
 
+//------------------------------------------------------------------------------
+static void before_func_hook_func(rl_command_func_t* func)
+{
+    history_database* h = history_database::get();
+    if (!h || !h->has_deferred_lines())
+        return;
+
+    // Moving forward through history never reaches deferred lines, and moving
+    // backward only does once it passes the first loaded line.
+    if (func == rl_get_next_history || func == rl_end_of_history)
+        return;
+    if (func == rl_get_previous_history)
+    {
+        const int count = rl_numeric_arg * rl_arg_sign;
+        if (count <= 0 || where_history() - count >= 0)
+            return;
+    }
+
+    if (get_function_category(func) == keycat_history)
+        load_deferred_history();
+}
+
 //------------------------------------------------------------------------------
 void override_rl_last_func(rl_command_func_t* func, bool force_when_null)
 {
@@ -761,6 +800,8 @@ static int terminal_read_thunk(FILE* stream)
 {
     if (stream == in_stream)
     {
+        // Show any pending output before possibly waiting for input.
+        flush_printer_frame();
         assert(s_processed_input);
         return s_processed_input->read();
     }
@@ -790,6 +831,8 @@ static void terminal_write_thunk(FILE* stream, const char* chars, int char_count
         if (stream == stderr && g_rl_hide_stderr.get())
             return;
 
+        flush_printer_frame();
+
         DWORD dw;
         HANDLE h = GetStdHandle(stream == stderr ? STD_ERROR_HANDLE : STD_OUTPUT_HANDLE);
         if (GetConsoleMode(h, &dw))
@@ -837,6 +880,8 @@ static void terminal_log_write(FILE* stream, const char* chars, int char_count)
         if (stream == stderr && g_rl_hide_stderr.get())
             return;
 
+        flush_printer_frame();
+
         DWORD dw;
         HANDLE h = GetStdHandle(stream == stderr ? STD_ERROR_HANDLE : STD_OUTPUT_HANDLE);
         if (GetConsoleMode(h, &dw))
@@ -1093,6 +1138,7 @@ void set_suggestion(const char* line, unsigned int endword_offset, const char* s
 }
 
 //------------------------------------------------------------------------------
+static bool s_defer_display = false;
 static bool s_force_signaled_redisplay = false;
 void force_signaled_redisplay()
 {
@@ -1107,6 +1153,11 @@ void hook_display()
         return;
     rollback<bool> rb(s_busy, true);
 
+    // While a burst of text is being inserted, the editor redisplays once
+    // after the burst ends.
+    if (s_defer_display)
+        return;
+
     // Readline callback mode seems to have some problems with how redisplay
     // works.  It shows the old buffer and shows the prompt at an inopportune
     // time.  So just disable it so Clink can drive when redisplay happens.
@@ -1614,6 +1665,8 @@ stop:
         //  - 1 byte:   FLAGS (unsigned char)
         //  - N bytes:  DISPLAY (nul terminated char string)
         //  - N bytes:  DESCRIPTION (nul terminated char string)
+        //  - N bytes:  FILE INFO (match_file_info), only when FLAGS includes
+        //              MATCH_FLAG_HAS_FILE_INFO
         //
         // WARNING:  Several things rely on this memory layout, including
         // display_match_list_internal, matches_lookaside, and
@@ -1634,12 +1687,13 @@ stop:
         const char* const match = iter.get_match();
         const char* const display = iter.get_match_display();
         const char* const description = iter.get_match_description();
-        const size_t packed_size = calc_packed_size(match, display, description);
+        const match_file_info* const file_info = iter.get_match_file_info();
+        const size_t packed_size = calc_packed_size(match, display, description, file_info);
         char* ptr = (char*)malloc(packed_size);
 
         matches[count] = ptr;
 
-        if (!pack_match(ptr, packed_size, match, type, display, description, iter.get_match_append_char(), flags, nullptr, false))
+        if (!pack_match(ptr, packed_size, match, type, display, description, iter.get_match_append_char(), flags, nullptr, false, false, file_info))
         {
             --count;
             free(ptr);
@@ -1901,6 +1955,7 @@ static void init_readline_hooks()
     // Macro hooks (for "luafunc:" support).
     rl_macro_hook_func = macro_hook_func;
     rl_last_func_hook_func = last_func_hook_func;
+    rl_before_func_hook_func = before_func_hook_func;
 }
 
 //------------------------------------------------------------------------------
@@ -2021,6 +2076,7 @@ void initialise_readline(const char* shell_name, const char* state_dir, const ch
         clink_add_funmap_entry("magic-space", magic_space, keycat_history, "Perform history expansion on the text before the cursor position and insert a space");
 
         clink_add_funmap_entry("clink-diagnostics", clink_diagnostics, keycat_misc, "Show internal diagnostic information");
+        clink_add_funmap_entry("clink-show-perf", clink_show_perf, keycat_misc, "Show how long each stage of handling keystrokes has taken.  A numeric argument resets the timings afterwards");
 
         // Alias some command names for convenient compatibility with bash .inputrc configuration entries.
         rl_add_funmap_entry("alias-expand-line", clink_expand_doskey_alias);
@@ -2627,6 +2683,12 @@ bool rl_module::is_input_pending()
     return is_readline_input_pending();
 }
 
+//------------------------------------------------------------------------------
+void rl_module::set_defer_display(bool defer)
+{
+    s_defer_display = defer;
+}
+
 //------------------------------------------------------------------------------
 bool rl_module::next_line(str_base& out)
 {
@@ -2841,6 +2903,8 @@ void rl_module::on_end_line()
 //------------------------------------------------------------------------------
 bool translate_xy_to_readline(unsigned int x, unsigned int y, int& pos, bool clip=false)
 {
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
 
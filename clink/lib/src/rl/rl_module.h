@@ -50,6 +50,7 @@ public:
     void            set_prompt(const char* prompt, const char* rprompt, bool redisplay);
 
     bool            is_input_pending();
+    void            set_defer_display(bool defer);
     bool            next_line(str_base& out);
 
 private:
@@ -16,6 +16,7 @@
 #include "match_adapter.h"
 
 #include <core/base.h>
+#include <core/perf_stats.h>
 #include <core/settings.h>
 #include <core/str_compare.h>
 #include <core/str_iter.h>
@@ -270,6 +271,7 @@ cant_activate:
         // purely using only ANSI codes.
         CONSOLE_SCREEN_BUFFER_INFO csbi;
         HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         COORD restore = csbi.dwCursorPosition;
 
@@ -290,6 +292,7 @@ cant_activate:
         // Restore cursor position.
         m_printer->print("\x1b[A");
         _rl_move_vert(vpos);
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         restore.Y = csbi.dwCursorPosition.Y;
         SetConsoleCursorPosition(h, restore);
@@ -301,6 +304,7 @@ cant_activate:
         _rl_move_vert(_rl_vis_botlin);
         rl_crlf();
         m_printer->print("\x1b[K");
+        m_printer->flush_frame();
         SetConsoleCursorPosition(h, restore);
 
         if (!yes)
@@ -1111,9 +1115,11 @@ stop:
             const char* text = m_matches.get_match(i);
             const char* disp = m_matches.get_match_display_raw(i);
             const char* desc = m_matches.get_match_description(i);
-            const size_t packed_size = calc_packed_size(text, disp, desc);
+            match_file_info file_info;
+            const match_file_info* file_info_ptr = m_matches.get_match_file_info(i, file_info) ? &file_info : nullptr;
+            const size_t packed_size = calc_packed_size(text, disp, desc, file_info_ptr);
             char* buffer = static_cast<char*>(malloc(packed_size));
-            if (pack_match(buffer, packed_size, text, m_matches.get_match_type(i), disp, desc, m_matches.get_match_append_char(i), m_matches.get_match_flags(i), nullptr, false))
+            if (pack_match(buffer, packed_size, text, m_matches.get_match_type(i), disp, desc, m_matches.get_match_append_char(i), m_matches.get_match_flags(i), nullptr, false, false, file_info_ptr))
                 matches.emplace_back(buffer);
             else
                 free(buffer);
@@ -1166,9 +1172,11 @@ stop:
             const char* text = m_matches.get_match(i);
             const char* disp = m_matches.get_match_display_raw(i);
             const char* desc = m_matches.get_match_description(i);
-            const size_t packed_size = calc_packed_size(text, disp, desc);
+            match_file_info file_info;
+            const match_file_info* file_info_ptr = m_matches.get_match_file_info(i, file_info) ? &file_info : nullptr;
+            const size_t packed_size = calc_packed_size(text, disp, desc, file_info_ptr);
             char* buffer = static_cast<char*>(malloc(packed_size));
-            if (pack_match(buffer, packed_size, text, m_matches.get_match_type(i), disp, desc, m_matches.get_match_append_char(i), m_matches.get_match_flags(i), nullptr, false))
+            if (pack_match(buffer, packed_size, text, m_matches.get_match_type(i), disp, desc, m_matches.get_match_append_char(i), m_matches.get_match_flags(i), nullptr, false, false, file_info_ptr))
                 matches[++num] = buffer;
             else
                 free(buffer);
@@ -1214,18 +1222,16 @@ stop:
         {
             int len = 0;
 
-            match_type type = m_matches.get_match_type(i);
-            const char* match = m_matches.get_match(i);
-            bool append = m_matches.is_append_display(i);
-            if (use_display(append, type, i))
+            const match_render_info& info = m_matches.get_render_info(i);
+            if (info.use_display)
             {
-                if (append)
-                    len += printable_len(match, type);
-                len += m_matches.get_match_visible_display(i);
+                if (info.append)
+                    len += info.printable_cells;
+                len += info.display_cells;
             }
             else
             {
-                len += printable_len(match, type);
+                len += info.printable_cells;
             }
 
             if (m_match_longest < len)
@@ -1253,6 +1259,9 @@ void selectcomplete_impl::update_len(unsigned int needle_len)
 //------------------------------------------------------------------------------
 void selectcomplete_impl::update_layout()
 {
+    // Column widths and description placement can change.
+    m_row_cache.clear();
+
 #ifdef DEBUG
     m_annotate = !!dbg_get_env_int("DEBUG_SHOWTYPES");
     m_col_extra = m_annotate ? 3 : 0;   // Room for space hex hex.
@@ -1347,6 +1356,7 @@ void selectcomplete_impl::update_display()
         // consistent with Readline's view of the world.
         CONSOLE_SCREEN_BUFFER_INFO csbi;
         HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         COORD restore = csbi.dwCursorPosition;
         const int vpos = _rl_last_v_pos;
@@ -1369,6 +1379,7 @@ void selectcomplete_impl::update_display()
 
         // Display matches.
         int up = 0;
+        unsigned int bytes = 0;
         const int count = m_matches.get_match_count();
         if (is_active() && count > 0)
         {
@@ -1395,6 +1406,11 @@ void selectcomplete_impl::update_display()
                     m_comment_row_displayed = false;
             }
 
+            // Scrolling leaves the rows on the screen intact; anything else
+            // that forces a full redraw may have overwritten them.
+            if (m_clear_display || (m_prev_displayed < 0 && !m_scrolled))
+                m_row_cache.forget_screen();
+
             const bool show_descriptions = !m_desc_below && m_matches.has_descriptions();
             const bool show_more_comment_row = !m_expanded && (preview_rows + 1 < m_match_rows);
             const int rows = min<int>(m_visible_rows, show_more_comment_row ? preview_rows : m_match_rows);
@@ -1441,10 +1457,19 @@ void selectcomplete_impl::update_display()
                 }
 
                 // Print matches on the row.
-                if (m_prev_displayed < 0 ||
-                    row + m_top == get_match_row(m_index) ||
-                    row + m_top == get_match_row(m_prev_displayed))
+                const int selected_on_row = (m_index >= 0 && row + m_top == get_match_row(m_index)) ? m_index : -1;
+                const popup_row_key key = { i, selected_on_row, m_screen_cols, 0, 0 };
+                if (!m_row_cache.is_displayed(row, key))
                 {
+                    const str_base* rendered = m_row_cache.find(key);
+                    if (rendered)
+                    {
+                        m_printer->print(rendered->c_str(), rendered->length());
+                        m_row_cache.set_displayed(row, key);
+                        bytes += rendered->length();
+                        continue;
+                    }
+
                     str<> truncated;
                     str<> tmp;
                     reset_tmpbuf();
@@ -1463,23 +1488,24 @@ void selectcomplete_impl::update_display()
 
                         const int selected = (i == m_index);
                         const char* const display = m_matches.get_match_display(i);
-                        const match_type type = m_matches.get_match_type(i);
-                        const bool append = m_matches.is_append_display(i);
+                        const match_render_info& info = m_matches.get_render_info(i);
+                        const match_type type = info.type;
+                        const bool append = info.append;
 
                         mark_tmpbuf();
                         int printed_len;
-                        if (use_display(append, type, i))
+                        if (info.use_display)
                         {
                             printed_len = 0;
                             if (append)
                             {
                                 assert(!m_matches.is_display_filtered());
                                 const char* match = m_matches.get_match(i);
-                                char* temp = __printable_part(const_cast<char*>(match));
+                                char* temp = const_cast<char*>(match) + info.visible_offset;
                                 printed_len = append_filename(temp, match, 0, 0, type, selected, nullptr);
                             }
                             append_display(display, selected, append ? _rl_arginfo_color : _rl_filtered_color);
-                            printed_len += m_matches.get_match_visible_display(i);
+                            printed_len += info.display_cells;
 
                             if (printed_len > col_max || selected)
                             {
@@ -1534,7 +1560,7 @@ void selectcomplete_impl::update_display()
                             const int parens = 0;
 #endif
                             const int pad_to = (right_justify ?
-                                max<int>(printed_len + m_widths.m_desc_padding, col_max - (m_matches.get_match_visible_description(i) + parens)) :
+                                max<int>(printed_len + m_widths.m_desc_padding, col_max - (info.desc_cells + parens)) :
                                 m_widths.m_max_match + 4);
                             if (pad_to < m_screen_cols - 1)
                             {
@@ -1574,10 +1600,17 @@ void selectcomplete_impl::update_display()
 
                         i = next;
                     }
-                    flush_tmpbuf();
-
                     // Clear to end of line.
-                    m_printer->print("\x1b[m\x1b[K");
+                    append_tmpbuf_string("\x1b[m\x1b[K", 6);
+
+                    int len;
+                    const char* tmpbuf = get_tmpbuf(&len);
+                    rendered = &m_row_cache.store(key, tmpbuf, len);
+                    reset_tmpbuf();
+
+                    m_printer->print(rendered->c_str(), rendered->length());
+                    m_row_cache.set_displayed(row, key);
+                    bytes += rendered->length();
                 }
             }
 
@@ -1600,6 +1633,7 @@ void selectcomplete_impl::update_display()
                     }
                     m_printer->print(tmp.c_str(), tmp.length());
                     m_comment_row_displayed = true;
+                    bytes += tmp.length();
                 }
             }
 
@@ -1642,8 +1676,12 @@ void selectcomplete_impl::update_display()
             m_comment_row_displayed = false;
             m_expanded = false;
             m_clear_display = false;
+            m_row_cache.clear();
         }
 
+        m_scrolled = false;
+        perf_stats_record_popup_bytes(bytes);
+
 #ifdef SHOW_DISPLAY_GENERATION
         s_chGen++;
         if (s_chGen > 'Z')
@@ -1657,10 +1695,12 @@ void selectcomplete_impl::update_display()
             s.format("\x1b[%dA", up);
             m_printer->print(s.c_str(), s.length());
         }
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         m_mouse_offset = csbi.dwCursorPosition.Y + 1/*to top item*/;
         _rl_move_vert(vpos);
         _rl_last_c_pos = cpos;
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         restore.Y = csbi.dwCursorPosition.Y;
         SetConsoleCursorPosition(h, restore);
@@ -1882,12 +1922,6 @@ int selectcomplete_impl::get_match_row(int index) const
     return _rl_print_completions_horizontally ? (index / m_match_cols) : (index % m_match_rows);
 }
 
-//------------------------------------------------------------------------------
-bool selectcomplete_impl::use_display(bool append, match_type type, int index) const
-{
-    return m_matches.use_display(index, type, append);
-}
-
 //------------------------------------------------------------------------------
 void selectcomplete_impl::set_top(int top)
 {
@@ -1898,6 +1932,7 @@ void selectcomplete_impl::set_top(int top)
         m_top = top;
         m_prev_displayed = -1;
         m_comment_row_displayed = false;
+        m_scrolled = true;
     }
 }
 
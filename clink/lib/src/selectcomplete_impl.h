@@ -7,6 +7,7 @@
 #include "input_dispatcher.h"
 #include "match_adapter.h"
 #include "column_widths.h"
+#include "popup_row_cache.h"
 #include "scroll_helper.h"
 
 #include <core/str.h>
@@ -47,7 +48,6 @@ private:
     void            insert_match(int final=false);
     int             get_match_row(int index) const;
     int             get_longest_display() const;
-    bool            use_display(bool append, match_type type, int index) const;
     void            set_top(int top);
     void            reset_top();
 
@@ -79,6 +79,7 @@ private:
     bool            m_clear_display = false;
     bool            m_calc_widths = false;
     column_widths   m_widths;
+    popup_row_cache m_row_cache;
 
     // Inserting matches.
     int             m_anchor = -1;
@@ -91,6 +92,7 @@ private:
     int             m_top = 0;
     int             m_index = 0;
     int             m_prev_displayed = -1;
+    bool            m_scrolled = false;     // Only m_top changed since the last display.
 
     // Current input.
     str<>           m_needle;
@@ -9,6 +9,7 @@
 #include "line_buffer.h"
 
 #include <core/base.h>
+#include <core/perf_stats.h>
 #include <core/settings.h>
 #include <core/str_compare.h>
 #include <core/str_iter.h>
@@ -708,6 +709,7 @@ find:
             int move_count = (m_count - 1) - m_index;
             memmove(m_entries + m_index, m_entries + m_index + 1, move_count * sizeof(m_entries[0]));
             m_items.erase(m_items.begin() + m_index);
+            m_row_cache.clear();
             if (m_infos)
             {
                 memmove(m_infos + m_index, m_infos + m_index + 1, move_count * sizeof(m_infos[0]));
@@ -1202,6 +1204,7 @@ void textlist_impl::update_display()
         // consistent with Readline's view of the world.
         CONSOLE_SCREEN_BUFFER_INFO csbi;
         const HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         COORD restore = csbi.dwCursorPosition;
         const int vpos = _rl_last_v_pos;
@@ -1214,11 +1217,17 @@ void textlist_impl::update_display()
         // Display list.
         int up = 1;
         bool move_to_end = true;
+        unsigned int bytes = 0;
         const int count = m_count;
         if (m_active && count > 0)
         {
             update_top();
 
+            // Scrolling leaves the rows on the screen intact; anything else
+            // that forces a full redraw may have overwritten them.
+            if (m_prev_displayed < 0 && !m_scrolled)
+                m_row_cache.forget_screen();
+
             const bool draw_border = (m_prev_displayed < 0) || m_override_title.length() || m_has_override_title;
             m_has_override_title = !m_override_title.empty();
 
@@ -1259,6 +1268,7 @@ void textlist_impl::update_display()
             str<> noescape;
             str<> left;
             str<> horzline;
+            str<> row_bytes;
 
             {
                 int x = csbi.dwCursorPosition.X - ((col_width + 1) / 2);
@@ -1278,11 +1288,13 @@ void textlist_impl::update_display()
             {
                 make_horz_border(m_has_override_title ? m_override_title.c_str() : m_default_title.c_str(), col_width - 2, m_has_override_title, horzline,
                                  m_color.header.c_str(), m_color.border.c_str());
-                m_printer->print(left.c_str(), left.length());
-                m_printer->print(m_color.border.c_str(), m_color.border.length());
-                m_printer->print("\xe2\x94\x8c");                       // ┌
-                m_printer->print(horzline.c_str(), horzline.length());  // ─
-                m_printer->print("\xe2\x94\x90\x1b[m");                 // ┐
+                row_bytes.clear();
+                row_bytes << left << m_color.border;
+                row_bytes << "\xe2\x94\x8c";                            // ┌
+                row_bytes << horzline;                                  // ─
+                row_bytes << "\xe2\x94\x90\x1b[m";                      // ┐
+                m_printer->print(row_bytes.c_str(), row_bytes.length());
+                bytes += row_bytes.length();
             }
 
             // Display items.
@@ -1296,76 +1308,18 @@ void textlist_impl::update_display()
                 up++;
 
                 move_to_end = true;
-                if (m_prev_displayed < 0 ||
-                    i == m_index ||
-                    i == m_prev_displayed)
+                const popup_row_key key = { i, (i == m_index) ? i : -1, col_width, m_mouse_left, m_horz_offset };
+                if (!m_row_cache.is_displayed(row, key))
                 {
-                    m_printer->print(left.c_str(), left.length());
-                    m_printer->print(m_color.border.c_str(), m_color.border.length());
-                    m_printer->print("\xe2\x94\x82");               // │
-
-                    const str_base& maincolor = (i == m_index) ? m_color.select : m_color.items;
-                    m_printer->print(maincolor.c_str(), maincolor.length());
-
-                    int spaces = col_width - 2;
-
-                    if (m_show_numbers)
+                    const str_base* rendered = m_row_cache.find(key);
+                    if (!rendered)
                     {
-                        const int history_index = m_infos ? m_infos[i].index : i;
-                        const char ismark = (m_infos && m_infos[i].marked);
-                        const char mark = ismark ? '*' : ' ';
-                        const char* color = !ismark ? "" : (i == m_index) ? m_color.selectmark.c_str() : m_color.mark.c_str();
-                        const char* uncolor = !ismark ? "" : (i == m_index) ? m_color.select.c_str() : m_color.items.c_str();
-                        tmp.clear();
-                        tmp.format("%*u:%s%c", m_max_num_len, history_index + 1, color, mark);
-                        m_printer->print(tmp.c_str(), tmp.length());// history number
-                        spaces -= cell_count(tmp.c_str());
+                        make_row(i, col_width, left, row_bytes);
+                        rendered = &m_row_cache.store(key, row_bytes.c_str(), row_bytes.length());
                     }
-
-                    int cell_len;
-                    int offset = m_horz_offset;
-                    const int char_len = limit_cells(m_items[i], spaces, cell_len, &offset);
-                    m_printer->print(m_items[i] + offset, char_len);// main text
-                    spaces -= cell_len;
-
-                    if (m_has_columns)
-                    {
-                        assert(!m_horz_scrolling); // Columns are incompatible with m_horz_offset.
-
-                        const str_base& desc_color = (i == m_index) ? m_color.selectdesc : m_color.desc;
-                        m_printer->print(desc_color.c_str(), desc_color.length());
-
-                        if (m_columns.get_any_tabs())
-                        {
-                            make_spaces(min<int>(spaces, m_longest - cell_len), tmp);
-                            m_printer->print(tmp.c_str(), tmp.length()); // spaces
-                            spaces -= tmp.length();
-                        }
-
-                        for (int col = 0; col < max_columns && spaces > 0; col++)
-                        {
-                            tmp.clear();
-                            tmp.concat("  ", 2);
-                            tmp.concat(m_columns.get_col_text(i, col));
-                            const int col_len = limit_cells(tmp.c_str(), spaces, cell_len);
-                            m_printer->print(tmp.c_str(), col_len); // column text
-                            spaces -= cell_len;
-
-                            int pad = min<int>(spaces, m_columns.get_col_width(col) - (cell_len - 2));
-                            if (pad > 0)
-                            {
-                                make_spaces(pad, tmp);
-                                m_printer->print(tmp.c_str(), tmp.length()); // spaces
-                                spaces -= tmp.length();
-                            }
-                        }
-                    }
-
-                    make_spaces(spaces, tmp);
-                    m_printer->print(tmp.c_str(), tmp.length());    // spaces
-
-                    m_printer->print(m_color.border.c_str(), m_color.border.length());
-                    m_printer->print("\xe2\x94\x82\x1b[m");         // │
+                    m_printer->print(rendered->c_str(), rendered->length());
+                    m_row_cache.set_displayed(row, key);
+                    bytes += rendered->length();
                 }
             }
 
@@ -1376,11 +1330,13 @@ void textlist_impl::update_display()
                 up++;
                 const bool show_del = (m_history_mode || m_mode == textlist_mode::directories || m_del_callback);
                 make_horz_border(show_del ? "Del=Delete" : nullptr, col_width - 2, true/*bars*/, horzline, m_color.footer.c_str(), m_color.border.c_str());
-                m_printer->print(left.c_str(), left.length());
-                m_printer->print(m_color.border.c_str(), m_color.border.length());
-                m_printer->print("\xe2\x94\x94");                       // └
-                m_printer->print(horzline.c_str(), horzline.length());  // ─
-                m_printer->print("\xe2\x94\x98\x1b[m");                 // ┘
+                row_bytes.clear();
+                row_bytes << left << m_color.border;
+                row_bytes << "\xe2\x94\x94";                            // └
+                row_bytes << horzline;                                  // ─
+                row_bytes << "\xe2\x94\x98\x1b[m";                      // ┘
+                m_printer->print(row_bytes.c_str(), row_bytes.length());
+                bytes += row_bytes.length();
             }
 
             if (m_force_clear)
@@ -1394,9 +1350,12 @@ void textlist_impl::update_display()
             m_printer->print("\x1b[m\x1b[J");
 
             m_prev_displayed = -1;
+            m_row_cache.clear();
         }
 
         m_force_clear = false;
+        m_scrolled = false;
+        perf_stats_record_popup_bytes(bytes);
 
         // Restore cursor position.
         if (up > 0)
@@ -1405,16 +1364,90 @@ void textlist_impl::update_display()
             s.format("\x1b[%dA", up);
             m_printer->print(s.c_str(), s.length());
         }
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         m_mouse_offset = csbi.dwCursorPosition.Y + 1/*to border*/ + 1/*to top item*/;
         _rl_move_vert(vpos);
         _rl_last_c_pos = cpos;
+        m_printer->flush_frame();
         GetConsoleScreenBufferInfo(h, &csbi);
         restore.Y = csbi.dwCursorPosition.Y;
         SetConsoleCursorPosition(h, restore);
     }
 }
 
+//------------------------------------------------------------------------------
+void textlist_impl::make_row(int i, int col_width, const str_base& left, str_base& out)
+{
+    str<> tmp;
+
+    out.clear();
+    out.concat(left.c_str(), left.length());
+    out.concat(m_color.border.c_str(), m_color.border.length());
+    out.concat("\xe2\x94\x82");                            // │
+
+    const str_base& maincolor = (i == m_index) ? m_color.select : m_color.items;
+    out.concat(maincolor.c_str(), maincolor.length());
+
+    int spaces = col_width - 2;
+
+    if (m_show_numbers)
+    {
+        const int history_index = m_infos ? m_infos[i].index : i;
+        const char ismark = (m_infos && m_infos[i].marked);
+        const char mark = ismark ? '*' : ' ';
+        const char* color = !ismark ? "" : (i == m_index) ? m_color.selectmark.c_str() : m_color.mark.c_str();
+        tmp.format("%*u:%s%c", m_max_num_len, history_index + 1, color, mark);
+        out.concat(tmp.c_str(), tmp.length());              // history number
+        spaces -= cell_count(tmp.c_str());
+    }
+
+    int cell_len;
+    int offset = m_horz_offset;
+    const int char_len = limit_cells(m_items[i], spaces, cell_len, &offset);
+    out.concat(m_items[i] + offset, char_len);              // main text
+    spaces -= cell_len;
+
+    if (m_has_columns)
+    {
+        assert(!m_horz_scrolling); // Columns are incompatible with m_horz_offset.
+
+        const str_base& desc_color = (i == m_index) ? m_color.selectdesc : m_color.desc;
+        out.concat(desc_color.c_str(), desc_color.length());
+
+        if (m_columns.get_any_tabs())
+        {
+            make_spaces(min<int>(spaces, m_longest - cell_len), tmp);
+            out.concat(tmp.c_str(), tmp.length());          // spaces
+            spaces -= tmp.length();
+        }
+
+        for (int col = 0; col < max_columns && spaces > 0; col++)
+        {
+            tmp.clear();
+            tmp.concat("  ", 2);
+            tmp.concat(m_columns.get_col_text(i, col));
+            const int col_len = limit_cells(tmp.c_str(), spaces, cell_len);
+            out.concat(tmp.c_str(), col_len);               // column text
+            spaces -= cell_len;
+
+            int pad = min<int>(spaces, m_columns.get_col_width(col) - (cell_len - 2));
+            if (pad > 0)
+            {
+                make_spaces(pad, tmp);
+                out.concat(tmp.c_str(), tmp.length());      // spaces
+                spaces -= tmp.length();
+            }
+        }
+    }
+
+    make_spaces(spaces, tmp);
+    out.concat(tmp.c_str(), tmp.length());                  // spaces
+
+    out.concat(m_color.border.c_str(), m_color.border.length());
+    out.concat("\xe2\x94\x82\x1b[m");                       // │
+}
+
 //------------------------------------------------------------------------------
 void textlist_impl::set_top(int top)
 {
@@ -1424,6 +1457,7 @@ void textlist_impl::set_top(int top)
     {
         m_top = top;
         m_prev_displayed = -1;
+        m_scrolled = true;
     }
 }
 
@@ -1529,6 +1563,8 @@ void textlist_impl::reset()
     m_top = 0;
     m_index = 0;
     m_prev_displayed = -1;
+    m_scrolled = false;
+    m_row_cache.clear();
 
     m_needle.clear();
     m_needle_is_number = false;
@@ -6,6 +6,7 @@
 #include "editor_module.h"
 #include "input_dispatcher.h"
 #include "popup.h"
+#include "popup_row_cache.h"
 #include "scroll_helper.h"
 
 #include <core/str.h>
@@ -76,6 +77,7 @@ private:
     void            update_layout();
     void            update_top();
     void            update_display();
+    void            make_row(int i, int col_width, const str_base& left, str_base& out);
     void            set_top(int top);
     void            adjust_horz_offset(int delta);
     void            init_colors(const popup_config* config);
@@ -107,6 +109,7 @@ private:
     str<32>         m_override_title;
     bool            m_has_override_title = false;
     bool            m_force_clear = false;
+    popup_row_cache m_row_cache;
 
     // Entries.
     int             m_count = 0;
@@ -120,6 +123,7 @@ private:
     int             m_top = 0;
     int             m_index = 0;
     int             m_prev_displayed = -1;
+    bool            m_scrolled = false;     // Only m_top changed since the last display.
 
     // Current input.
     str<16>         m_needle;
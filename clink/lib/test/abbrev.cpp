@@ -163,6 +163,51 @@ TEST_CASE("Abbreviated paths.")
             }
         }
 
+        SECTION("Cached")
+        {
+            os::abbreviated_path_cache_scope abbrev_cache;
+
+            for (int pass = 2; pass--;)
+            {
+                for (auto const& t : c_testcases)
+                {
+                    const char* in = t.in;
+                    const bool unique = os::disambiguate_abbreviated_path(in, out);
+                    REQUIRE(unique == t.unique);
+                    REQUIRE(strcmp(in, t.remaining) == 0);
+                    REQUIRE(out.equals(t.expanded));
+                }
+            }
+
+            // Components also match 8.3 names, when the volume has them.
+            wchar_t short_path[MAX_PATH];
+            if (GetShortPathNameW(L"xyz\\bookkeeping", short_path, sizeof_array(short_path)) &&
+                _wcsicmp(short_path, L"xyz\\bookkeeping") != 0)
+            {
+                str<> short_name(short_path + 4);
+                str<> short_in;
+                short_in << "x/" << short_name.c_str() << "/l";
+                for (int pass = 2; pass--;)
+                {
+                    const char* in = short_in.c_str();
+                    REQUIRE(os::disambiguate_abbreviated_path(in, out));
+                    REQUIRE(strcmp(in, "/l") == 0);
+                    REQUIRE(out.equals("xyz\\bookkeeping"));
+                }
+            }
+
+            // Adding a directory invalidates the cached listing.
+            REQUIRE(os::make_dir("xyz/boxer"));
+
+            const char* in = "x/boxe/l";
+            const bool unique = os::disambiguate_abbreviated_path(in, out);
+            REQUIRE(!unique);
+            REQUIRE(strcmp(in, "/l") == 0);
+            REQUIRE(out.equals("xyz\\boxe"));
+
+            REQUIRE(os::remove_dir("xyz/boxer"));
+        }
+
         for (int pass = 2; pass--;)
         {
             SECTION(pass ? "Absolute" : "Drive")
@@ -0,0 +1,66 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "column_widths.h"
+
+#include <core/base.h>
+
+//------------------------------------------------------------------------------
+static void make_lens(unsigned int count, unsigned int seed, unsigned int spread, std::vector<width_t>& out)
+{
+    out.clear();
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        seed = seed * 1103515245 + 12345;
+        out.push_back(width_t(1 + (seed >> 16) % spread));
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Column fitting")
+{
+    std::vector<width_t> lens;
+    std::vector<width_t> triangle;
+    std::vector<width_t> ranges;
+
+    SECTION("Same as triangle")
+    {
+        static const unsigned int counts[] = { 1, 2, 7, 40, 333, 1000 };
+        static const unsigned int spreads[] = { 1, 8, 30, 90 };
+        for (unsigned int count : counts)
+        {
+            for (unsigned int spread : spreads)
+            {
+                make_lens(count, count + spread, spread, lens);
+                for (int vertical = 0; vertical < 2; ++vertical)
+                {
+                    const size_t max_cols = min<size_t>(count, 40);
+                    const size_t t = fit_columns_triangle(lens, max_cols, 2, 120, !!vertical, triangle);
+                    const size_t r = fit_columns_ranges(lens, max_cols, 2, 120, !!vertical, ranges);
+                    REQUIRE(t == r, [&] () {
+                        printf("count %u, spread %u, vertical %d\n", count, spread, vertical);
+                    });
+                    REQUIRE(triangle == ranges);
+                }
+            }
+        }
+    }
+
+    SECTION("Wide screen")
+    {
+        // More than the triangle's limit of 50 columns.
+        make_lens(1000, 1, 4, lens);
+        const size_t cols = fit_columns_ranges(lens, 200, 2, 1000, true, ranges);
+        REQUIRE(cols > 50);
+        REQUIRE(ranges.size() == cols);
+    }
+
+    SECTION("Nothing fits")
+    {
+        lens.clear();
+        lens.push_back(200);
+        REQUIRE(fit_columns_ranges(lens, 1, 2, 80, true, ranges) == 0);
+        REQUIRE(fit_columns_triangle(lens, 1, 2, 80, true, triangle) == 0);
+    }
+}
@@ -0,0 +1,142 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "fs_fixture.h"
+
+#include <lib/matches.h>
+#include <lib/matches_lookaside.h>
+#include <lib/display_matches.h>
+#include <matches_impl.h>
+#include <match_adapter.h>
+
+extern "C" {
+#include <readline/readline.h>
+#include <readline/rlprivate.h>
+};
+
+//------------------------------------------------------------------------------
+TEST_CASE("Match file info : resolve types")
+{
+    fs_fixture fs;
+
+    matches_impl matches;
+    match_builder builder(matches);
+
+    match_file_info dir_info = {};
+    dir_info.attr = FILE_ATTRIBUTE_DIRECTORY;
+    match_file_info file_info = {};
+    file_info.attr = FILE_ATTRIBUTE_NORMAL;
+    file_info.size = 1234;
+    file_info.mtime = 5678;
+
+    SECTION("With file info")
+    {
+        // Neither exists on disk, so only the file info can say what they are.
+        match_desc dir_desc("ghostdir", nullptr, nullptr, match_type::none);
+        dir_desc.file_info = &dir_info;
+        match_desc file_desc("ghostfile", nullptr, nullptr, match_type::none);
+        file_desc.file_info = &file_info;
+        REQUIRE(builder.add_match(dir_desc));
+        REQUIRE(builder.add_match(file_desc));
+
+        matches.done_building();
+
+        REQUIRE(matches.get_match_count() == 2);
+        REQUIRE(is_match_type(matches.get_match_type(0), match_type::dir));
+        REQUIRE(strcmp(matches.get_match(0), "ghostdir\\") == 0);
+        REQUIRE(is_match_type(matches.get_match_type(1), match_type::file));
+
+        const match_file_info* info = matches.get_match_file_info(1);
+        REQUIRE(info);
+        REQUIRE(info->size == 1234);
+        REQUIRE(info->mtime == 5678);
+    }
+
+    SECTION("Without file info")
+    {
+        REQUIRE(builder.add_match("dir1", match_type::none));
+        REQUIRE(builder.add_match("file1", match_type::none));
+
+        matches.done_building();
+
+        REQUIRE(is_match_type(matches.get_match_type(0), match_type::dir));
+        REQUIRE(is_match_type(matches.get_match_type(1), match_type::file));
+        REQUIRE(!matches.get_match_file_info(1));
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Match file info : packed format")
+{
+    match_file_info file_info = {};
+    file_info.attr = FILE_ATTRIBUTE_READONLY;
+    file_info.size = 42;
+    file_info.mtime = 1000;
+
+    const size_t packed_size = calc_packed_size("abc", "abc", "desc", &file_info);
+    char* buffer = static_cast<char*>(malloc(packed_size));
+    REQUIRE(pack_match(buffer, packed_size, "abc", match_type::file, "abc", "desc", 0, 0, nullptr, false, false, &file_info));
+
+    match_file_info out = {};
+    REQUIRE(get_packed_match_file_info(buffer, out));
+    REQUIRE(out.attr == FILE_ATTRIBUTE_READONLY);
+    REQUIRE(out.size == 42);
+    REQUIRE(out.mtime == 1000);
+
+    free(buffer);
+
+    const size_t plain_size = calc_packed_size("abc", "abc", "desc");
+    buffer = static_cast<char*>(malloc(plain_size));
+    REQUIRE(pack_match(buffer, plain_size, "abc", match_type::file, "abc", "desc", 0, 0, nullptr, false));
+    REQUIRE(!get_packed_match_file_info(buffer, out));
+
+    free(buffer);
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Match file info : display")
+{
+    fs_fixture fs;
+
+    rollback<int> rb_fdd(rl_filename_display_desired, 1);
+    rollback<int> rb_cmd(_rl_complete_mark_directories, 1);
+
+    matches_impl matches;
+    match_builder builder(matches);
+
+    // Neither exists on disk, so displaying them can only mark "ghost" as a
+    // directory by using its file info instead of stat'ing it.
+    match_file_info dir_info = {};
+    dir_info.attr = FILE_ATTRIBUTE_DIRECTORY|FILE_ATTRIBUTE_HIDDEN;
+    match_desc dir_desc("ghost", nullptr, nullptr, match_type::none);
+    dir_desc.file_info = &dir_info;
+    REQUIRE(builder.add_match(dir_desc));
+    REQUIRE(builder.add_match("phantom", match_type::none));
+
+    match_adapter adapter;
+    adapter.set_matches(&matches);
+    REQUIRE(adapter.get_match_count() == 2);
+
+    const match_render_info& ghost = adapter.get_render_info(0);
+    REQUIRE(is_match_type(ghost.type, match_type::dir));
+    REQUIRE(is_match_type_hidden(ghost.type));
+
+    const match_render_info& phantom = adapter.get_render_info(1);
+    REQUIRE(is_match_type(phantom.type, match_type::none));
+
+    str<> tmp;
+    int vis_stat_char;
+
+    tmp = adapter.get_match(0);
+    vis_stat_char = 0;
+    reset_tmpbuf();
+    append_filename(tmp.data(), tmp.c_str(), 0, 0, ghost.type, 0, &vis_stat_char);
+    REQUIRE(vis_stat_char == '\\');
+
+    tmp = adapter.get_match(1);
+    vis_stat_char = 0;
+    reset_tmpbuf();
+    append_filename(tmp.data(), tmp.c_str(), 0, 0, phantom.type, 0, &vis_stat_char);
+    REQUIRE(vis_stat_char == 0);
+}
@@ -0,0 +1,57 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <lib/matches_lookaside.h>
+
+//------------------------------------------------------------------------------
+static char* make_packed(const char* match, match_type type, const char* display)
+{
+    const size_t packed_size = calc_packed_size(match, display, nullptr);
+    char* buffer = static_cast<char*>(malloc(packed_size));
+    REQUIRE(pack_match(buffer, packed_size, match, type, display, nullptr, 0, 0, nullptr, false));
+    return buffer;
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Matches lookaside")
+{
+    char* matches[] = {
+        nullptr,
+        make_packed("abc", match_type::file, "ABC"),
+        make_packed("def", match_type::dir, "DEF"),
+        make_packed("ghi", match_type::word, "GHI"),
+        nullptr,
+    };
+
+    REQUIRE(create_matches_lookaside(matches));
+
+    SECTION("By index")
+    {
+        REQUIRE(lookup_match_at(matches, 1).get_type() == match_type::file);
+        REQUIRE(lookup_match_at(matches, 2).get_type() == match_type::dir);
+        REQUIRE(strcmp(lookup_match_at(matches, 3).get_display(), "GHI") == 0);
+    }
+
+    SECTION("By pointer")
+    {
+        REQUIRE(lookup_match(matches[3]).get_type() == match_type::word);
+        REQUIRE(strcmp(lookup_match(matches[1]).get_display(), "ABC") == 0);
+    }
+
+    SECTION("Reordered")
+    {
+        // Readline can sort the array in place.
+        std::swap(matches[1], matches[3]);
+        REQUIRE(lookup_match_at(matches, 1).get_type() == match_type::word);
+        REQUIRE(lookup_match_at(matches, 3).get_type() == match_type::file);
+        REQUIRE(strcmp(lookup_match_at(matches, 3).get_display(), "ABC") == 0);
+        std::swap(matches[1], matches[3]);
+    }
+
+    REQUIRE(destroy_matches_lookaside(matches));
+
+    for (int i = 1; matches[i]; ++i)
+        free(matches[i]);
+}
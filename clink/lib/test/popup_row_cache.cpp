@@ -0,0 +1,68 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "popup_row_cache.h"
+
+//------------------------------------------------------------------------------
+TEST_CASE("Popup row cache")
+{
+    popup_row_cache cache;
+
+    const popup_row_key a = { 0, -1, 40, 10, 0 };
+    const popup_row_key a_selected = { 0, 0, 40, 10, 0 };
+    const popup_row_key b = { 1, -1, 40, 10, 0 };
+
+    SECTION("Displayed")
+    {
+        REQUIRE(!cache.is_displayed(0, a));
+
+        cache.set_displayed(2, b);
+        REQUIRE(cache.is_displayed(2, b));
+        REQUIRE(!cache.is_displayed(0, a));
+        REQUIRE(!cache.is_displayed(2, a));
+
+        // Selecting the item changes the key.
+        cache.set_displayed(0, a);
+        REQUIRE(cache.is_displayed(0, a));
+        REQUIRE(!cache.is_displayed(0, a_selected));
+
+        cache.forget_screen();
+        REQUIRE(!cache.is_displayed(0, a));
+        REQUIRE(!cache.is_displayed(2, b));
+    }
+
+    SECTION("Rendered")
+    {
+        REQUIRE(!cache.find(a));
+
+        cache.store(a, "abc", 3);
+        cache.store(b, "xyz", 3);
+        REQUIRE(cache.find(a));
+        REQUIRE(cache.find(a)->equals("abc"));
+        REQUIRE(cache.find(b)->equals("xyz"));
+        REQUIRE(!cache.find(a_selected));
+
+        // Forgetting the screen keeps rendered rows for reuse.
+        cache.forget_screen();
+        REQUIRE(cache.find(a));
+
+        cache.clear();
+        REQUIRE(!cache.find(a));
+        REQUIRE(!cache.find(b));
+    }
+
+    SECTION("Evict")
+    {
+        for (int i = 0; i < 1000; ++i)
+        {
+            const popup_row_key key = { i, -1, 40, 0, 0 };
+            cache.store(key, "row", 3);
+        }
+
+        const popup_row_key first = { 0, -1, 40, 0, 0 };
+        const popup_row_key last = { 999, -1, 40, 0, 0 };
+        REQUIRE(!cache.find(first));
+        REQUIRE(cache.find(last));
+    }
+}
@@ -0,0 +1,106 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <core/str.h>
+#include <core/linear_allocator.h>
+
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+//------------------------------------------------------------------------------
+// Immutable list of executable names, sorted so that the names starting with
+// a prefix form one contiguous range.  Names compare case insensitively, and
+// '-' compares equal to '_', so a range is a superset of what any of the
+// completion case mapping modes can match.
+class exec_catalog_snapshot
+{
+public:
+    struct entry
+    {
+        const char*     name;
+        unsigned int    attr;       // FILE_ATTRIBUTE_HIDDEN, _READONLY, _SYSTEM.
+    };
+
+                        exec_catalog_snapshot() : m_store(8192) {}
+    unsigned int        size() const { return unsigned(m_entries.size()); }
+    const entry&        operator [] (unsigned int index) const { return m_entries[index]; }
+    void                find_range(const char* prefix, unsigned int& begin, unsigned int& end) const;
+
+private:
+    friend class exec_catalog;
+    linear_allocator    m_store;
+    std::vector<entry>  m_entries;
+};
+
+//------------------------------------------------------------------------------
+// Index of the executables in the directories listed in PATH.  Completing a
+// command name is then a range query, instead of enumerating every directory
+// in PATH once per extension in PATHEXT.
+//
+// The index is persisted in the profile directory.  A background thread scans
+// directories that aren't in the index yet, and rescans a directory when its
+// timestamp changes (which happens when files are added, removed, or renamed).
+class exec_catalog
+{
+    struct file_entry
+    {
+        str_moveable        name;
+        unsigned int        attr;
+    };
+
+    struct dir_entry
+    {
+        str_moveable        dir;
+        unsigned long long  mtime;
+        std::vector<file_entry> files;
+        bool                scanned;            // False until the first scan.
+    };
+
+public:
+                        exec_catalog(const char* file=nullptr);
+                        ~exec_catalog();
+    void                shutdown();
+
+    // Returns null if PATH can't be served from the index yet (e.g. while the
+    // first scan is still running, or if PATH has relative directories).  Each
+    // call also starts a background check for directories that have changed.
+    std::shared_ptr<const exec_catalog_snapshot> get(const char* path, const char* pathext);
+
+    bool                wait(unsigned int timeout); // Waits until idle; for tests.
+
+    static exec_catalog& get_instance();
+
+private:
+    bool                configure(const char* path, const char* pathext);
+    void                kick();
+    void                load();
+    void                format(str_base& out) const;
+    static void         save(const char* file, const str_base& data);
+    void                rebuild();
+    dir_entry*          find_dir(const char* dir);
+    static bool         scan(const char* dir, const std::vector<str_moveable>& exts, std::vector<file_entry>& out);
+    static void         proc(exec_catalog* c);
+
+    mutable std::recursive_mutex m_mutex;
+    std::unique_ptr<std::thread> m_thread;
+    HANDLE              m_event = nullptr;      // Work to do.
+    HANDLE              m_idle_event = nullptr; // No work in progress.
+    str_moveable        m_file;
+    str_moveable        m_path;
+    str_moveable        m_pathext;
+    std::vector<str_moveable> m_exts;
+    std::vector<dir_entry> m_dirs;              // In PATH order.
+    unsigned int        m_generation = 0;       // Incremented when PATHEXT changes.
+    std::shared_ptr<const exec_catalog_snapshot> m_snapshot;
+    bool                m_usable = false;       // PATH has only absolute dirs.
+    bool                m_loaded = false;
+    bool                m_pending = false;
+    volatile bool       m_zombie = false;
+};
+
+//------------------------------------------------------------------------------
+void shutdown_exec_catalog();
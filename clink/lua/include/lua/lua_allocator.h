@@ -0,0 +1,91 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+#include <stddef.h>
+
+//------------------------------------------------------------------------------
+// What Lua is doing on behalf of Clink when it allocates memory.
+enum class lua_mem_tag : unsigned char
+{
+    other,
+    prompt_filter,
+    generate,
+    classify,
+    coroutine,
+    max
+};
+
+//------------------------------------------------------------------------------
+// Attributes allocations made by Lua in the enclosing scope to a tag.
+class lua_mem_tag_scope
+{
+public:
+                    lua_mem_tag_scope(lua_mem_tag tag);
+                    ~lua_mem_tag_scope();
+private:
+    lua_mem_tag     m_prev;
+};
+
+//------------------------------------------------------------------------------
+struct lua_alloc_stats
+{
+    size_t              in_use;             // Bytes requested by live blocks.
+    size_t              large_in_use;       // Bytes in blocks too big to pool.
+    size_t              slab_bytes;         // Bytes reserved by slab pages.
+    size_t              free_bytes;         // Bytes on the free lists.
+    unsigned long long  allocs[int(lua_mem_tag::max)];
+    unsigned long long  bytes[int(lua_mem_tag::max)];
+};
+
+//------------------------------------------------------------------------------
+// lua_Alloc implementation for Lua states.  Small blocks come from size class
+// free lists carved out of slab pages, so the many short lived strings, tables
+// and closures Lua creates avoid the CRT heap.  Freed blocks are reused but
+// slab pages are only released when the allocator is destroyed, after the
+// Lua state has been closed.
+//
+// Lua states are only used from the main thread, so it isn't thread safe.
+class lua_allocator
+{
+public:
+                    lua_allocator();
+                    ~lua_allocator();
+
+    static void*    alloc(void* ud, void* ptr, size_t osize, size_t nsize);
+
+    void            get_stats(lua_alloc_stats& out) const;
+    size_t          get_allocated_since_gc() const { return m_allocated_since_gc; }
+    void            reset_allocated_since_gc() { m_allocated_since_gc = 0; }
+
+    static const char* get_tag_name(lua_mem_tag tag);
+    static lua_allocator* get_active();     // Most recently created one still alive.
+
+private:
+    enum : size_t
+    {
+        granularity = 16,
+        max_pooled  = 256,
+        num_classes = max_pooled / granularity,
+        slab_size   = 64 * 1024,
+    };
+
+    struct free_block { free_block* next; };
+
+    static unsigned int size_class(size_t size) { return unsigned((size + granularity - 1) / granularity) - 1; }
+    void*           alloc_block(size_t size);
+    void            free_block_(void* ptr, size_t size);
+    void*           realloc_block(void* ptr, size_t osize, size_t nsize);
+    void            account_alloc(size_t size);
+
+    free_block*     m_free[num_classes] = {};
+    char*           m_slab = nullptr;           // Newest slab; each starts with a link to the previous one.
+    size_t          m_slab_used = 0;
+    lua_alloc_stats m_stats = {};
+    size_t          m_allocated_since_gc = 0;
+    lua_allocator*  m_next = nullptr;
+};
+
+//------------------------------------------------------------------------------
+void lua_memory_diagnostics();
@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <list>
+#include <memory>
 
 extern "C" {
 #include <readline/readline.h>
@@ -14,6 +15,7 @@ extern "C" {
 }
 
 struct lua_State;
+class lua_allocator;
 class str_base;
 class line_state;
 typedef double lua_Number;
@@ -40,6 +42,8 @@ public:
     bool            do_string(const char* string, int length=-1);
     bool            do_file(const char* path);
     lua_State*      get_state() const;
+    bool            has_idle_gc_work() const;
+    void            idle_gc_step();
 
     static bool     push_named_function(lua_State* L, const char* func_name, str_base* error=nullptr);
 
@@ -64,6 +68,7 @@ public:
 private:
     bool            send_event_internal(const char* event_name, const char* event_mechanism, int nargs=0, int nret=0);
     lua_State*      m_state;
+    std::unique_ptr<lua_allocator> m_allocator;
 
     static bool     s_in_luafunc;
 };
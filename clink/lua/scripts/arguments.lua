@@ -26,9 +26,20 @@ local _delayinit_generation = 0
 local _clear_onuse_coroutine = {}
 local _clear_delayinit_coroutine = {}
 
+--------------------------------------------------------------------------------
+local _parse_cache = setmetatable({}, { __mode = "k" })
+
+--------------------------------------------------------------------------------
+local function clear_parse_cache()
+    if next(_parse_cache) then
+        _parse_cache = setmetatable({}, { __mode = "k" })
+    end
+end
+
 --------------------------------------------------------------------------------
 clink.onbeginedit(function ()
     _delayinit_generation = _delayinit_generation + 1
+    clear_parse_cache()
 
     -- Clear dangling coroutine references in matchers.  Otherwise if a
     -- coroutine doesn't finish before a new edit line begins, there will be
@@ -89,6 +100,179 @@ function _argreader:starttracing(word)
 end
 --]]
 
+--------------------------------------------------------------------------------
+-- Parsing a command line replays _argreader:update() over every word, once to
+-- classify the line and again to generate matches, and again after the next
+-- keystroke.  So the reader's state after each word is cached per argmatcher,
+-- and parsing resumes from the last word whose cached state is still valid.
+--
+-- update() peeks at the start of the following word, so the state after a word
+-- is valid as long as the line is unchanged through the first character of the
+-- following word (and the cursor is beyond that).  Nothing is cached from the
+-- first word that runs script callbacks (onarg or classifier functions) or that
+-- is waiting on delayinit.  Classifications applied while parsing a word are
+-- recorded so they can be replayed when classifying.
+
+--------------------------------------------------------------------------------
+local function common_prefix_len(a, b)
+    local hi = math.min(#a, #b)
+    if a:sub(1, hi) == b:sub(1, hi) then
+        return hi
+    end
+    local lo = 0
+    while hi - lo > 1 do
+        local mid = math.floor((lo + hi) / 2)
+        if a:sub(1, mid) == b:sub(1, mid) then
+            lo = mid
+        else
+            hi = mid
+        end
+    end
+    return lo
+end
+
+--------------------------------------------------------------------------------
+function _argreader:_snapshot()
+    local stack = {}
+    for i, s in ipairs(self._stack) do
+        stack[i] = s
+    end
+    return {
+        matcher = self._matcher,
+        realmatcher = self._realmatcher,
+        arg_index = self._arg_index,
+        noflags = self._noflags,
+        phantomposition = self._phantomposition,
+        stack = stack,
+        user_data = self._user_data,
+    }
+end
+
+--------------------------------------------------------------------------------
+function _argreader:_restore(state)
+    -- Only onarg callbacks can have put anything in user data while parsing,
+    -- and those words are never cached.  But match generation may have used
+    -- the tables since then, so give each one a fresh (shared as before) table.
+    local fresh = {}
+    local function renew(t)
+        if t then
+            local n = fresh[t]
+            if not n then
+                n = {}
+                fresh[t] = n
+            end
+            return n
+        end
+    end
+
+    local stack = {}
+    for i, s in ipairs(state.stack) do
+        stack[i] = { s[1], s[2], s[3], s[4], renew(s[5]) }
+    end
+
+    self._matcher = state.matcher
+    self._realmatcher = state.realmatcher
+    self._arg_index = state.arg_index
+    self._noflags = state.noflags
+    self._phantomposition = state.phantomposition
+    self._stack = stack
+    self._user_data = renew(state.user_data)
+end
+
+--------------------------------------------------------------------------------
+function _argreader:_classifyword(word_index, t, overwrite)
+    self._word_classifier:classifyword(word_index, t, overwrite)
+    if self._classes then
+        table.insert(self._classes, { word_index, t, overwrite })
+    end
+end
+
+--------------------------------------------------------------------------------
+function _argreader:_applycolor(pos, len, color)
+    self._word_classifier:applycolor(pos, len, color)
+    if self._classes then
+        table.insert(self._classes, { pos, len, color, apply=true })
+    end
+end
+
+--------------------------------------------------------------------------------
+-- Restores the reader from the parse cache as far as the line allows, and
+-- returns the index of the next word to parse.
+function _argreader:_resume(first_word_index)
+    if self._nocache then
+        return first_word_index
+    end
+
+    local line_state = self._line_state
+    local line = line_state:getline()
+    local command_word_index = line_state:getcommandwordindex()
+
+    local entry = _parse_cache[self._matcher]
+    if not entry or entry.command_word_index ~= command_word_index then
+        entry = { command_word_index=command_word_index, line=line, steps={} }
+        _parse_cache[self._matcher] = entry
+    end
+
+    local valid = math.min(common_prefix_len(entry.line, line), line_state:getcursor() - 1)
+    local classifier = self._word_classifier
+    local steps = entry.steps
+    local num = 0
+    while steps[num + 1] and steps[num + 1].keylen <= valid and (steps[num + 1].classes or not classifier) do
+        num = num + 1
+    end
+    for i = #steps, num + 1, -1 do
+        steps[i] = nil
+    end
+
+    entry.line = line
+    entry.owner = self
+    self._cache = entry
+    self._classes = classifier and {} or nil
+
+    if num <= 0 then
+        return first_word_index
+    end
+
+    if classifier then
+        for i = 1, num do
+            for _, c in ipairs(steps[i].classes) do
+                if c.apply then
+                    classifier:applycolor(c[1], c[2], c[3])
+                else
+                    classifier:classifyword(c[1], c[2], c[3])
+                end
+            end
+        end
+    end
+
+    self:_restore(steps[num].state)
+    return steps[num].next_word_index
+end
+
+--------------------------------------------------------------------------------
+-- Caches the reader's state after parsing the word at word_index.
+function _argreader:_endstep(word_index)
+    local entry = self._cache
+    if not entry then
+        return
+    end
+
+    local info = self._line_state:getwordinfo(word_index + 1)
+    if self._nocache or entry.owner ~= self or not info then
+        self._cache = nil
+        self._classes = nil
+        return
+    end
+
+    table.insert(entry.steps, {
+        keylen = info.offset,
+        next_word_index = word_index + 1,
+        state = self:_snapshot(),
+        classes = self._classes,
+    })
+    self._classes = self._word_classifier and {} or nil
+end
+
 --------------------------------------------------------------------------------
 local function do_delayed_init(list, matcher, arg_index)
     -- Don't init while generating matches from history, as that could be
@@ -125,6 +309,7 @@ local function do_delayed_init(list, matcher, arg_index)
             -- slot's list of matches.
             local addees = list.delayinit(matcher, arg_index)
             matcher:_add(list, addees)
+            clear_parse_cache()
             -- Mark the init callback as finished.
             local mic = matcher._init_coroutine
             if mic then -- Avoid error if argmatcher was reset in the meantime.
@@ -291,9 +476,15 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
             if arg then
                 if arg.delayinit then
                     do_delayed_init(arg, matcher, 0)
+                    if arg.delayinit then
+                        self._nocache = true
+                    end
                 end
-                if arg.onarg and clink._in_generate() then
-                    arg.onarg(0, word, word_index, line_state, self._user_data)
+                if arg.onarg then
+                    self._nocache = true
+                    if clink._in_generate() then
+                        arg.onarg(0, word, word_index, line_state, self._user_data)
+                    end
                 end
             end
             if word == matcher._endofflags then
@@ -379,9 +570,9 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
         end
         if self._word_classifier and word_index >= 0 then
             if matcher._no_file_generation then
-                self._word_classifier:classifyword(word_index, "n", false)  --none
+                self:_classifyword(word_index, "n", false)  --none
             else
-                self._word_classifier:classifyword(word_index, "o", false)  --other
+                self:_classifyword(word_index, "o", false)  --other
             end
         end
         return
@@ -391,9 +582,15 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
     if not is_flag then
         if arg.delayinit then
             do_delayed_init(arg, realmatcher, arg_index)
+            if arg.delayinit then
+                self._nocache = true
+            end
         end
-        if arg.onarg and clink._in_generate() then
-            arg.onarg(arg_index, word, word_index, line_state, self._user_data)
+        if arg.onarg then
+            self._nocache = true
+            if clink._in_generate() then
+                arg.onarg(arg_index, word, word_index, line_state, self._user_data)
+            end
         end
     end
 
@@ -407,6 +604,9 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
     end
 
     -- Parse the word type.
+    if self._word_classifier and word_index >= 0 and matcher._classify_func then
+        self._nocache = true
+    end
     if self._word_classifier and word_index >= 0 then
         if matcher._classify_func and matcher._classify_func(arg_index, word, word_index, line_state, self._word_classifier) then -- luacheck: ignore 542
             -- The classifier function says it handled the word.
@@ -431,11 +631,13 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
                             local this_info = line_state:getwordinfo(word_index)
                             local next_info = line_state:getwordinfo(word_index + 1)
                             if this_info and next_info and this_info.offset + this_info.length == next_info.offset then
+                                -- This looks at the whole next word.
+                                self._nocache = true
                                 local combined_word = word..line_state:getword(word_index + 1)
                                 for _, i in ipairs(arg) do
                                     if type(i) ~= "function" and i == combined_word then
                                         t = arg_match_type
-                                        self._word_classifier:classifyword(word_index + 1, t, false)
+                                        self:_classifyword(word_index + 1, t, false)
                                         matched = true
                                         break
                                     end
@@ -455,7 +657,7 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
                         -- then check if "word=" is a recognized argument.
                         t, matched = is_word_present(word.."=", arg, t, arg_match_type)
                         if matched then
-                            self._word_classifier:applycolor(pos, 1, get_classify_color(t))
+                            self:_applycolor(pos, 1, get_classify_color(t))
                         end
                     end
                     if not matched then
@@ -469,7 +671,7 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
                                 if matched then
                                     local i = line:find(w, pos, true)
                                     if i then
-                                        self._word_classifier:applycolor(i, #w, get_classify_color(t))
+                                        self:_applycolor(i, #w, get_classify_color(t))
                                         pos = i + #w
                                     end
                                 end
@@ -482,7 +684,7 @@ function _argreader:update(word, word_index, skip_last) -- luacheck: no unused
                 end
             end
             if t then
-                self._word_classifier:classifyword(word_index, t, false)
+                self:_classifyword(word_index, t, false)
             end
         end
     end
@@ -629,6 +831,12 @@ local function apply_options_to_list(addee, list)
     if addee.fromhistory then
         list.fromhistory = true
     end
+    if addee.cache ~= nil then
+        list.cache = addee.cache
+    end
+    if addee.cachekey ~= nil then
+        list.cachekey = addee.cachekey
+    end
     if addee.loopchars then
         -- Apply looping characters, but avoid duplicates.
         list.loopchars, list.loopcharsfind = append_uniq_chars(list.loopchars, list.loopcharsfind, addee.loopchars)
@@ -677,6 +885,72 @@ local function apply_options_to_builder(reader, arg, builder)
     end
 end
 
+--------------------------------------------------------------------------------
+-- Results from argument match functions, when the argument table has a cache=
+-- entry.  Entries are keyed by the function, and then by the command word, the
+-- argument index, the current directory, and the optional cachekey= value.
+local _match_cache = setmetatable({}, { __mode = "k" })
+local _match_cache_count = 0
+local _match_cache_stats = { hits=0, misses=0, expired=0 }
+local _match_cache_limit = 200
+
+--------------------------------------------------------------------------------
+local function is_match_cache_entry_valid(cache, entry, line_state)
+    local t = type(cache)
+    if t == "number" then
+        return os.time() - entry.time < cache
+    elseif t == "function" then
+        return cache(os.time() - entry.time, line_state)
+    end
+    -- Otherwise the entry is valid until the next edit line.
+    return entry.generation == _delayinit_generation
+end
+
+--------------------------------------------------------------------------------
+local function call_match_function(reader, arg, func, endword, word_count, line_state, builder)
+    local cache = arg.cache
+    if not cache then
+        return func(endword, word_count, line_state, builder, reader._user_data)
+    end
+
+    local userkey = arg.cachekey
+    if type(userkey) == "function" then
+        userkey = userkey(line_state)
+    end
+    local command = line_state:getword(line_state:getcommandwordindex()) or ""
+    local key = clink.lower(command).."\0"..reader._arg_index.."\0"..os.getcwd().."\0"..tostring(userkey or "")
+
+    local entries = _match_cache[func]
+    local entry = entries and entries[key]
+    if entry then
+        if is_match_cache_entry_valid(cache, entry, line_state) then
+            _match_cache_stats.hits = _match_cache_stats.hits + 1
+            return entry.matches
+        end
+        entries[key] = nil
+        _match_cache_count = _match_cache_count - 1
+        _match_cache_stats.expired = _match_cache_stats.expired + 1
+    end
+
+    _match_cache_stats.misses = _match_cache_stats.misses + 1
+    local matches = func(endword, word_count, line_state, builder, reader._user_data)
+    if type(matches) == "table" then
+        -- Keep the cache bounded; starting over is simple and rarely needed.
+        if _match_cache_count >= _match_cache_limit then
+            _match_cache = setmetatable({}, { __mode = "k" })
+            _match_cache_count = 0
+        end
+        entries = _match_cache[func]
+        if not entries then
+            entries = {}
+            _match_cache[func] = entries
+        end
+        entries[key] = { matches=matches, time=os.time(), generation=_delayinit_generation }
+        _match_cache_count = _match_cache_count + 1
+    end
+    return matches
+end
+
 --------------------------------------------------------------------------------
 local function add_prefix(prefixes, string)
     if string and type(string) == "string" then
@@ -731,6 +1005,7 @@ function _argmatcher:reset()
     if self._is_flag_matcher then
         error("Cannot reset a flag matcher (it is internal and not exposed)")
     end
+    clear_parse_cache()
     self._args = {}
     self._flags = nil
     self._flagprefix = {}
@@ -763,6 +1038,8 @@ end
 --- entries:
 --- <p><table>
 --- <tr><th>Entry</th><th>More Info</th><th>Version</th></tr>
+--- <tr><td><code>cache=<span class="arg">value</span></code></td><td>See <a href="#addarg_cache">Caching Matches From Functions</a>.</td><td class="version">v1.4.9 and newer</td></tr>
+--- <tr><td><code>cachekey=<span class="arg">value</span></code></td><td>See <a href="#addarg_cache">Caching Matches From Functions</a>.</td><td class="version">v1.4.9 and newer</td></tr>
 --- <tr><td><code>delayinit=<span class="arg">function</span></code></td><td>See <a href="#addarg_delayinit">Delayed initialization for an argument position</a>.</td><td class="version">v1.3.10 and newer</td></tr>
 --- <tr><td><code>fromhistory=true</code></td><td>See <a href="#addarg_fromhistory">Generate Matches From History</a>.</td><td class="version">v1.3.9 and newer</td></tr>
 --- <tr><td><code>loopchars="<span class="arg">characters</span>"</code></td><td>See <a href="#addarg_loopchars">Delimited Arguments</a>.</td><td class="version">v1.3.37 and newer</td></tr>
@@ -816,6 +1093,8 @@ end
 --- entries:
 --- <p><table>
 --- <tr><th>Entry</th><th>More Info</th><th>Version</th></tr>
+--- <tr><td><code>cache=<span class="arg">value</span></code></td><td>See <a href="#addarg_cache">Caching Matches From Functions</a>.</td><td class="version">v1.4.9 and newer</td></tr>
+--- <tr><td><code>cachekey=<span class="arg">value</span></code></td><td>See <a href="#addarg_cache">Caching Matches From Functions</a>.</td><td class="version">v1.4.9 and newer</td></tr>
 --- <tr><td><code>delayinit=<span class="arg">function</span></code></td><td>See <a href="#addarg_delayinit">Delayed initialization for an argument position</a>.</td><td class="version">v1.3.10 and newer</td></tr>
 --- <tr><td><code>fromhistory=true</code></td><td>See <a href="#addarg_fromhistory">Generate Matches From History</a>.</td><td class="version">v1.3.9 and newer</td></tr>
 --- <tr><td><code>nosort=true</code></td><td>See <a href="#addarg_nosort">Disable Sorting Matches</a>.</td><td class="version">v1.3.3 and newer</td></tr>
@@ -1334,6 +1613,8 @@ end
 
 --------------------------------------------------------------------------------
 function _argmatcher:_add(list, addee, prefixes)
+    clear_parse_cache()
+
     -- If addee is a flag like --foo= and is not linked, then link it to a
     -- default parser so its argument doesn't get confused as an arg for its
     -- parent argmatcher.
@@ -1410,6 +1691,7 @@ function _argmatcher:_generate(line_state, match_builder, extra_words)
 
     -- Consume extra words from expanded doskey alias.
     if extra_words then
+        reader._nocache = true
         for word_index = 2, #extra_words do
             if reader:update(extra_words[word_index], -1) and word_index == #extra_words then
                 return true, 1, extra_words[word_index]
@@ -1419,13 +1701,14 @@ function _argmatcher:_generate(line_state, match_builder, extra_words)
 
     -- Consume words and use them to move through matchers' arguments.
     local command_word_index = line_state:getcommandwordindex()
-    for word_index = command_word_index + 1, (line_state:getwordcount() - 1) do
+    for word_index = reader:_resume(command_word_index + 1), (line_state:getwordcount() - 1) do
         local info = line_state:getwordinfo(word_index)
         if not info.redir then
             local word = line_state:getword(word_index)
             if reader:update(word, word_index, true--[[skip_last]]) then
                 return true, word_index
             end
+            reader:_endstep(word_index)
         end
     end
 
@@ -1500,7 +1783,7 @@ function _argmatcher:_generate(line_state, match_builder, extra_words)
         for _, i in ipairs(arg) do
             local t = type(i)
             if t == "function" then
-                local j = i(endword, word_count, line_state, match_builder, reader._user_data)
+                local j = call_match_function(reader, arg, i, endword, word_count, line_state, match_builder)
                 if type(j) ~= "table" then
                     return j or false
                 end
@@ -1708,6 +1991,102 @@ local function get_creation_srcinfo()
     return first or "?"
 end
 
+--------------------------------------------------------------------------------
+-- Scripts that only define argmatchers can be deferred until their command is
+-- used (see the lua.lazy_argmatchers setting).  Maps command names to lists of
+-- deferred script entries, in load order.
+local _deferred_argmatchers = {}
+local _deferred_stats = { deferred=0, loaded=0 }
+local _deferred_seq = 0
+local _deferred_loading
+
+--------------------------------------------------------------------------------
+function clink._defer_argmatcher_script(file, commands)
+    _deferred_seq = _deferred_seq + 1
+    local entry = { file=file, commands={}, seq=_deferred_seq }
+    for _,c in ipairs(string.explode(commands, ";")) do
+        c = path.normalise(clink.lower(c))
+        table.insert(entry.commands, c)
+        local list = _deferred_argmatchers[c]
+        if not list then
+            list = {}
+            _deferred_argmatchers[c] = list
+        end
+        table.insert(list, entry)
+    end
+    _deferred_stats.deferred = _deferred_stats.deferred + 1
+end
+
+--------------------------------------------------------------------------------
+local load_deferred_entry
+
+--------------------------------------------------------------------------------
+-- Loads the deferred scripts for the command.  While a deferred script is
+-- being loaded, only scripts that came before it in load order are loaded, so
+-- that argmatchers get merged in the same order as if all scripts had been
+-- loaded at startup.
+local function load_deferred_argmatcher(command)
+    local list = _deferred_argmatchers[command]
+    while list and list[1] and (not _deferred_loading or list[1].seq < _deferred_loading) do
+        load_deferred_entry(list[1])
+        list = _deferred_argmatchers[command]
+    end
+end
+
+--------------------------------------------------------------------------------
+load_deferred_entry = function(entry)
+    -- Remove the entry first, so that loading the script doesn't recursively
+    -- try to load itself.
+    for _,c in ipairs(entry.commands) do
+        local list = _deferred_argmatchers[c]
+        if list then
+            for i = #list, 1, -1 do
+                if list[i] == entry then
+                    table.remove(list, i)
+                end
+            end
+            if not list[1] then
+                _deferred_argmatchers[c] = nil
+            end
+        end
+    end
+
+    local outer = _deferred_loading
+    _deferred_loading = entry.seq
+
+    -- Earlier scripts that share any of the entry's commands load first.
+    for _,c in ipairs(entry.commands) do
+        load_deferred_argmatcher(c)
+    end
+
+    -- Report failures the same way as loading scripts at startup.  The entry
+    -- counts as loaded either way, so a broken script isn't retried.
+    _deferred_stats.loaded = _deferred_stats.loaded + 1
+    local func, message = loadfile(entry.file)
+    if not func then
+        if settings.get("lua.debug") then
+            print(message)
+        end
+    else
+        xpcall(func, _error_handler)
+    end
+
+    _deferred_loading = outer
+end
+
+--------------------------------------------------------------------------------
+local function load_deferred_argmatchers(command_word)
+    if next(_deferred_argmatchers) == nil then
+        return
+    end
+
+    load_deferred_argmatcher(command_word)
+    load_deferred_argmatcher(path.getname(command_word))
+    if path.isexecext(command_word) then
+        load_deferred_argmatcher(path.getbasename(command_word))
+    end
+end
+
 --------------------------------------------------------------------------------
 --- -name:  clink.argmatcher
 --- -ver:   1.0.0
@@ -1747,6 +2126,9 @@ function clink.argmatcher(...)
     -- If multiple commands are listed, merging isn't supported.
     local matcher = nil
     for _, i in ipairs(input) do
+        -- Load any deferred script first, so that it gets merged in the same
+        -- order as if it had been loaded at startup.
+        load_deferred_argmatcher(path.normalise(clink.lower(i)))
         matcher = _argmatchers[path.normalise(clink.lower(i))]
         if #input <= 1 then
             break
@@ -1801,9 +2183,9 @@ function clink.dirmatches(match_word)
     local _, ismain = coroutine.running()
 
     local matches = {}
-    for _, i in ipairs(os.globdirs(word.."*", true)) do
+    for _, i in ipairs(os.globdirs(word.."*", 2)) do
         local m = path.join(root, i.name)
-        table.insert(matches, { match = m, type = i.type })
+        table.insert(matches, { match = m, type = i.type, size = i.size, mtime = i.mtime, attr = i.attr })
         if not ismain and _ % 250 == 0 then
             coroutine.yield()
         end
@@ -1844,9 +2226,9 @@ function clink.filematches(match_word)
     local _, ismain = coroutine.running()
 
     local matches = {}
-    for _, i in ipairs(os.globfiles(word.."*", true)) do
+    for _, i in ipairs(os.globfiles(word.."*", 2)) do
         local m = path.join(root, i.name)
-        table.insert(matches, { match = m, type = i.type })
+        table.insert(matches, { match = m, type = i.type, size = i.size, mtime = i.mtime, attr = i.attr })
         if not ismain and _ % 250 == 0 then
             coroutine.yield()
         end
@@ -2017,6 +2399,8 @@ local function _has_argmatcher(command_word, quoted)
         end
     end
 
+    load_deferred_argmatchers(command_word)
+
     local argmatcher = _is_argmatcher_loaded(command_word, quoted)
 
     -- If an argmatcher isn't loaded, look for a Lua script by that name in one
@@ -2061,6 +2445,7 @@ local function _do_onuse_callback(argmatcher, command_word)
         -- Run the delayinit callback in a coroutine so typing is responsive.
         c = coroutine.create(function ()
             argmatcher._delayinit_func(argmatcher, command_word)
+            clear_parse_cache()
             argmatcher._onuse_coroutine = nil
             _clear_onuse_coroutine[argmatcher] = nil
             if async_delayinit then
@@ -2289,6 +2674,7 @@ function argmatcher_generator:getwordbreakinfo(line_state) -- luacheck: no self
 
         -- Consume extra words from expanded doskey alias.
         if extra_words then
+            reader._nocache = true
             for word_index = 2, #extra_words do
                 if reader:update(extra_words[word_index], -1) and word_index == #extra_words then
                     lookup = extra_words[word_index]
@@ -2299,7 +2685,7 @@ function argmatcher_generator:getwordbreakinfo(line_state) -- luacheck: no self
 
         -- Consume words and use them to move through matchers' arguments.
         local command_word_index = line_state:getcommandwordindex()
-        for word_index = command_word_index + 1, (line_state:getwordcount() - 1) do
+        for word_index = reader:_resume(command_word_index + 1), (line_state:getwordcount() - 1) do
             local info = line_state:getwordinfo(word_index)
             if not info.redir then
                 local word = line_state:getword(word_index)
@@ -2307,6 +2693,7 @@ function argmatcher_generator:getwordbreakinfo(line_state) -- luacheck: no self
                     line_state:shift(word_index)
                     goto do_command
                 end
+                reader:_endstep(word_index)
             end
         end
 
@@ -2390,6 +2777,7 @@ function argmatcher_classifier:classify(commands) -- luacheck: no self
 
             -- Consume extra words from expanded doskey alias.
             if extra_words then
+                reader._nocache = true
                 for word_index = 2, #extra_words do
                     if reader:update(extra_words[word_index], -1) and word_index == #extra_words then
                         lookup = extra_words[word_index]
@@ -2399,7 +2787,7 @@ function argmatcher_classifier:classify(commands) -- luacheck: no self
             end
 
             -- Consume words and use them to move through matchers' arguments.
-            for word_index = command_word_index + 1, line_state:getwordcount() do
+            for word_index = reader:_resume(command_word_index + 1), line_state:getwordcount() do
                 local info = line_state:getwordinfo(word_index)
                 if not info.redir then
                     local word = line_state:getword(word_index)
@@ -2408,6 +2796,7 @@ function argmatcher_classifier:classify(commands) -- luacheck: no self
                         word_classifier:shift(word_index, line_state:getcommandwordindex())
                         goto do_command
                     end
+                    reader:_endstep(word_index)
                 end
             end
         end
@@ -2504,6 +2893,21 @@ function clink._diag_completions_dirs()
     clink.print("", "commands searched:", attempted)
     clink.print("", "Lua scripts loaded:", loaded)
     clink.print("", "argmatchers loaded:", found)
+
+    if _deferred_stats.deferred > 0 then
+        clink.print("  deferred argmatcher scripts:")
+        clink.print("", "scripts deferred:", _deferred_stats.deferred)
+        clink.print("", "deferred scripts loaded:", _deferred_stats.loaded)
+    end
+
+    local stats = _match_cache_stats
+    if stats.hits + stats.misses > 0 then
+        clink.print("  argument match cache:")
+        clink.print("", "entries:", _match_cache_count)
+        clink.print("", "hits:", stats.hits)
+        clink.print("", "misses:", stats.misses)
+        clink.print("", "expired:", stats.expired)
+    end
 end
 
 
@@ -265,6 +265,63 @@ function os.globfiles(pattern, extrainfo)
     end
 end
 
+--------------------------------------------------------------------------------
+--- -name:  os.globrecursive
+--- -ver:   1.4.9
+--- -arg:   globpattern:string
+--- -arg:   [extrainfo:integer|boolean]
+--- -ret:   function
+--- Returns an iterator function that returns the files and directories matching
+--- <span class="arg">globpattern</span>, one per call.  The pattern may contain
+--- <code>**</code>, which matches any number of directories (including none),
+--- for example <code>src/**/*.csproj</code>.  A pattern that ends with a path
+--- separator matches only directories.
+---
+--- The directories before the first wildcard are the root of the search, and
+--- subdirectories that cannot contain matches are skipped.  Directories are
+--- searched in the background, so the order of results is unpredictable.
+--- Symlinks and junctions to directories are returned but not followed.
+---
+--- The optional <span class="arg">extrainfo</span> argument returns tables
+--- instead of strings, using the same scheme as
+--- <a href="#os.globfiles">os.globfiles()</a>.
+---
+--- When this is used in a coroutine it automatically yields while waiting for
+--- more results, and stops if the coroutine is canceled.
+--- -show:  for file in os.globrecursive("src/**/*.csproj") do
+--- -show:  &nbsp;   print(file)
+--- -show:  end
+function os.globrecursive(pattern, extrainfo)
+    local c, ismain = coroutine.running()
+    local g = os._makerecursiveglobber(pattern, extrainfo)
+    local t = {}
+    local i = 0
+    local more = true
+    return function()
+        while true do
+            i = i + 1
+            if t[i] ~= nil then
+                return t[i]
+            elseif not more then
+                return
+            elseif not ismain and clink._is_coroutine_canceled(c) then
+                more = false
+                g:close()
+                return
+            end
+
+            t = {}
+            i = 0
+            more = g:next(t, ismain)
+            if not more then
+                g:close()
+            elseif not ismain and not t[1] then
+                coroutine.yield()
+            end
+        end
+    end
+end
+
 --------------------------------------------------------------------------------
 local function first_letter(s)
     -- This handles combining marks, but does not yet handle ZWJ (0x200d) such
@@ -214,6 +214,13 @@ end
 --- Registers <span class="arg">func</span> to be called when Clink is about to
 --- display matches.  See <a href="#filteringthematchdisplay">Filtering the
 --- Match Display</a> for more information.
+---
+--- Starting in v1.4.9, "file" and "dir" matches from
+--- <a href="#clink.filematches">clink.filematches()</a> and
+--- <a href="#clink.dirmatches">clink.dirmatches()</a> also include
+--- <code>size</code>, <code>mtime</code>, and <code>attr</code> fields, so
+--- handlers can sort or annotate matches without accessing the file system
+--- again.
 --- -show:  local function my_filter(matches, popup)
 --- -show:  &nbsp;   local new_matches = {}
 --- -show:  &nbsp;   for _,m in ipairs(matches) do
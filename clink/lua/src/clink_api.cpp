@@ -44,6 +44,7 @@ extern void host_signal_delayed_init();
 extern void host_mark_deprecated_argmatcher(const char* name);
 extern void set_suggestion(const char* line, unsigned int endword_offset, const char* suggestion, unsigned int offset);
 extern void set_refilter_after_resize(bool refilter);
+extern void load_deferred_history();
 extern const char* get_popup_colors();
 extern const char* get_popup_desc_colors();
 extern setting_enum g_dupe_mode;
@@ -1386,6 +1387,7 @@ static int api_recognize_command(lua_State* state)
 //------------------------------------------------------------------------------
 static int generate_from_history(lua_State* state)
 {
+    load_deferred_history();
     HIST_ENTRY** list = history_list();
     if (!list)
         return 0;
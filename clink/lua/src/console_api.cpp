@@ -166,6 +166,8 @@ static int get_height(lua_State* state)
 /// Returns the total number of lines in the console screen buffer.
 static int get_num_lines(lua_State* state)
 {
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbiInfo;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbiInfo))
@@ -182,6 +184,8 @@ static int get_num_lines(lua_State* state)
 /// Returns the current top line (scroll position) in the console screen buffer.
 static int get_top(lua_State* state)
 {
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbiInfo;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbiInfo))
@@ -210,6 +214,8 @@ static int get_line_text(lua_State* state)
     if (!isnum)
         return 0;
 
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbi))
@@ -281,6 +287,8 @@ static int is_line_default_color(lua_State* state)
     if (!isnum)
         return 0;
 
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbi))
@@ -353,6 +361,8 @@ static int line_has_color(lua_State* state)
     if (!isnum || !has_attrs || !mask_name)
         return 0;
 
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbi))
@@ -417,6 +427,8 @@ static int find_line(lua_State* state, int direction)
     if (!isnum)
         return 0;
 
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     if (!GetConsoleScreenBufferInfo(h, &csbi))
@@ -690,6 +702,8 @@ static int set_width(lua_State* state)
     if (width <= 0)
         return 0;
 
+    flush_printer_frame();
+
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
     CONSOLE_SCREEN_BUFFER_INFOEX csbix = { sizeof(csbix) };
     if (!GetConsoleScreenBufferInfoEx(h, &csbix))
@@ -0,0 +1,596 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "exec_catalog.h"
+
+#include <core/os.h>
+#include <core/path.h>
+#include <core/str_tokeniser.h>
+#include <core/debugheap.h>
+
+#include <algorithm>
+
+//------------------------------------------------------------------------------
+static const char c_catalog_header[] = "clink exec catalog 1";
+static const unsigned int c_kept_attr = FILE_ATTRIBUTE_HIDDEN|FILE_ATTRIBUTE_READONLY|FILE_ATTRIBUTE_SYSTEM;
+
+//------------------------------------------------------------------------------
+static unsigned int fold(unsigned char c)
+{
+    if (c >= 'A' && c <= 'Z')
+        return c - 'A' + 'a';
+    if (c == '-')
+        return '_';
+    return c;
+}
+
+//------------------------------------------------------------------------------
+static int compare_folded(const char* a, const char* b)
+{
+    while (true)
+    {
+        const unsigned int fa = fold(*a);
+        const unsigned int fb = fold(*b);
+        if (fa != fb)
+            return (fa < fb) ? -1 : 1;
+        if (!fa)
+            return 0;
+        ++a, ++b;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Compares only the first len characters of name against prefix.
+static int compare_prefix(const char* name, const char* prefix, unsigned int len)
+{
+    for (unsigned int i = 0; i < len; ++i)
+    {
+        const unsigned int fa = fold(name[i]);
+        const unsigned int fb = fold(prefix[i]);
+        if (fa != fb)
+            return (fa < fb) ? -1 : 1;
+    }
+    return 0;
+}
+
+//------------------------------------------------------------------------------
+static bool is_absolute_dir(const char* dir)
+{
+    if (path::is_separator(dir[0]) && path::is_separator(dir[1]))
+        return true;
+    return (isalpha((unsigned char)dir[0]) && dir[1] == ':' && path::is_separator(dir[2]));
+}
+
+//------------------------------------------------------------------------------
+static unsigned long long get_mtime(const char* path)
+{
+    wstr<280> wpath(path);
+    WIN32_FILE_ATTRIBUTE_DATA fad;
+    if (!GetFileAttributesExW(wpath.c_str(), GetFileExInfoStandard, &fad))
+        return 0;
+
+    ULARGE_INTEGER uli;
+    uli.LowPart = fad.ftLastWriteTime.dwLowDateTime;
+    uli.HighPart = fad.ftLastWriteTime.dwHighDateTime;
+    return uli.QuadPart;
+}
+
+//------------------------------------------------------------------------------
+static void parse_pathext(const char* pathext, std::vector<str_moveable>& out)
+{
+    out.clear();
+
+    str<16> token;
+    str_tokeniser tokens(pathext, ";");
+    while (tokens.next(token))
+    {
+        token.trim();
+        if (token.length() > 1 && token.c_str()[0] == '.')
+            out.emplace_back(token.c_str());
+    }
+}
+
+
+
+//------------------------------------------------------------------------------
+void exec_catalog_snapshot::find_range(const char* prefix, unsigned int& begin, unsigned int& end) const
+{
+    // Case folding is only reliable for ASCII, so the range is narrowed only
+    // by the part of the prefix before any other characters.
+    unsigned int len = 0;
+    while (prefix[len] && (unsigned char)prefix[len] < 0x80)
+        ++len;
+
+    auto lower = std::lower_bound(m_entries.begin(), m_entries.end(), prefix, [len] (const entry& e, const char* p) {
+        return compare_prefix(e.name, p, len) < 0;
+    });
+    auto upper = std::upper_bound(lower, m_entries.end(), prefix, [len] (const char* p, const entry& e) {
+        return compare_prefix(e.name, p, len) > 0;
+    });
+
+    begin = unsigned(lower - m_entries.begin());
+    end = unsigned(upper - m_entries.begin());
+}
+
+
+
+//------------------------------------------------------------------------------
+exec_catalog::exec_catalog(const char* file)
+: m_file(file)
+{
+}
+
+//------------------------------------------------------------------------------
+exec_catalog::~exec_catalog()
+{
+    shutdown();
+}
+
+//------------------------------------------------------------------------------
+void exec_catalog::shutdown()
+{
+    std::unique_ptr<std::thread> thread;
+
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+        m_zombie = true;
+        if (m_event)
+            SetEvent(m_event);
+
+        thread = std::move(m_thread);
+    }
+
+    if (thread)
+        thread->join();
+
+    if (m_event)
+    {
+        CloseHandle(m_event);
+        m_event = nullptr;
+    }
+    if (m_idle_event)
+    {
+        CloseHandle(m_idle_event);
+        m_idle_event = nullptr;
+    }
+}
+
+//------------------------------------------------------------------------------
+std::shared_ptr<const exec_catalog_snapshot> exec_catalog::get(const char* path, const char* pathext)
+{
+    std::lock_guard<std::recursive_mutex> lock(m_mutex);
+
+    if (m_zombie)
+        return nullptr;
+
+    dbg_ignore_scope(snapshot, "Exec catalog");
+
+    if (!m_loaded)
+    {
+        m_loaded = true;
+        load();
+    }
+
+    if (configure(path, pathext))
+        rebuild();
+
+    if (!m_usable)
+        return nullptr;
+
+    kick();
+    return m_snapshot;
+}
+
+//------------------------------------------------------------------------------
+bool exec_catalog::wait(unsigned int timeout)
+{
+    HANDLE idle_event;
+    {
+        std::lock_guard<std::recursive_mutex> lock(m_mutex);
+        idle_event = m_idle_event;
+    }
+
+    return !idle_event || WaitForSingleObject(idle_event, timeout) == WAIT_OBJECT_0;
+}
+
+//------------------------------------------------------------------------------
+exec_catalog& exec_catalog::get_instance()
+{
+    static str_moveable s_file;
+    if (s_file.empty() && os::get_env("=clink.profile", s_file))
+        path::append(s_file, "exec_catalog");
+
+    static exec_catalog s_catalog(s_file.c_str());
+    return s_catalog;
+}
+
+//------------------------------------------------------------------------------
+// Returns true if the directories or extensions changed.
+bool exec_catalog::configure(const char* path, const char* pathext)
+{
+    const bool same_ext = m_pathext.iequals(pathext);
+    if (same_ext && m_path.equals(path))
+        return false;
+
+    m_path = path;
+    if (!same_ext)
+    {
+        m_pathext = pathext;
+        parse_pathext(pathext, m_exts);
+        ++m_generation;
+    }
+
+    // Keep what's known about directories that are still in PATH, unless the
+    // extensions changed.
+    std::vector<dir_entry> old_dirs = std::move(m_dirs);
+    m_dirs.clear();
+    m_usable = true;
+
+    str<280> token;
+    str_tokeniser tokens(path, ";");
+    while (tokens.next(token))
+    {
+        token.trim();
+        if (token.empty())
+            continue;
+
+        // Relative directories depend on the current directory, so PATH can't
+        // be served from the index.
+        if (!is_absolute_dir(token.c_str()))
+            m_usable = false;
+
+        bool dup = false;
+        for (const auto& dir : m_dirs)
+            if (dir.dir.iequals(token.c_str()))
+                dup = true;
+        if (dup)
+            continue;
+
+        dir_entry entry;
+        entry.dir = token.c_str();
+        entry.mtime = 0;
+        entry.scanned = false;
+        if (same_ext)
+        {
+            for (auto& old : old_dirs)
+            {
+                if (old.dir.iequals(token.c_str()))
+                {
+                    entry = std::move(old);
+                    break;
+                }
+            }
+        }
+        m_dirs.emplace_back(std::move(entry));
+    }
+
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void exec_catalog::kick()
+{
+    if (!m_event)
+    {
+        m_event = CreateEvent(nullptr, false, false, nullptr);
+        m_idle_event = CreateEvent(nullptr, true, true, nullptr);
+        if (!m_event || !m_idle_event)
+            return;
+    }
+
+    if (!m_thread)
+    {
+        dbg_ignore_scope(snapshot, "Exec catalog thread");
+        m_thread = std::make_unique<std::thread>(&proc, this);
+    }
+
+    m_pending = true;
+    ResetEvent(m_idle_event);
+    SetEvent(m_event);
+}
+
+//------------------------------------------------------------------------------
+void exec_catalog::load()
+{
+    if (m_file.empty())
+        return;
+
+    FILE* in = fopen(m_file.c_str(), "rb");
+    if (!in)
+        return;
+
+    str_moveable buffer;
+    fseek(in, 0, SEEK_END);
+    int size = ftell(in);
+    fseek(in, 0, SEEK_SET);
+    if (size > 0 && buffer.reserve(size))
+    {
+        size = int(fread(buffer.data(), 1, size, in));
+        buffer.data()[size] = '\0';
+    }
+    fclose(in);
+
+    // X <tab> pathext
+    // D <tab> mtime <tab> dir
+    // F <tab> attr <tab> name
+    bool first = true;
+    str<> line;
+    str_tokeniser lines(buffer.c_str(), "\n\r");
+    while (lines.next(line))
+    {
+        if (first)
+        {
+            first = false;
+            if (!line.equals(c_catalog_header))
+                return;
+            continue;
+        }
+
+        const char* p = line.c_str();
+        if (p[0] && p[1] == '\t')
+        {
+            if (p[0] == 'X')
+            {
+                m_pathext = p + 2;
+                continue;
+            }
+
+            char* end;
+            const unsigned long long value = _strtoui64(p + 2, &end, 10);
+            if (*end != '\t')
+                continue;
+
+            if (p[0] == 'D')
+            {
+                dir_entry dir;
+                dir.dir = end + 1;
+                dir.mtime = value;
+                dir.scanned = true;
+                m_dirs.emplace_back(std::move(dir));
+            }
+            else if (p[0] == 'F' && !m_dirs.empty())
+            {
+                file_entry file;
+                file.name = end + 1;
+                file.attr = (unsigned int)value & c_kept_attr;
+                m_dirs.back().files.emplace_back(std::move(file));
+            }
+        }
+    }
+
+    // Leave m_path empty so that configure() picks which dirs to keep.
+    parse_pathext(m_pathext.c_str(), m_exts);
+}
+
+//------------------------------------------------------------------------------
+void exec_catalog::format(str_base& out) const
+{
+    out.clear();
+    out << c_catalog_header << "\n";
+    out << "X\t" << m_pathext.c_str() << "\n";
+
+    str<32> value;
+    for (const auto& dir : m_dirs)
+    {
+        if (!dir.scanned)
+            continue;
+        value.format("%llu", dir.mtime);
+        out << "D\t" << value.c_str() << "\t" << dir.dir.c_str() << "\n";
+        for (const auto& file : dir.files)
+        {
+            value.format("%u", file.attr);
+            out << "F\t" << value.c_str() << "\t" << file.name.c_str() << "\n";
+        }
+    }
+}
+
+//------------------------------------------------------------------------------
+// Several sessions share the file, so it's written to a temporary file first
+// and then renamed over the original.  Readers see either the old or the new
+// contents, never a partial file.
+void exec_catalog::save(const char* file, const str_base& data)
+{
+    if (!file || !*file)
+        return;
+
+    str<280> dir(file);
+    path::to_parent(dir, nullptr);
+
+    str<280> tmp;
+    FILE* out = os::create_temp_file(&tmp, "exec_catalog", ".tmp", os::normal, dir.c_str());
+    if (out == nullptr)
+        return;
+
+    const bool ok = (fwrite(data.c_str(), 1, data.length(), out) == data.length());
+    fclose(out);
+
+    wstr<280> wtmp(tmp.c_str());
+    wstr<280> wfile(file);
+    if (!ok || !MoveFileExW(wtmp.c_str(), wfile.c_str(), MOVEFILE_REPLACE_EXISTING))
+        os::unlink(tmp.c_str());
+}
+
+//------------------------------------------------------------------------------
+void exec_catalog::rebuild()
+{
+    m_snapshot.reset();
+    for (const auto& dir : m_dirs)
+        if (!dir.scanned)
+            return;
+
+    auto snapshot = std::make_shared<exec_catalog_snapshot>();
+    auto& entries = snapshot->m_entries;
+    for (const auto& dir : m_dirs)
+    {
+        for (const auto& file : dir.files)
+        {
+            exec_catalog_snapshot::entry e;
+            e.name = snapshot->m_store.store(file.name.c_str());
+            e.attr = file.attr;
+            if (e.name)
+                entries.push_back(e);
+        }
+    }
+
+    // Names that differ only by case sort next to each other, and the stable
+    // sort keeps them in PATH order so the first one wins.
+    std::stable_sort(entries.begin(), entries.end(), [] (const exec_catalog_snapshot::entry& a, const exec_catalog_snapshot::entry& b) {
+        const int cmp = compare_folded(a.name, b.name);
+        return cmp ? cmp < 0 : _stricmp(a.name, b.name) < 0;
+    });
+    entries.erase(std::unique(entries.begin(), entries.end(), [] (const exec_catalog_snapshot::entry& a, const exec_catalog_snapshot::entry& b) {
+        return _stricmp(a.name, b.name) == 0;
+    }), entries.end());
+
+    m_snapshot = std::move(snapshot);
+}
+
+//------------------------------------------------------------------------------
+bool exec_catalog::scan(const char* dir, const std::vector<str_moveable>& exts, std::vector<file_entry>& out)
+{
+    out.clear();
+
+    str<280> pattern(dir);
+    path::append(pattern, "*");
+    wstr<280> wpattern(pattern.c_str());
+
+    WIN32_FIND_DATAW fd;
+    HANDLE h = FindFirstFileExW(wpattern.c_str(), FindExInfoBasic, &fd, FindExSearchNameMatch, nullptr, FIND_FIRST_EX_LARGE_FETCH);
+    if (h == INVALID_HANDLE_VALUE)
+        return false;
+
+    str<280> name;
+    do
+    {
+        if (fd.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+            continue;
+
+        name.clear();
+        to_utf8(name, fd.cFileName);
+
+        const char* ext = path::get_extension(name.c_str());
+        if (!ext)
+            continue;
+
+        for (const auto& e : exts)
+        {
+            if (e.iequals(ext))
+            {
+                file_entry file;
+                file.name = name.c_str();
+                file.attr = fd.dwFileAttributes & c_kept_attr;
+                out.emplace_back(std::move(file));
+                break;
+            }
+        }
+    }
+    while (FindNextFileW(h, &fd));
+
+    FindClose(h);
+    return true;
+}
+
+//------------------------------------------------------------------------------
+void exec_catalog::proc(exec_catalog* c)
+{
+    while (true)
+    {
+        if (WaitForSingleObject(c->m_event, INFINITE) != WAIT_OBJECT_0)
+        {
+            // Uh oh.
+            Sleep(5000);
+        }
+
+        while (true)
+        {
+            std::vector<str_moveable> dirs;
+            std::vector<str_moveable> exts;
+            unsigned int generation;
+
+            {
+                std::lock_guard<std::recursive_mutex> lock(c->m_mutex);
+                if (c->m_zombie)
+                    break;
+                if (!c->m_pending)
+                {
+                    SetEvent(c->m_idle_event);
+                    break;
+                }
+                c->m_pending = false;
+                for (const auto& dir : c->m_dirs)
+                    dirs.emplace_back(dir.dir.c_str());
+                for (const auto& ext : c->m_exts)
+                    exts.emplace_back(ext.c_str());
+                generation = c->m_generation;
+            }
+
+            bool changed = false;
+            for (const auto& dir : dirs)
+            {
+                if (c->m_zombie)
+                    break;
+
+                const unsigned long long mtime = get_mtime(dir.c_str());
+
+                {
+                    std::lock_guard<std::recursive_mutex> lock(c->m_mutex);
+                    const dir_entry* entry = c->find_dir(dir.c_str());
+                    if (!entry || (entry->scanned && entry->mtime == mtime))
+                        continue;
+                }
+
+                std::vector<file_entry> files;
+                scan(dir.c_str(), exts, files);
+
+                {
+                    std::lock_guard<std::recursive_mutex> lock(c->m_mutex);
+                    dir_entry* entry = c->find_dir(dir.c_str());
+                    if (entry && c->m_generation == generation)
+                    {
+                        entry->mtime = mtime;
+                        entry->files = std::move(files);
+                        entry->scanned = true;
+                        changed = true;
+                    }
+                }
+            }
+
+            if (changed)
+            {
+                str_moveable data;
+                {
+                    std::lock_guard<std::recursive_mutex> lock(c->m_mutex);
+                    dbg_ignore_scope(snapshot, "Exec catalog");
+                    c->rebuild();
+                    c->format(data);
+                }
+
+                // Write the file without holding the lock, so get() isn't
+                // blocked on file I/O.
+                save(c->m_file.c_str(), data);
+            }
+        }
+
+        if (c->m_zombie)
+            break;
+    }
+}
+
+//------------------------------------------------------------------------------
+exec_catalog::dir_entry* exec_catalog::find_dir(const char* dir)
+{
+    for (auto& entry : m_dirs)
+        if (entry.dir.iequals(dir))
+            return &entry;
+    return nullptr;
+}
+
+
+
+//------------------------------------------------------------------------------
+void shutdown_exec_catalog()
+{
+    exec_catalog::get_instance().shutdown();
+}
@@ -0,0 +1,251 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "lua_allocator.h"
+
+#include <core/base.h>
+#include <core/str.h>
+#include <terminal/printer.h>
+#include <terminal/terminal_helpers.h>
+
+#include <readline/readline.h>
+
+#include <assert.h>
+
+//------------------------------------------------------------------------------
+static const char* const c_tag_names[] =
+{
+    "other",
+    "prompt_filter",
+    "generate",
+    "classify",
+    "coroutine",
+};
+static_assert(sizeof_array(c_tag_names) == int(lua_mem_tag::max), "c_tag_names must match lua_mem_tag");
+
+static lua_mem_tag s_tag = lua_mem_tag::other;
+static lua_allocator* s_head = nullptr;
+
+
+
+//------------------------------------------------------------------------------
+lua_mem_tag_scope::lua_mem_tag_scope(lua_mem_tag tag)
+: m_prev(s_tag)
+{
+    s_tag = tag;
+}
+
+//------------------------------------------------------------------------------
+lua_mem_tag_scope::~lua_mem_tag_scope()
+{
+    s_tag = m_prev;
+}
+
+
+
+//------------------------------------------------------------------------------
+lua_allocator::lua_allocator()
+{
+    m_next = s_head;
+    s_head = this;
+}
+
+//------------------------------------------------------------------------------
+lua_allocator::~lua_allocator()
+{
+    for (lua_allocator** p = &s_head; *p; p = &(*p)->m_next)
+    {
+        if (*p == this)
+        {
+            *p = m_next;
+            break;
+        }
+    }
+
+    while (m_slab)
+    {
+        char* prev = *reinterpret_cast<char**>(m_slab);
+        free(m_slab);
+        m_slab = prev;
+    }
+}
+
+//------------------------------------------------------------------------------
+// Lua passes the block's size as osize whenever ptr is not null, so blocks
+// don't need headers to know which free list they belong to.
+void* lua_allocator::alloc(void* ud, void* ptr, size_t osize, size_t nsize)
+{
+    lua_allocator* self = static_cast<lua_allocator*>(ud);
+
+    if (!nsize)
+    {
+        if (ptr)
+            self->free_block_(ptr, osize);
+        return nullptr;
+    }
+
+    if (!ptr)
+        return self->alloc_block(nsize);
+
+    return self->realloc_block(ptr, osize, nsize);
+}
+
+//------------------------------------------------------------------------------
+void lua_allocator::get_stats(lua_alloc_stats& out) const
+{
+    out = m_stats;
+}
+
+//------------------------------------------------------------------------------
+const char* lua_allocator::get_tag_name(lua_mem_tag tag)
+{
+    return (unsigned(tag) < sizeof_array(c_tag_names)) ? c_tag_names[int(tag)] : "";
+}
+
+//------------------------------------------------------------------------------
+lua_allocator* lua_allocator::get_active()
+{
+    return s_head;
+}
+
+//------------------------------------------------------------------------------
+void* lua_allocator::alloc_block(size_t size)
+{
+    void* ptr;
+    if (size > max_pooled)
+    {
+        ptr = malloc(size);
+        if (!ptr)
+            return nullptr;
+        m_stats.large_in_use += size;
+    }
+    else
+    {
+        const unsigned int index = size_class(size);
+        if (free_block* block = m_free[index])
+        {
+            m_free[index] = block->next;
+            m_stats.free_bytes -= (index + 1) * granularity;
+            ptr = block;
+        }
+        else
+        {
+            const size_t block_size = (index + 1) * granularity;
+            if (!m_slab || m_slab_used + block_size > slab_size)
+            {
+                char* slab = static_cast<char*>(malloc(slab_size));
+                if (!slab)
+                    return nullptr;
+                *reinterpret_cast<char**>(slab) = m_slab;
+                m_slab = slab;
+                m_slab_used = granularity;  // Keeps blocks aligned after the link.
+                m_stats.slab_bytes += slab_size;
+            }
+
+            ptr = m_slab + m_slab_used;
+            m_slab_used += block_size;
+        }
+    }
+
+    m_stats.in_use += size;
+    account_alloc(size);
+    return ptr;
+}
+
+//------------------------------------------------------------------------------
+void lua_allocator::free_block_(void* ptr, size_t size)
+{
+    assert(ptr);
+    assert(m_stats.in_use >= size);
+    m_stats.in_use -= size;
+
+    if (size > max_pooled)
+    {
+        m_stats.large_in_use -= size;
+        free(ptr);
+        return;
+    }
+
+    const unsigned int index = size_class(size);
+    free_block* block = static_cast<free_block*>(ptr);
+    block->next = m_free[index];
+    m_free[index] = block;
+    m_stats.free_bytes += (index + 1) * granularity;
+}
+
+//------------------------------------------------------------------------------
+void* lua_allocator::realloc_block(void* ptr, size_t osize, size_t nsize)
+{
+    // Both large:  let the CRT resize in place when it can.
+    if (osize > max_pooled && nsize > max_pooled)
+    {
+        void* p = realloc(ptr, nsize);
+        if (!p)
+            return nullptr;
+        m_stats.in_use += nsize - osize;
+        m_stats.large_in_use += nsize - osize;
+        if (nsize > osize)
+            account_alloc(nsize - osize);
+        return p;
+    }
+
+    // Both in the same size class:  the block already fits.
+    if (osize <= max_pooled && nsize <= max_pooled && size_class(osize) == size_class(nsize))
+    {
+        m_stats.in_use += nsize - osize;
+        return ptr;
+    }
+
+    // Otherwise move it.  On failure the old block must stay intact.
+    void* p = alloc_block(nsize);
+    if (!p)
+        return nullptr;
+    memcpy(p, ptr, min(osize, nsize));
+    free_block_(ptr, osize);
+    return p;
+}
+
+//------------------------------------------------------------------------------
+void lua_allocator::account_alloc(size_t size)
+{
+    m_stats.allocs[int(s_tag)]++;
+    m_stats.bytes[int(s_tag)] += size;
+    m_allocated_since_gc += size;
+}
+
+
+
+//------------------------------------------------------------------------------
+void lua_memory_diagnostics()
+{
+    lua_allocator* allocator = lua_allocator::get_active();
+    if (!allocator || !rl_explicit_arg)
+        return;
+
+    static char bold[] = "\x1b[1m";
+    static char norm[] = "\x1b[m";
+
+    lua_alloc_stats stats;
+    allocator->get_stats(stats);
+
+    str<> s;
+    const int spacing = 14;
+
+    s.format("%slua memory:%s\n", bold, norm);
+    g_printer->print(s.c_str(), s.length());
+
+    s.format("  %-*s  %u KB\n", spacing, "in use", unsigned(stats.in_use / 1024));
+    g_printer->print(s.c_str(), s.length());
+    s.format("  %-*s  %u KB\n", spacing, "large blocks", unsigned(stats.large_in_use / 1024));
+    g_printer->print(s.c_str(), s.length());
+    s.format("  %-*s  %u KB (%u KB free)\n", spacing, "slab pages", unsigned(stats.slab_bytes / 1024), unsigned(stats.free_bytes / 1024));
+    g_printer->print(s.c_str(), s.length());
+
+    for (int i = 0; i < int(lua_mem_tag::max); ++i)
+    {
+        s.format("  %-*s  %llu allocations, %llu KB\n", spacing,
+                 lua_allocator::get_tag_name(lua_mem_tag(i)), stats.allocs[i], stats.bytes[i] / 1024);
+        g_printer->print(s.c_str(), s.length());
+    }
+}
@@ -3,10 +3,12 @@
 
 #include "pch.h"
 #include "lua_input_idle.h"
+#include "lua_allocator.h"
 #include "lua_state.h"
 #include "async_lua_task.h"
 
 #include <core/base.h>
+#include <core/perf_stats.h>
 #include <lib/reclassify.h>
 
 #include <assert.h>
@@ -41,6 +43,10 @@ static HANDLE s_wake_event = 0;
 // automatically rerunning the prompt filters.
 const DWORD c_terminal_resize_refilter_delay = 500;
 
+// After input stops for this many milliseconds, use the idle time for Lua
+// garbage collection steps.
+const DWORD c_idle_gc_delay = 50;
+
 //------------------------------------------------------------------------------
 lua_input_idle::lua_input_idle(lua_state& state)
 : m_state(state)
@@ -95,8 +101,10 @@ unsigned lua_input_idle::get_timeout()
 
     m_iterations++;
 
+    const unsigned gc_timeout = m_state.has_idle_gc_work() ? c_idle_gc_delay : INFINITE;
+
     if (!is_enabled())
-        return INFINITE;
+        return gc_timeout;
 
     lua_State* state = m_state.get_state();
     save_stack_top ss(state);
@@ -112,9 +120,9 @@ unsigned lua_input_idle::get_timeout()
     int isnum;
     double sec = lua_tonumberx(state, -1, &isnum);
     if (!isnum)
-        return INFINITE;
+        return gc_timeout;
 
-    return (sec > 0) ? unsigned(sec * 1000) : 0;
+    return min<unsigned>((sec > 0) ? unsigned(sec * 1000) : 0, gc_timeout);
 }
 
 //------------------------------------------------------------------------------
@@ -166,6 +174,9 @@ void lua_input_idle::on_idle()
         s_signaled_reclassify = false;
         host_reclassify(reclassify_reason::force);
     }
+
+    if (m_state.has_idle_gc_work())
+        m_state.idle_gc_step();
 }
 
 //------------------------------------------------------------------------------
@@ -233,6 +244,9 @@ bool lua_input_idle::has_coroutines()
 //------------------------------------------------------------------------------
 void lua_input_idle::resume_coroutines()
 {
+    PERF_STAGE(coroutines);
+    lua_mem_tag_scope mem_tag(lua_mem_tag::coroutine);
+
     lua_State* state = m_state.get_state();
     save_stack_top ss(state);
 
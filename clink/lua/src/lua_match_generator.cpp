@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "lua_match_generator.h"
+#include "lua_allocator.h"
 #include "lua_bindable.h"
 #include "lua_script_loader.h"
 #include "lua_state.h"
@@ -11,7 +12,7 @@
 #include "match_builder_lua.h"
 
 #include <core/str_hash.h>
-#include <core/str_unordered_set.h>
+#include <core/flat_hash_map.h>
 #include <core/str_compare.h>
 #include <core/os.h>
 #include <lib/line_state.h>
@@ -44,6 +45,8 @@ lua_match_generator::~lua_match_generator()
 //------------------------------------------------------------------------------
 bool lua_match_generator::generate(const line_states& lines, match_builder& builder, bool old_filtering)
 {
+    lua_mem_tag_scope mem_tag(lua_mem_tag::generate);
+
     lua_State* state = m_state.get_state();
     save_stack_top ss(state);
 
@@ -242,6 +245,22 @@ done:
                 lua_rawset(state, -3);
             }
 
+            match_file_info file_info;
+            if (details.get_file_info(file_info))
+            {
+                lua_pushliteral(state, "size");
+                lua_pushnumber(state, lua_Number(file_info.size));
+                lua_rawset(state, -3);
+
+                lua_pushliteral(state, "mtime");
+                lua_pushnumber(state, lua_Number(file_info.mtime));
+                lua_rawset(state, -3);
+
+                lua_pushliteral(state, "attr");
+                lua_pushinteger(state, file_info.attr);
+                lua_rawset(state, -3);
+            }
+
             lua_rawseti(state, -2, i);
         }
 
@@ -283,6 +302,8 @@ done:
             match_type type = match_type::none;
             char append_char = 0;
             unsigned char flags = 0;
+            match_file_info file_info;
+            const match_file_info* file_info_ptr = nullptr;
 
             if (lua_istable(state, -1))
             {
@@ -336,6 +357,9 @@ done:
                         flags |= MATCH_FLAG_SUPPRESS_APPEND;
                 }
                 lua_pop(state, 1);
+
+                if (get_match_file_info_from_table(state, -1, type, file_info))
+                    file_info_ptr = &file_info;
             }
             else
             {
@@ -359,7 +383,7 @@ done:
                         lcd.truncate(matching);
                 }
 
-                const size_t packed_size = calc_packed_size(match, display, description);
+                const size_t packed_size = calc_packed_size(match, display, description, file_info_ptr);
                 const size_t alloc_size = sizeof(match_display_filter_entry) - 1 + packed_size;
 
                 match_display_filter_entry *new_match;
@@ -374,7 +398,7 @@ done:
                 j++;
 
                 // Fill in buffer with PACKED MATCH FORMAT.
-                if (!display[0] || !pack_match(buffer, packed_size, match, type, display, description, append_char, flags, new_match, strip_markup))
+                if (!display[0] || !pack_match(buffer, packed_size, match, type, display, description, append_char, flags, new_match, strip_markup, false, file_info_ptr))
                 {
                     free(new_match);
                     j--;
@@ -431,7 +455,7 @@ next:
         const int debug_filter = dbg_get_env_int("DEBUG_FILTER");
 #endif
 
-        str_unordered_set seen;
+        str_flat_set seen;
         unsigned int tortoise = 1;
         unsigned int hare = 1;
         while (new_matches[hare])
@@ -439,7 +463,7 @@ next:
             const char* display = new_matches[hare]->display;
             if (!display || !*display)
                 display = new_matches[hare]->match;
-            if (seen.find(display) != seen.end())
+            if (seen.contains(display))
             {
 #ifdef DEBUG
                 if (debug_filter)
@@ -546,7 +570,7 @@ bool lua_match_generator::filter_matches(char** matches, char completion_type, b
         return false;
 
     // Hash the filtered matches to be kept.
-    str_unordered_set keep_typeless;
+    str_flat_set keep_typeless;
     int num_matches = int(lua_rawlen(state, -1));
     for (int i = 1; i <= num_matches; ++i)
     {
@@ -591,7 +615,7 @@ bool lua_match_generator::filter_matches(char** matches, char completion_type, b
     char** write = &matches[!only_lcd];
     while (*read)
     {
-        if (keep_typeless.find(*read) == keep_typeless.end())
+        if (!keep_typeless.contains(*read))
         {
             discarded = true;
             free(*read);
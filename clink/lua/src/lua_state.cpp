@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "lua_state.h"
+#include "lua_allocator.h"
 #include "lua_script_loader.h"
 #include "rl_buffer_lua.h"
 #include "line_state_lua.h"
@@ -173,6 +174,16 @@ const char* optstring(lua_State* state, int index, const char* default_value)
 
 
 
+//------------------------------------------------------------------------------
+// Same as the panic function luaL_newstate() uses.
+static int panic(lua_State* L)
+{
+    luai_writestringerror("PANIC: unprotected error in call to Lua API (%s)\n", lua_tostring(L, -1));
+    return 0;
+}
+
+
+
 //------------------------------------------------------------------------------
 bool lua_state::s_in_luafunc = false;
 
@@ -195,9 +206,16 @@ void lua_state::initialise()
     shutdown();
 
     // Create a new Lua state.
-    m_state = luaL_newstate();
+    m_allocator = std::make_unique<lua_allocator>();
+    m_state = lua_newstate(lua_allocator::alloc, m_allocator.get());
+    lua_atpanic(m_state, panic);
     luaL_openlibs(m_state);
 
+    // Generational mode does full collections; incremental mode spreads the
+    // work across allocations, and idle_gc_step() does more of it while
+    // waiting for input.
+    lua_gc(m_state, LUA_GCINC, 0);
+
     // Set up the package.path value for require() statements.
     str<280> path;
     if (!os::get_env("lua_path_" LUA_VERSION_MAJOR "_" LUA_VERSION_MINOR, path))
@@ -258,6 +276,38 @@ void lua_state::shutdown()
 
     lua_close(m_state);
     m_state = nullptr;
+    m_allocator.reset();
+}
+
+//------------------------------------------------------------------------------
+// Allocations trigger collector steps, so keystrokes that allocate a lot also
+// do collection work.  Doing steps while waiting for input keeps the collector
+// ahead, so fewer and smaller steps land inside keystrokes.
+static const size_t c_idle_gc_threshold = 64 * 1024;
+static const int c_idle_gc_steps = 8;
+static const int c_idle_gc_step_kb = 16;
+
+//------------------------------------------------------------------------------
+bool lua_state::has_idle_gc_work() const
+{
+    return m_allocator && m_allocator->get_allocated_since_gc() >= c_idle_gc_threshold;
+}
+
+//------------------------------------------------------------------------------
+void lua_state::idle_gc_step()
+{
+    if (!m_state)
+        return;
+
+    for (int i = 0; i < c_idle_gc_steps; ++i)
+    {
+        // Returns 1 when a cycle finishes.
+        if (lua_gc(m_state, LUA_GCSTEP, c_idle_gc_step_kb))
+        {
+            m_allocator->reset_allocated_since_gc();
+            break;
+        }
+    }
 }
 
 //------------------------------------------------------------------------------
@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "lua_word_classifier.h"
+#include "lua_allocator.h"
 #include "lua_state.h"
 #include "line_states_lua.h"
 
@@ -56,6 +57,8 @@ lua_word_classifier::lua_word_classifier(lua_state& state)
 //------------------------------------------------------------------------------
 void lua_word_classifier::classify(const line_states& commands, word_classifications& classifications)
 {
+    lua_mem_tag_scope mem_tag(lua_mem_tag::classify);
+
     lua_State* state = m_state.get_state();
     save_stack_top ss(state);
 
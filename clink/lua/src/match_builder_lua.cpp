@@ -4,11 +4,18 @@
 #include "pch.h"
 #include "match_builder_lua.h"
 #include "lua_state.h"
+#include "exec_catalog.h"
 
 #include <core/base.h>
+#include <core/os.h>
+#include <core/settings.h>
 #include <core/str.h>
 #include <lib/matches.h>
 
+//------------------------------------------------------------------------------
+extern setting_bool g_glob_hidden;
+extern setting_bool g_glob_system;
+
 //------------------------------------------------------------------------------
 const char* const match_builder_lua::c_name = "match_builder_lua";
 const match_builder_lua::method match_builder_lua::c_methods[] = {
@@ -26,6 +33,7 @@ const match_builder_lua::method match_builder_lua::c_methods[] = {
     // UNDOCUMENTED; internal use only.
     { "clear_toolkit",      &clear_toolkit },
     { "matches_ready",      &matches_ready },
+    { "addexecutables",     &add_executables },
     {}
 };
 
@@ -71,6 +79,9 @@ match_builder_lua::~match_builder_lua()
 /// -show:  &nbsp;   type            = "..."    -- [string] OPTIONAL; the match type.
 /// -show:  &nbsp;   appendchar      = "..."    -- [string] OPTIONAL; character to append after the match.
 /// -show:  &nbsp;   suppressappend  = t_or_f   -- [boolean] OPTIONAL; whether to suppress appending a character after the match.
+/// -show:  &nbsp;   size            = 123      -- [number] OPTIONAL; the file size, in bytes.
+/// -show:  &nbsp;   mtime           = 123      -- [number] OPTIONAL; the modified time, compatible with os.time().
+/// -show:  &nbsp;   attr            = 123      -- [number] OPTIONAL; the FILE_ATTRIBUTE_* flags.
 /// -show:  }
 ///
 /// <ul>
@@ -86,6 +97,13 @@ match_builder_lua::~match_builder_lua()
 /// behavior for only this match.  (Requires v1.3.1 or greater.)
 /// <li>The <code>suppressappend</code> field is optional, and overrides the
 /// normal behavior for only this match.  (Requires v1.3.1 or greater.)
+/// <li>The <code>size</code>, <code>mtime</code>, and <code>attr</code> fields
+/// are optional, and only apply to "file" or "dir" matches.  They are the same as the fields
+/// returned by <a href="#os.globfiles">os.globfiles()</a> when its
+/// <span class="arg">extrainfo</span> argument is 2, and are passed along to
+/// <a href="#clink.ondisplaymatches">clink.ondisplaymatches()</a> handlers so
+/// they don't need to access the file system again.  (Requires v1.4.9 or
+/// greater.)
 /// </ul>
 ///
 /// The match type affects how the match is inserted, displayed, and colored.
@@ -275,6 +293,56 @@ int match_builder_lua::clear_toolkit(lua_State* state)
     return 0;
 }
 
+//------------------------------------------------------------------------------
+// UNDOCUMENTED; internal use only.
+// Adds executables from PATH whose names start with the prefix, using the
+// executable catalog.  Returns nothing if the catalog isn't ready, otherwise
+// returns the number of executables found and whether any matches were added.
+int match_builder_lua::add_executables(lua_State* state)
+{
+    const char* prefix = optstring(state, 1, "");
+    if (!prefix)
+        return 0;
+
+    str<> path;
+    str<> pathext;
+    os::get_env("path", path);
+    os::get_env("pathext", pathext);
+
+    auto snapshot = exec_catalog::get_instance().get(path.c_str(), pathext.c_str());
+    if (!snapshot)
+        return 0;
+
+    const bool hidden = g_glob_hidden.get();
+    const bool system = g_glob_system.get();
+
+    unsigned int begin, end;
+    snapshot->find_range(prefix, begin, end);
+
+    bool added = false;
+    unsigned int found = 0;
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        const exec_catalog_snapshot::entry& e = (*snapshot)[i];
+        if ((!hidden && (e.attr & FILE_ATTRIBUTE_HIDDEN)) ||
+            (!system && (e.attr & FILE_ATTRIBUTE_SYSTEM)))
+            continue;
+
+        match_type type = match_type::file;
+        if (e.attr & FILE_ATTRIBUTE_HIDDEN)
+            type |= match_type::hidden;
+        if (e.attr & FILE_ATTRIBUTE_READONLY)
+            type |= match_type::readonly;
+
+        added = m_builder->add_match(e.name, type) || added;
+        ++found;
+    }
+
+    lua_pushinteger(state, found);
+    lua_pushboolean(state, added);
+    return 2;
+}
+
 //------------------------------------------------------------------------------
 // UNDOCUMENTED; internal use only.
 int match_builder_lua::matches_ready(lua_State* state)
@@ -343,6 +411,55 @@ int match_builder_lua::add_matches(lua_State* state)
     return 2;
 }
 
+//------------------------------------------------------------------------------
+bool get_match_file_info_from_table(lua_State* state, int stack_index, match_type type, match_file_info& out)
+{
+    if (!is_pathish(type))
+        return false;
+
+    stack_index = lua_absindex(state, stack_index);
+
+    bool any = false;
+
+    lua_pushliteral(state, "size");
+    lua_rawget(state, stack_index);
+    out.size = lua_isnumber(state, -1) ? static_cast<unsigned long long>(lua_tonumber(state, -1)) : 0;
+    any |= !lua_isnil(state, -1);
+    lua_pop(state, 1);
+
+    lua_pushliteral(state, "mtime");
+    lua_rawget(state, stack_index);
+    out.mtime = lua_isnumber(state, -1) ? static_cast<long long>(lua_tonumber(state, -1)) : 0;
+    any |= !lua_isnil(state, -1);
+    lua_pop(state, 1);
+
+    lua_pushliteral(state, "attr");
+    lua_rawget(state, stack_index);
+    const bool has_attr = lua_isnumber(state, -1);
+    out.attr = has_attr ? static_cast<unsigned int>(lua_tointeger(state, -1)) : 0;
+    any |= has_attr;
+    lua_pop(state, 1);
+
+    if (!any)
+        return false;
+
+    // Without the attributes from enumeration, fall back to the ones implied
+    // by the match type.
+    if (!has_attr)
+    {
+        out.attr = is_match_type(type, match_type::dir) ? FILE_ATTRIBUTE_DIRECTORY : FILE_ATTRIBUTE_NORMAL;
+        if (is_match_type_hidden(type))
+            out.attr |= FILE_ATTRIBUTE_HIDDEN;
+        if (is_match_type_readonly(type))
+            out.attr |= FILE_ATTRIBUTE_READONLY;
+        if (is_match_type_link(type))
+            out.attr |= FILE_ATTRIBUTE_REPARSE_POINT;
+    }
+    out.symlink = is_match_type_link(type);
+    out.orphaned = is_match_type_orphaned(type);
+    return true;
+}
+
 //------------------------------------------------------------------------------
 bool match_builder_lua::add_match_impl(lua_State* state, int stack_index, match_type type)
 {
@@ -406,6 +523,10 @@ bool match_builder_lua::add_match_impl(lua_State* state, int stack_index, match_
                 desc.append_display = lua_toboolean(state, -1);
             lua_pop(state, 1);
 
+            match_file_info file_info;
+            if (get_match_file_info_from_table(state, orig_stack_index, desc.type, file_info))
+                desc.file_info = &file_info;
+
             // If the table defines a match, add the match.
             if (desc.match != nullptr)
                 return m_builder->add_match(desc);
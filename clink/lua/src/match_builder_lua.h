@@ -10,6 +10,7 @@
 class match_builder;
 struct lua_State;
 enum class match_type : unsigned char;
+struct match_file_info;
 
 //------------------------------------------------------------------------------
 class match_builder_lua
@@ -33,6 +34,7 @@ public:
 
     int             clear_toolkit(lua_State* state);
     int             matches_ready(lua_State* state);
+    int             add_executables(lua_State* state);
 
 private:
     bool            add_match_impl(lua_State* state, int stack_index, match_type type);
@@ -43,3 +45,6 @@ private:
     static const char* const c_name;
     static const method c_methods[];
 };
+
+//------------------------------------------------------------------------------
+bool get_match_file_info_from_table(lua_State* state, int stack_index, match_type type, match_file_info& out);
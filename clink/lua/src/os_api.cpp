@@ -8,12 +8,14 @@
 
 #include <core/base.h>
 #include <core/globber.h>
+#include <core/recursive_globber.h>
 #include <core/os.h>
 #include <core/path.h>
 #include <core/settings.h>
 #include <core/str.h>
 #include <core/str_iter.h>
 #include <lib/doskey.h>
+#include <terminal/terminal_helpers.h>
 #include <process/process.h>
 #include <sys/utime.h>
 #include <ntverp.h> // for VER_PRODUCTMAJORVERSION to deduce SDK version
@@ -26,14 +28,14 @@ extern "C" {
 #include <memory>
 
 //------------------------------------------------------------------------------
-static setting_bool g_glob_hidden(
+setting_bool g_glob_hidden(
     "files.hidden",
     "Include hidden files",
     "Includes or excludes files with the 'hidden' attribute set when generating\n"
     "file lists.",
     true);
 
-static setting_bool g_glob_system(
+setting_bool g_glob_system(
     "files.system",
     "Include system files",
     "Includes or excludes files with the 'system' attribute set when generating\n"
@@ -178,6 +180,99 @@ int globber_lua::close(lua_State* state)
 
 
 
+//------------------------------------------------------------------------------
+class recursive_globber_lua
+    : public lua_bindable<recursive_globber_lua>
+{
+public:
+                        recursive_globber_lua(const char* pattern, int extrainfo);
+    int                 next(lua_State* state);
+    int                 close(lua_State* state);
+
+private:
+    recursive_globber   m_globber;
+    str<16>             m_parent;
+    int                 m_extrainfo;
+
+    friend class lua_bindable<recursive_globber_lua>;
+    static const char* const c_name;
+    static const method c_methods[];
+};
+
+//------------------------------------------------------------------------------
+const char* const recursive_globber_lua::c_name = "recursive_globber_lua";
+const recursive_globber_lua::method recursive_globber_lua::c_methods[] = {
+    { "next",                   &next },
+    { "close",                  &close },
+    {}
+};
+
+//------------------------------------------------------------------------------
+recursive_globber_lua::recursive_globber_lua(const char* pattern, int extrainfo)
+: m_globber(pattern)
+, m_extrainfo(extrainfo)
+{
+    m_globber.hidden(g_glob_hidden.get());
+    m_globber.system(g_glob_system.get());
+}
+
+//------------------------------------------------------------------------------
+static void push_glob_entry(lua_State* state, const char* file, unsigned int len, const globber::extrainfo* info, str_base& parent, int extrainfo);
+int recursive_globber_lua::next(lua_State* state)
+{
+    // Arg 1 is table into which to append results.  Arg 2 is whether to wait
+    // until at least one result is available.
+
+    const bool wait = lua_toboolean(state, 2);
+    lua_settop(state, 1);
+
+    const DWORD ms_max = 20;
+    const DWORD num_max = 250;
+    const DWORD tick = GetTickCount();
+
+    str<288> file;
+    globber::extrainfo info;
+    int index = int(lua_rawlen(state, 1)) + 1;
+    for (size_t c = 0; c < num_max;)
+    {
+        if (!m_globber.next(file, &info, (wait && !c) ? 20 : 0))
+        {
+            if (m_globber.is_done())
+            {
+                lua_pushboolean(state, false);
+                return 1;
+            }
+            if (!wait || c)
+                break;
+            if (clink_is_signaled())
+            {
+                m_globber.cancel();
+                lua_pushboolean(state, false);
+                return 1;
+            }
+            continue;
+        }
+
+        push_glob_entry(state, file.c_str(), file.length(), &info, m_parent, m_extrainfo);
+        lua_rawseti(state, -2, index++);
+
+        if (++c % 5 == 0 && GetTickCount() - tick > ms_max)
+            break;
+    }
+
+    lua_pushboolean(state, true);
+    return 1;
+}
+
+//------------------------------------------------------------------------------
+int recursive_globber_lua::close(lua_State* state)
+{
+    m_globber.cancel();
+    return 0;
+}
+
+
+
 //------------------------------------------------------------------------------
 struct execute_thread : public yield_thread
 {
@@ -464,24 +559,20 @@ static void add_type_tag(str_base& out, const char* tag)
 }
 
 //------------------------------------------------------------------------------
-static bool glob_next(lua_State* state, globber& globber, str_base& parent, int& index, int extrainfo)
+static void push_glob_entry(lua_State* state, const char* file, unsigned int len, const globber::extrainfo* _info, str_base& parent, int extrainfo)
 {
-    str<288> file;
-    globber::extrainfo info;
-    globber::extrainfo* info_ptr = extrainfo ? &info : nullptr;
-    if (!globber.next(file, false, info_ptr))
-        return false;
-
     if (!extrainfo)
     {
-        lua_pushlstring(state, file.c_str(), file.length());
+        lua_pushlstring(state, file, len);
     }
     else
     {
+        const globber::extrainfo& info = *_info;
+
         lua_createtable(state, 0, 2);
 
         lua_pushliteral(state, "name");
-        lua_pushlstring(state, file.c_str(), file.length());
+        lua_pushlstring(state, file, len);
         lua_rawset(state, -3);
 
         str<32> type;
@@ -489,8 +580,8 @@ static bool glob_next(lua_State* state, globber& globber, str_base& parent, int&
 #ifdef S_ISLNK
         if (S_ISLNK(info.st_mode))
         {
-            unsigned int len = parent.length();
-            path::append(parent, file.c_str());
+            const unsigned int parent_len = parent.length();
+            path::append(parent, file);
 
             add_type_tag(type, "link");
             wstr<288> wfile(parent.c_str());
@@ -498,7 +589,7 @@ static bool glob_next(lua_State* state, globber& globber, str_base& parent, int&
             if (_wstat64(wfile.c_str(), &st) < 0)
                 add_type_tag(type, "orphaned");
 
-            parent.truncate(len);
+            parent.truncate(parent_len);
         }
 #endif
         if (info.attr & FILE_ATTRIBUTE_HIDDEN)
@@ -527,9 +618,24 @@ static bool glob_next(lua_State* state, globber& globber, str_base& parent, int&
             lua_pushliteral(state, "size");
             lua_pushnumber(state, lua_Number(info.size));
             lua_rawset(state, -3);
+
+            lua_pushliteral(state, "attr");
+            lua_pushinteger(state, info.attr);
+            lua_rawset(state, -3);
         }
     }
+}
+
+//------------------------------------------------------------------------------
+static bool glob_next(lua_State* state, globber& globber, str_base& parent, int& index, int extrainfo)
+{
+    str<288> file;
+    globber::extrainfo info;
+    globber::extrainfo* info_ptr = extrainfo ? &info : nullptr;
+    if (!globber.next(file, false, info_ptr))
+        return false;
 
+    push_glob_entry(state, file.c_str(), file.length(), info_ptr, parent, extrainfo);
     lua_rawseti(state, -2, index++);
     return true;
 }
@@ -624,6 +730,8 @@ int globber_impl(lua_State* state, bool dirs_only, bool back_compat=false)
 /// -show:  --   t[index].atime     -- [number] The access time, compatible with os.time().
 /// -show:  --   t[index].mtime     -- [number] The modified time, compatible with os.time().
 /// -show:  --   t[index].ctime     -- [number] The creation time, compatible with os.time().
+/// -show:  -- Included when extrainfo is 2 (requires v1.4.9 or higher):
+/// -show:  --   t[index].attr      -- [number] The FILE_ATTRIBUTE_* flags.
 /// The <span class="tablescheme">type</span> string is "dir", and may also
 /// contain ",hidden", ",readonly", ",link", and ",orphaned" depending on the
 /// attributes (making it usable as a match type for
@@ -660,6 +768,8 @@ int glob_dirs(lua_State* state)
 /// -show:  --   t[index].atime     -- [number] The access time, compatible with os.time().
 /// -show:  --   t[index].mtime     -- [number] The modified time, compatible with os.time().
 /// -show:  --   t[index].ctime     -- [number] The creation time, compatible with os.time().
+/// -show:  -- Included when extrainfo is 2 (requires v1.4.9 or higher):
+/// -show:  --   t[index].attr      -- [number] The FILE_ATTRIBUTE_* flags.
 /// The <span class="tablescheme">type</span> string can be "file" or "dir", and
 /// may also contain ",hidden", ",readonly", ",link", and ",orphaned" depending
 /// on the attributes (making it usable as a match type for
@@ -687,6 +797,25 @@ int make_file_globber(lua_State* state)
     return globber_impl(state, false);
 }
 
+//------------------------------------------------------------------------------
+int make_recursive_globber(lua_State* state)
+{
+    const char* mask = checkstring(state, 1);
+    if (!mask)
+        return 0;
+
+    int extrainfo;
+    if (lua_isboolean(state, 2))
+        extrainfo = lua_toboolean(state, 2);
+    else
+        extrainfo = optinteger(state, 2, 0);
+
+    if (!recursive_globber_lua::make_new(state, mask, extrainfo))
+        return 0;
+
+    return 1;
+}
+
 //------------------------------------------------------------------------------
 /// -name:  os.touch
 /// -ver:   1.2.31
@@ -1016,6 +1145,7 @@ int get_screen_info_impl(lua_State* state, bool back_compat)
     int values[4];
     CONSOLE_SCREEN_BUFFER_INFO csbi;
 
+    flush_printer_frame();
     GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi);
     values[0] = csbi.dwSize.X;
     values[1] = csbi.dwSize.Y;
@@ -1557,6 +1687,7 @@ void os_lua_initialise(lua_state& lua)
         { "_globfiles",  &glob_files }, // Public os.globfiles method is in core.lua.
         { "_makedirglobber", &make_dir_globber },
         { "_makefileglobber", &make_file_globber },
+        { "_makerecursiveglobber", &make_recursive_globber }, // Public os.globrecursive method is in core.lua.
     };
 
     lua_State* state = lua.get_state();
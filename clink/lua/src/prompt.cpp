@@ -5,10 +5,13 @@
 #include "prompt.h"
 
 #include <core/base.h>
+#include <core/log.h>
 #include <core/str.h>
 #include <core/str_iter.h>
 #include <core/os.h>
 #include <lib/line_buffer.h>
+#include <terminal/terminal_helpers.h>
+#include "lua_allocator.h"
 #include "lua_script_loader.h"
 #include "lua_state.h"
 
@@ -397,6 +400,9 @@ void prompt_filter::filter(const char* in, str_base& out)
 //------------------------------------------------------------------------------
 void prompt_filter::filter(const char* in, const char* rin, str_base& out, str_base& rout, bool transient, bool final)
 {
+    TRACE_SCOPE("prompt", "filter");
+    lua_mem_tag_scope mem_tag(lua_mem_tag::prompt_filter);
+
     lua_State* state = m_lua.get_state();
 
     int top = lua_gettop(state);
@@ -445,6 +451,8 @@ void prompt_filter::filter(const char* in, const char* rin, str_base& out, str_b
 //------------------------------------------------------------------------------
 prompt prompt_utils::extract_from_console()
 {
+    flush_printer_frame();
+
     // Find where the cursor is. This will be the end of the prompt to extract.
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     HANDLE handle = GetStdHandle(STD_OUTPUT_HANDLE);
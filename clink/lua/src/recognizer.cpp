@@ -9,9 +9,8 @@
 #include <core/str.h>
 #include <core/str_iter.h>
 #include <core/str_tokeniser.h>
-#include <core/str_unordered_set.h>
+#include <core/flat_hash_map.h>
 #include <core/settings.h>
-#include <core/linear_allocator.h>
 #include <core/debugheap.h>
 #include <lib/intercept.h>
 #include <lib/reclassify.h>
@@ -191,9 +190,8 @@ private:
     static void             proc(recognizer* r);
 
 private:
-    linear_allocator        m_heap;
-    str_unordered_map<cache_entry> m_cache;
-    str_unordered_map<cache_entry> m_pending;
+    str_flat_map<cache_entry> m_cache;
+    str_flat_map<cache_entry> m_pending;
     entry                   m_queue;
     mutable std::recursive_mutex m_mutex;
     std::unique_ptr<std::thread> m_thread;
@@ -219,7 +217,8 @@ void recognizer::entry::clear()
 
 //------------------------------------------------------------------------------
 recognizer::recognizer()
-: m_heap(1024)
+: m_cache(1024)
+, m_pending(1024)
 {
 #ifdef DEBUG
     // Singleton; assert if there's ever more than one.
@@ -239,7 +238,6 @@ void recognizer::clear()
     m_queue.clear();
     m_cache.clear();
     m_pending.clear();
-    m_heap.reset();
 }
 
 //------------------------------------------------------------------------------
@@ -249,24 +247,22 @@ int recognizer::find(const char* key, recognition& cached, str_base* file) const
 
     if (usable())
     {
-        auto const iter = m_cache.find(key);
-        if (iter != m_cache.end())
+        if (const cache_entry* found = m_cache.find(key))
         {
-            cached = iter->second.m_recognition;
+            cached = found->m_recognition;
             if (file)
-                *file = iter->second.m_file.c_str();
+                *file = found->m_file.c_str();
             return 1;
         }
     }
 
     if (usable())
     {
-        auto const iter = m_pending.find(key);
-        if (iter != m_pending.end())
+        if (const cache_entry* found = m_pending.find(key))
         {
-            cached = iter->second.m_recognition;
+            cached = found->m_recognition;
             if (file)
-                *file = iter->second.m_file.c_str(); // Always empty.
+                *file = found->m_file.c_str(); // Always empty.
             return -1;
         }
     }
@@ -379,26 +375,15 @@ bool recognizer::store(const char* word, const char* file, recognition cached, b
 
     auto& map = pending ? m_pending : m_cache;
 
-    auto const iter = map.find(word);
-    if (iter != map.end())
-    {
-        cache_entry entry;
-        entry.m_file = file;
-        entry.m_recognition = cached;
-        map.insert_or_assign(iter->first, std::move(entry));
-        set_result_available(true);
-        return true;
-    }
+    cache_entry entry;
+    entry.m_file = file;
+    entry.m_recognition = cached;
 
+    // The map copies new keys into its own arena.
     dbg_ignore_scope(snapshot, "Recognizer");
-    const char* key = m_heap.store(word);
-    if (!key)
+    if (!map.insert_or_assign(word, std::move(entry)))
         return false;
 
-    cache_entry entry;
-    entry.m_file = file;
-    entry.m_recognition = cached;
-    map.emplace(key, std::move(entry));
     set_result_available(true);
     return true;
 }
@@ -12,6 +12,7 @@
 #include <core/str_compare.h>
 #include <core/str_iter.h>
 #include <terminal/ecma48_iter.h>
+#include <terminal/terminal_helpers.h>
 #include "lib/matches.h"
 #include "lib/display_matches.h"
 #include "match_builder_lua.h"
@@ -37,6 +38,7 @@ extern const char* get_last_luafunc();
 extern void override_rl_last_func(rl_command_func_t* func, bool force_when_null=false);
 
 extern int count_prompt_lines(const char* prompt_prefix);
+extern void load_deferred_history();
 
 
 
@@ -846,6 +848,8 @@ static int get_prompt_info(lua_State* state)
         lua_rawset(state, -3);
     }
 
+    flush_printer_frame();
+
     CONSOLE_SCREEN_BUFFER_INFO csbi;
     if (GetConsoleScreenBufferInfo(GetStdHandle(STD_OUTPUT_HANDLE), &csbi))
     {
@@ -1006,6 +1010,7 @@ static int get_match_color(lua_State* state)
 /// Returns the number of history items.
 static int get_history_count(lua_State* state)
 {
+    load_deferred_history();
     lua_pushinteger(state, history_length);
     return 1;
 }
@@ -1040,6 +1045,7 @@ static int get_history_items(lua_State* state)
     if (!isnum)
         return 0;
 
+    load_deferred_history();
     if (start >= history_length || end < 1)
         return 0;
     if (start < 0)
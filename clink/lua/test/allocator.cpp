@@ -0,0 +1,88 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <lua/lua_allocator.h>
+#include <lua/lua_state.h>
+
+extern "C" {
+#include <lua.h>
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Lua allocator")
+{
+    SECTION("Blocks")
+    {
+        lua_allocator allocator;
+        void* ud = &allocator;
+
+        char* a = static_cast<char*>(lua_allocator::alloc(ud, nullptr, LUA_TSTRING, 10));
+        REQUIRE(a);
+        memcpy(a, "abcdefghi", 10);
+
+        // Growing within the size class keeps the block.
+        REQUIRE(lua_allocator::alloc(ud, a, 10, 16) == a);
+
+        // Growing past it moves the block and keeps the contents.
+        char* b = static_cast<char*>(lua_allocator::alloc(ud, a, 16, 100));
+        REQUIRE(b);
+        REQUIRE(b != a);
+        REQUIRE(strcmp(b, "abcdefghi") == 0);
+
+        // The freed block is reused for the next allocation of its class.
+        char* c = static_cast<char*>(lua_allocator::alloc(ud, nullptr, LUA_TTABLE, 12));
+        REQUIRE(c == a);
+
+        // Large blocks.
+        char* d = static_cast<char*>(lua_allocator::alloc(ud, b, 100, 1000));
+        REQUIRE(d);
+        REQUIRE(strcmp(d, "abcdefghi") == 0);
+        d = static_cast<char*>(lua_allocator::alloc(ud, d, 1000, 20));
+        REQUIRE(d);
+        REQUIRE(strcmp(d, "abcdefghi") == 0);
+
+        lua_alloc_stats stats;
+        allocator.get_stats(stats);
+        REQUIRE(stats.in_use == 12 + 20);
+        REQUIRE(stats.large_in_use == 0);
+
+        lua_allocator::alloc(ud, c, 12, 0);
+        lua_allocator::alloc(ud, d, 20, 0);
+        allocator.get_stats(stats);
+        REQUIRE(stats.in_use == 0);
+    }
+
+    SECTION("Lua state")
+    {
+        lua_state lua;
+        lua_allocator* allocator = lua_allocator::get_active();
+        REQUIRE(allocator);
+
+        lua_alloc_stats before;
+        allocator->get_stats(before);
+
+        {
+            lua_mem_tag_scope tag(lua_mem_tag::generate);
+            REQUIRE(lua.do_string("_t = {} for i = 1, 10000 do _t[i] = 'item'..i end"));
+        }
+
+        lua_alloc_stats after;
+        allocator->get_stats(after);
+        const int generate = int(lua_mem_tag::generate);
+        REQUIRE(after.allocs[generate] >= before.allocs[generate] + 10000);
+        REQUIRE(after.in_use > before.in_use);
+
+        // Idle steps eventually finish a collection cycle.
+        REQUIRE(lua.do_string("_t = nil"));
+        REQUIRE(lua.has_idle_gc_work());
+        for (int i = 0; i < 1000 && lua.has_idle_gc_work(); ++i)
+            lua.idle_gc_step();
+        REQUIRE(!lua.has_idle_gc_work());
+
+        lua_gc(lua.get_state(), LUA_GCCOLLECT, 0);
+        allocator->get_stats(after);
+        REQUIRE(after.free_bytes > 0);
+    }
+}
@@ -877,6 +877,34 @@ TEST_CASE("Lua arg parsers")
         }
     }
 
+    SECTION("Cache")
+    {
+        const char* script = "\
+            local calls = 0\
+            function cached_calls() return calls end\
+            clink.argmatcher('cached'):addarg({ cache=true, function () calls = calls + 1 return { 'abc', 'abd' } end })\
+        ";
+
+        REQUIRE(lua.do_string(script));
+
+        lua.send_event("onbeginedit");
+        tester.set_input("cached a");
+        tester.set_expected_matches("abc", "abd");
+        tester.run();
+
+        tester.set_input("cached ab");
+        tester.set_expected_matches("abc", "abd");
+        tester.run();
+        REQUIRE(lua.do_string("if cached_calls() ~= 1 then error('expected 1 call') end"));
+
+        // A new edit line invalidates cache=true entries.
+        lua.send_event("onbeginedit");
+        tester.set_input("cached a");
+        tester.set_expected_matches("abc", "abd");
+        tester.run();
+        REQUIRE(lua.do_string("if cached_calls() ~= 2 then error('expected 2 calls') end"));
+    }
+
     SECTION("Adaptive")
     {
         const char* script = "\
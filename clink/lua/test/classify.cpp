@@ -160,6 +160,18 @@ TEST_CASE("Lua word classification")
             tester.run();
         }
 
+        SECTION("Burst")
+        {
+            // Pasted text defers classifying until the burst ends, and then
+            // the whole line is classified at once.
+            tester.set_burst(true);
+            tester.set_input("xyz --bee abc zzz");
+            tester.set_expected_burst_classifications("");
+            tester.set_expected_classifications("ofan");
+            tester.run();
+            tester.set_burst(false);
+        }
+
         SECTION("Flags unrecognized flag")
         {
             // An unrecognized flag is not counted as an arg.
@@ -254,6 +266,27 @@ TEST_CASE("Lua word classification")
             tester.run();
         }
 
+        SECTION("Resumed traversal")
+        {
+            // Typing more words resumes parsing from the cached state of the
+            // preceding words; editing a preceding word must not.
+            tester.set_input("argcmd three four f");
+            tester.set_expected_classifications("oaao");
+            tester.run();
+
+            tester.set_input("argcmd three four five");
+            tester.set_expected_classifications("oaaa");
+            tester.run();
+
+            tester.set_input("argcmd three four five six");
+            tester.set_expected_classifications("oaaaa");
+            tester.run();
+
+            tester.set_input("argcmd one four five");
+            tester.set_expected_classifications("oaoo");
+            tester.run();
+        }
+
         SECTION("Quoted traversal 1")
         {
             tester.set_input("argcmd \"three\" four ");
@@ -0,0 +1,127 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "fs_fixture.h"
+
+#include <core/os.h>
+#include <core/path.h>
+#include <core/str.h>
+#include <lua/exec_catalog.h>
+
+//------------------------------------------------------------------------------
+static void get_range(const exec_catalog_snapshot& snapshot, const char* prefix, str_base& out)
+{
+    out.clear();
+
+    unsigned int begin, end;
+    snapshot.find_range(prefix, begin, end);
+    for (unsigned int i = begin; i < end; ++i)
+    {
+        if (out.length())
+            out.concat(";", 1);
+        out.concat(snapshot[i].name);
+    }
+}
+
+//------------------------------------------------------------------------------
+TEST_CASE("Exec catalog")
+{
+    static const char* catalog_fs[] = {
+        "bin1/abc.exe",
+        "bin1/abd.cmd",
+        "bin1/readme.txt",
+        "bin2/ABC.EXE",
+        "bin2/x-y.bat",
+        "bin2/x_z.bat",
+        nullptr,
+    };
+
+    fs_fixture fs(catalog_fs);
+
+    str<> cwd;
+    os::get_current_dir(cwd);
+
+    str<> bin1, bin2, file;
+    path::join(cwd.c_str(), "bin1", bin1);
+    path::join(cwd.c_str(), "bin2", bin2);
+    path::join(cwd.c_str(), "exec_catalog", file);
+
+    str<> path;
+    path << bin1 << ";" << bin2;
+    static const char pathext[] = ".COM;.EXE;.BAT;.CMD";
+
+    str<> names;
+
+    {
+        exec_catalog catalog(file.c_str());
+
+        // Nothing is known until the first scan finishes.
+        REQUIRE(!catalog.get(path.c_str(), pathext));
+        REQUIRE(catalog.wait(5000));
+
+        auto snapshot = catalog.get(path.c_str(), pathext);
+        REQUIRE(snapshot);
+
+        SECTION("Range")
+        {
+            // Only PATHEXT extensions, and the first in PATH order wins.
+            get_range(*snapshot, "", names);
+            REQUIRE(names.equals("abc.exe;abd.cmd;x-y.bat;x_z.bat"));
+
+            get_range(*snapshot, "AB", names);
+            REQUIRE(names.equals("abc.exe;abd.cmd"));
+
+            get_range(*snapshot, "abc", names);
+            REQUIRE(names.equals("abc.exe"));
+
+            // '-' and '_' are interchangeable.
+            get_range(*snapshot, "x_", names);
+            REQUIRE(names.equals("x-y.bat;x_z.bat"));
+
+            get_range(*snapshot, "q", names);
+            REQUIRE(names.empty());
+        }
+
+        SECTION("Relative")
+        {
+            REQUIRE(!catalog.get("bin1", pathext));
+        }
+
+        SECTION("Refresh")
+        {
+            // Directory timestamps have coarse resolution.
+            Sleep(50);
+
+            str<> added(bin1.c_str());
+            path::append(added, "new.exe");
+            FILE* f = fopen(added.c_str(), "wt");
+            REQUIRE(f);
+            fclose(f);
+
+            // The change is noticed in the background.
+            catalog.get(path.c_str(), pathext);
+            REQUIRE(catalog.wait(5000));
+
+            snapshot = catalog.get(path.c_str(), pathext);
+            REQUIRE(snapshot);
+            get_range(*snapshot, "n", names);
+            REQUIRE(names.equals("new.exe"));
+
+            os::unlink(added.c_str());
+        }
+    }
+
+    SECTION("Persisted")
+    {
+        exec_catalog catalog(file.c_str());
+
+        auto snapshot = catalog.get(path.c_str(), pathext);
+        REQUIRE(snapshot);
+        get_range(*snapshot, "ab", names);
+        REQUIRE(names.equals("abc.exe;abd.cmd"));
+        REQUIRE(catalog.wait(5000));
+    }
+
+    os::unlink(file.c_str());
+}
@@ -0,0 +1,46 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#pragma once
+
+//------------------------------------------------------------------------------
+// Maps RGB colors to the nearest of the 16 console palette colors, as judged
+// by CIE Lab delta E.  The palette is converted to Lab once when it's set, and
+// recent results are remembered in a small direct mapped table, so prompts
+// with many RGB colors don't redo the conversions on every redraw.
+class console_palette
+{
+public:
+                    console_palette() = default;
+
+    // Takes a palette in console order (as in CONSOLE_SCREEN_BUFFER_INFOEX).
+    // Returns false if the palette is unchanged.
+    bool            set_palette(const COLORREF (&table)[16]);
+    bool            has_palette() const { return m_has_palette; }
+
+    // Returns the nearest color as an ANSI color index (0-15).
+    unsigned char   get_nearest(const unsigned char (&rgb)[3]);
+
+private:
+    enum { memo_size = 256 };
+
+    struct memo_entry
+    {
+        unsigned int    key;    // RGB plus valid bit; zero is empty.
+        unsigned char   value;
+    };
+
+    struct lab_color
+    {
+        double          l;
+        double          a;
+        double          b;
+    };
+
+    unsigned char   find_nearest(const unsigned char (&rgb)[3]) const;
+
+    COLORREF        m_table[16] = {};
+    lab_color       m_lab[16] = {};
+    memo_entry      m_memo[memo_size] = {};
+    bool            m_has_palette = false;
+};
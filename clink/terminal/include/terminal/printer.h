@@ -5,6 +5,8 @@
 
 #include "attributes.h"
 
+#include <core/str.h>
+
 class terminal_out;
 class str_base;
 enum find_line_mode : int;
@@ -33,6 +35,13 @@ public:
     attributes              set_attributes(const attributes attr);
     attributes              get_attributes() const;
 
+    // Output between begin_frame() and end_frame() is collected and written to
+    // the terminal in one write when the outermost frame ends.  Code that reads
+    // or moves the console cursor directly must call flush_frame() first.
+    void                    begin_frame();
+    void                    end_frame();
+    void                    flush_frame() const;
+
 private: /* TODO: unimplemented API */
     typedef unsigned int    cursor_state;
     void                    insert(int count); // -count == delete characters.
@@ -42,10 +51,25 @@ private: /* TODO: unimplemented API */
 
 private:
     void                    flush_attributes();
+    void                    write(const char* data, int bytes);
     terminal_out&           m_terminal;
     attributes              m_set_attr;
     attributes              m_next_attr;
     bool                    m_nodiff;
+    int                     m_frame_depth = 0;
+    mutable str_moveable    m_frame;
+};
+
+//------------------------------------------------------------------------------
+// Scoped output frame; see printer::begin_frame().
+class printer_frame
+{
+public:
+                            printer_frame(printer& p) : m_printer(p) { m_printer.begin_frame(); }
+                            ~printer_frame() { m_printer.end_frame(); }
+                            printer_frame(const printer_frame&) = delete;
+private:
+    printer&                m_printer;
 };
 
 //------------------------------------------------------------------------------
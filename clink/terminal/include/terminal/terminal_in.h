@@ -24,4 +24,9 @@ public:
     virtual void    select(input_idle* callback=nullptr) = 0;
     virtual int     read() = 0;
     virtual key_tester* set_key_tester(key_tester* keys) = 0;
+
+    // Returns true when more plain text input is already waiting to be read,
+    // such as while text is being pasted.  The editor defers classifying,
+    // suggesting, and displaying until the burst ends.
+    virtual bool    in_burst() { return false; }
 };
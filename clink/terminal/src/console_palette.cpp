@@ -0,0 +1,69 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+#include "console_palette.h"
+#include "cielab.h"
+
+#include <core/base.h>
+
+//------------------------------------------------------------------------------
+static const unsigned int c_memo_valid = 0x01000000;
+
+//------------------------------------------------------------------------------
+bool console_palette::set_palette(const COLORREF (&table)[16])
+{
+    if (m_has_palette && memcmp(m_table, table, sizeof(m_table)) == 0)
+        return false;
+
+    memcpy(m_table, table, sizeof(m_table));
+    for (int i = 0; i < sizeof_array(m_table); ++i)
+    {
+        cie::lab lab(m_table[i]);
+        m_lab[i].l = lab.l;
+        m_lab[i].a = lab.a;
+        m_lab[i].b = lab.b;
+    }
+
+    memset(m_memo, 0, sizeof(m_memo));
+    m_has_palette = true;
+    return true;
+}
+
+//------------------------------------------------------------------------------
+unsigned char console_palette::get_nearest(const unsigned char (&rgb)[3])
+{
+    const unsigned int key = c_memo_valid | (rgb[0] << 16) | (rgb[1] << 8) | rgb[2];
+    memo_entry& entry = m_memo[((key * 2654435761u) >> 24) & (memo_size - 1)];
+    if (entry.key != key)
+    {
+        entry.key = key;
+        entry.value = find_nearest(rgb);
+    }
+    return entry.value;
+}
+
+//------------------------------------------------------------------------------
+unsigned char console_palette::find_nearest(const unsigned char (&rgb)[3]) const
+{
+    cie::lab target(RGB(rgb[0], rgb[1], rgb[2]));
+    double best_deltaE = 0;
+    int best_idx = -1;
+
+    for (int i = sizeof_array(m_lab); i--;)
+    {
+        cie::lab candidate;
+        candidate.l = m_lab[i].l;
+        candidate.a = m_lab[i].a;
+        candidate.b = m_lab[i].b;
+        double deltaE = cie::deltaE_2(target, candidate);
+        if (best_idx < 0 || best_deltaE > deltaE)
+        {
+            best_deltaE = deltaE;
+            best_idx = i;
+        }
+    }
+
+    static const int dos_to_ansi_order[] = { 0, 4, 2, 6, 1, 5, 3, 7 };
+    return (best_idx & 0x08) + dos_to_ansi_order[best_idx & 0x07];
+}
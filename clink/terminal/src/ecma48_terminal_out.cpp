@@ -14,11 +14,28 @@
 
 //------------------------------------------------------------------------------
 extern setting_bool g_adjust_cursor_style;
+extern bool g_cursor_visible;
 extern "C" char *tgetstr(const char* name, char** out);
 
 //------------------------------------------------------------------------------
 static unsigned char s_rgb_cube[] = { 0x00, 0x5f, 0x87, 0xaf, 0xd7, 0xff };
 
+//------------------------------------------------------------------------------
+// With native VT processing the console applies DECTCEM itself, so note it here
+// to keep is_cursor_visible() accurate.
+static void note_cursor_visibility(const char* chars, int length)
+{
+    if (length < 0)
+        length = int(strlen(chars));
+
+    const char* const end = chars + length;
+    for (const char* p = chars; (p = static_cast<const char*>(memchr(p, '\x1b', end - p))) != nullptr; ++p)
+    {
+        if (end - p >= 6 && memcmp(p, "\x1b[?25", 5) == 0 && (p[5] == 'h' || p[5] == 'l'))
+            g_cursor_visible = (p[5] == 'h');
+    }
+}
+
 //------------------------------------------------------------------------------
 void set_console_title(const char* title)
 {
@@ -220,6 +237,7 @@ void ecma48_terminal_out::write(const char* chars, int length)
     if (m_screen.has_native_vt_processing())
     {
         m_screen.write(chars, length);
+        note_cursor_visibility(chars, length);
         return;
     }
 
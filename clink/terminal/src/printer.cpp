@@ -4,9 +4,13 @@
 #include "pch.h"
 #include "printer.h"
 #include "terminal_out.h"
+#include "terminal_helpers.h"
+#include "screen_buffer.h"
 
 #include <core/str.h>
 
+#include <assert.h>
+
 //------------------------------------------------------------------------------
 static bool s_is_scrolled = false;
 void set_scrolled_screen_buffer()
@@ -48,6 +52,7 @@ void printer::print(const char* data, int bytes)
     // get ignored.
     if (s_is_scrolled)
     {
+        flush_frame();
         m_terminal.flush();
         s_is_scrolled = false;
     }
@@ -55,7 +60,7 @@ void printer::print(const char* data, int bytes)
     if (m_next_attr != m_set_attr)
         flush_attributes();
 
-    m_terminal.write(data, bytes);
+    write(data, bytes);
 }
 
 //------------------------------------------------------------------------------
@@ -96,24 +101,28 @@ unsigned int printer::get_rows() const
 //------------------------------------------------------------------------------
 bool printer::get_line_text(int line, str_base& out) const
 {
+    flush_frame();
     return m_terminal.get_line_text(line, out);
 }
 
 //------------------------------------------------------------------------------
 int printer::is_line_default_color(int line) const
 {
+    flush_frame();
     return m_terminal.is_line_default_color(line);
 }
 
 //------------------------------------------------------------------------------
 int printer::line_has_color(int line, const BYTE* attrs, int num_attrs, BYTE mask) const
 {
+    flush_frame();
     return m_terminal.line_has_color(line, attrs, num_attrs, mask);
 }
 
 //------------------------------------------------------------------------------
 int printer::find_line(int starting_line, int distance, const char* text, find_line_mode mode, const BYTE* attrs, int num_attrs, BYTE mask) const
 {
+    flush_frame();
     return m_terminal.find_line(starting_line, distance, text, mode, attrs, num_attrs, mask);
 }
 
@@ -180,9 +189,9 @@ void printer::flush_attributes()
 
     if (!params.empty())
     {
-        m_terminal.write("\x1b[");
-        m_terminal.write(params.c_str(), params.length());
-        m_terminal.write("m");
+        write("\x1b[", 2);
+        write(params.c_str(), params.length());
+        write("m", 1);
     }
 
     m_set_attr = m_next_attr;
@@ -194,6 +203,70 @@ attributes printer::get_attributes() const
     return m_next_attr;
 }
 
+//------------------------------------------------------------------------------
+void printer::begin_frame()
+{
+    ++m_frame_depth;
+}
+
+//------------------------------------------------------------------------------
+void printer::end_frame()
+{
+    assert(m_frame_depth > 0);
+    if (--m_frame_depth == 0)
+        flush_frame();
+}
+
+//------------------------------------------------------------------------------
+void printer::flush_frame() const
+{
+    if (m_frame.empty())
+        return;
+
+    // Plain text can't tear, but output that moves the cursor around is
+    // bracketed so the terminal doesn't show it half done:  terminals that
+    // support synchronized output (DEC mode 2026) present the whole frame at
+    // once, and otherwise the cursor is hidden while the frame is drawn.
+    // Emulated terminals get no brackets, since Clink applies the escape codes
+    // itself.
+    const char* const frame = m_frame.c_str();
+    const ansi_handler handler = get_current_ansi_handler();
+    const bool bracket = (handler >= ansi_handler::first_native && strchr(frame, '\x1b'));
+    const bool sync = (bracket && (handler == ansi_handler::winterminal ||
+                                   handler == ansi_handler::wezterm));
+    const bool hide = (bracket && !sync &&
+                       is_cursor_visible() &&
+                       !is_locked_cursor() &&
+                       !strstr(frame, "\x1b[?25"));
+
+    if (sync || hide)
+    {
+        str<> out;
+        out << (sync ? "\x1b[?2026h" : "\x1b[?25l");
+        out.concat(frame, m_frame.length());
+        out << (sync ? "\x1b[?2026l" : "\x1b[?25h");
+        m_frame.clear();
+        m_terminal.write(out.c_str(), out.length());
+    }
+    else
+    {
+        // Clear before writing, in case writing reenters the printer.
+        str_moveable out(std::move(m_frame));
+        m_terminal.write(out.c_str(), out.length());
+        out.clear();
+        m_frame = std::move(out);
+    }
+}
+
+//------------------------------------------------------------------------------
+void printer::write(const char* data, int bytes)
+{
+    if (m_frame_depth > 0)
+        m_frame.concat(data, bytes);
+    else
+        m_terminal.write(data, bytes);
+}
+
 //------------------------------------------------------------------------------
 void printer::insert(int count)
 {
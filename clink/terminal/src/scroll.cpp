@@ -3,6 +3,7 @@
 
 #include "pch.h"
 #include "scroll.h"
+#include "terminal_helpers.h"
 
 //------------------------------------------------------------------------------
 // Terminal can't #include from Readline.
@@ -27,6 +28,8 @@ void reset_scroll_mode()
 //------------------------------------------------------------------------------
 int ScrollConsoleRelative(HANDLE h, int direction, SCRMODE mode)
 {
+    flush_printer_frame();
+
     // Get the current screen buffer window position.
     CONSOLE_SCREEN_BUFFER_INFO csbiInfo;
     if (!GetConsoleScreenBufferInfo(h, &csbiInfo))
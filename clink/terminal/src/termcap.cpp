@@ -28,6 +28,7 @@ static const char c_default_term_vb[] = "\x1bg";
 static wstr_moveable s_term_ve;
 static wstr_moveable s_term_vs;
 bool g_enhanced_cursor = false;
+bool g_cursor_visible = true;
 
 //------------------------------------------------------------------------------
 static bool is_cursor_blink_code(const wchar_t* chars)
@@ -36,10 +37,24 @@ static bool is_cursor_blink_code(const wchar_t* chars)
             wcscmp(chars, L"\u001b[?12h") == 0);
 }
 
+//------------------------------------------------------------------------------
+extern "C" int is_cursor_visible()
+{
+    // Tracks visibility set through show_cursor() and cursor_style(), which
+    // avoids asking the console (an extra round trip) each time a printer frame
+    // is flushed.
+    return g_cursor_visible;
+}
+
 //------------------------------------------------------------------------------
 extern "C" int show_cursor(int visible)
 {
+    // This writes to the console directly, so pending output must go first.
+    flush_printer_frame();
+
     HANDLE h = GetStdHandle(STD_OUTPUT_HANDLE);
+    if (!is_locked_cursor())
+        g_cursor_visible = !!visible;
 
     if (visible)
     {
@@ -14,6 +14,7 @@
 
 //------------------------------------------------------------------------------
 extern bool g_enhanced_cursor;
+extern bool g_cursor_visible;
 printer* g_printer = nullptr;
 bool g_accept_mouse_input = false;
 
@@ -118,7 +119,12 @@ extern "C" int cursor_style(HANDLE handle, int style, int visible)
     ci.dwSize = style ? g_alternate_cursor_size : g_default_cursor_size;
 
     if (visible >= 0)
+    {
+        // Keep is_cursor_visible() accurate when visibility changes without
+        // going through show_cursor() (e.g. an emulated ESC[?25l).
         ci.bVisible = !!visible;
+        g_cursor_visible = !!visible;
+    }
 
     SetConsoleCursorInfo(handle, &ci);
 
@@ -332,6 +338,15 @@ bool console_config::no_mouse_modifiers()
 
 
 
+//------------------------------------------------------------------------------
+extern "C" void flush_printer_frame()
+{
+    if (g_printer)
+        g_printer->flush_frame();
+}
+
+
+
 //------------------------------------------------------------------------------
 printer_context::printer_context(terminal_out* terminal, printer* printer)
 : m_terminal(terminal)
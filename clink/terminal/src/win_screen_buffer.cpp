@@ -3,7 +3,6 @@
 
 #include "pch.h"
 #include "win_screen_buffer.h"
-#include "cielab.h"
 #include "find_line.h"
 
 #include <core/base.h>
@@ -137,6 +136,9 @@ void win_screen_buffer::begin()
     if (m_ready > 1)
         return;
 
+    // The palette may have been changed while the shell was in control.
+    m_palette_stale = true;
+
     static bool s_detect_native_ansi_handler = true;
     const bool detect_native_ansi_handler = s_detect_native_ansi_handler;
 
@@ -312,25 +314,37 @@ void win_screen_buffer::write(const char* data, int length)
 {
     assert(m_ready);
 
-    str_iter iter(data, length);
-    while (length > 0)
+    // Convert the whole string at once, so that a frame of output collected by
+    // the printer takes a single console call.
+    const char* const end = data + length;
+    while (data < end)
     {
-        wchar_t wbuf[384];
-        int n = min<int>(sizeof_array(wbuf), length + 1);
-        n = to_utf16(wbuf, n, iter);
-        if (!n && !*iter.get_pointer())
+        str_iter iter(data, int(end - data));
+        m_write_buf.clear();
+        to_utf16(m_write_buf, iter);
+
+        if (m_write_buf.length())
         {
-            assert(false); // Very inefficient, and shouldn't be possible.
-            wbuf[0] = '\0';
-            n = 1;
+            DWORD written;
+            WriteConsoleW(m_handle, m_write_buf.c_str(), m_write_buf.length(), &written, nullptr);
         }
 
-        DWORD written;
-        WriteConsoleW(m_handle, wbuf, n, &written, nullptr);
-
-        n = int(iter.get_pointer() - data);
-        length -= n;
-        data += n;
+        const char* const next = iter.get_pointer();
+        if (next < end && !*next)
+        {
+            assert(false); // Very inefficient, and shouldn't be possible.
+            DWORD written;
+            WriteConsoleW(m_handle, L"", 1, &written, nullptr);
+            data = next + 1;
+        }
+        else if (next > data)
+        {
+            data = next;
+        }
+        else
+        {
+            break;
+        }
     }
 }
 
@@ -690,8 +704,12 @@ void win_screen_buffer::set_attributes(attributes attr)
 }
 
 //------------------------------------------------------------------------------
-static bool get_nearest_color(void* handle, const unsigned char (&rgb)[3], unsigned char& attr)
+// The palette is read at most once per begin(), rather than for every color.
+bool win_screen_buffer::ensure_palette() const
 {
+    if (!m_palette_stale)
+        return m_palette.has_palette();
+
     static HMODULE hmod = GetModuleHandle("kernel32.dll");
     static FARPROC proc = GetProcAddress(hmod, "GetConsoleScreenBufferInfoEx");
     typedef BOOL (WINAPI* GCSBIEx)(HANDLE, PCONSOLE_SCREEN_BUFFER_INFOEX);
@@ -700,29 +718,11 @@ static bool get_nearest_color(void* handle, const unsigned char (&rgb)[3], unsig
         return false;
 
     CONSOLE_SCREEN_BUFFER_INFOEX infoex = { sizeof(infoex) };
-    if (!GCSBIEx(proc)(handle, &infoex))
+    if (!GCSBIEx(proc)(m_handle, &infoex))
         return false;
 
-    cie::lab target(RGB(rgb[0], rgb[1], rgb[2]));
-    double best_deltaE = 0;
-    int best_idx = -1;
-
-    for (int i = sizeof_array(infoex.ColorTable); i--;)
-    {
-        cie::lab candidate(infoex.ColorTable[i]);
-        double deltaE = cie::deltaE_2(target, candidate);
-        if (best_idx < 0 || best_deltaE > deltaE)
-        {
-            best_deltaE = deltaE;
-            best_idx = i;
-        }
-    }
-
-    if (best_idx < 0)
-        return false;
-
-    static const int dos_to_ansi_order[] = { 0, 4, 2, 6, 1, 5, 3, 7 };
-    attr = (best_idx & 0x08) + dos_to_ansi_order[best_idx & 0x07];
+    m_palette.set_palette(infoex.ColorTable);
+    m_palette_stale = false;
     return true;
 }
 
@@ -731,23 +731,23 @@ bool win_screen_buffer::get_nearest_color(attributes& attr) const
 {
     const attributes::color fg = attr.get_fg().value;
     const attributes::color bg = attr.get_bg().value;
+    if (!fg.is_rgb && !bg.is_rgb)
+        return true;
+
+    if (!ensure_palette())
+        return false;
+
     if (fg.is_rgb)
     {
-        unsigned char val;
         unsigned char rgb[3];
         fg.as_888(rgb);
-        if (!::get_nearest_color(m_handle, rgb, val))
-            return false;
-        attr.set_fg(val);
+        attr.set_fg(m_palette.get_nearest(rgb));
     }
     if (bg.is_rgb)
     {
-        unsigned char val;
         unsigned char rgb[3];
         bg.as_888(rgb);
-        if (!::get_nearest_color(m_handle, rgb, val))
-            return false;
-        attr.set_bg(val);
+        attr.set_bg(m_palette.get_nearest(rgb));
     }
     return true;
 }
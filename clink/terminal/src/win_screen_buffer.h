@@ -4,6 +4,9 @@
 #pragma once
 
 #include "screen_buffer.h"
+#include "console_palette.h"
+
+#include <core/str.h>
 
 class str_base;
 enum find_line_mode : int;
@@ -42,6 +45,7 @@ public:
 private:
     bool            ensure_chars_buffer(int width) const;
     bool            ensure_attrs_buffer(int width) const;
+    bool            ensure_palette() const;
 
     enum : unsigned short
     {
@@ -67,4 +71,9 @@ private:
     mutable SHORT   m_chars_capacity = 0;
 
     COORD           m_saved_cursor = {};
+
+    wstr_moveable   m_write_buf;
+
+    mutable console_palette m_palette;
+    mutable bool    m_palette_stale = true;
 };
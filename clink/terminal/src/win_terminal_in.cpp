@@ -668,6 +668,55 @@ key_tester* win_terminal_in::set_key_tester(key_tester* keys)
     return ret;
 }
 
+//------------------------------------------------------------------------------
+static bool is_burst_char(unsigned int c)
+{
+    return c >= 0x20 && c != 0x7f;
+}
+
+//------------------------------------------------------------------------------
+// Input records are still read and translated one at a time, since whether a
+// key sequence is bound depends on the keymap that's active when it arrives.
+// But the queued records can be peeked in bulk to tell whether more plain text
+// is already waiting.
+bool win_terminal_in::in_burst()
+{
+    // The rest of the current key, e.g. the remaining bytes of UTF8 text.
+    if (m_buffer_count)
+    {
+        const unsigned char c = peek();
+        return (is_burst_char(c) &&
+                c != input_none_byte &&
+                c != input_abort_byte &&
+                c != input_exit_byte);
+    }
+
+    if (!m_stdin)
+        return false;
+
+    DWORD count = 0;
+    INPUT_RECORD records[32];
+    if (!PeekConsoleInputW(m_stdin, records, sizeof_array(records), &count))
+        return false;
+
+    for (DWORD i = 0; i < count; ++i)
+    {
+        if (records[i].EventType != KEY_EVENT)
+            return false;
+
+        const KEY_EVENT_RECORD& key = records[i].Event.KeyEvent;
+        if (key.wVirtualKeyCode == VK_MENU)
+            return false;
+        if (!key.bKeyDown || key.wVirtualKeyCode == VK_SHIFT)
+            continue;
+
+        const DWORD mods = LEFT_ALT_PRESSED|RIGHT_ALT_PRESSED|LEFT_CTRL_PRESSED|RIGHT_CTRL_PRESSED;
+        return is_burst_char(key.uChar.UnicodeChar) && !(key.dwControlKeyState & mods);
+    }
+
+    return false;
+}
+
 //------------------------------------------------------------------------------
 void win_terminal_in::fix_console_input_mode()
 {
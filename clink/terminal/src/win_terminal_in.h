@@ -20,6 +20,7 @@ public:
     virtual void    select(input_idle* callback=nullptr) override;
     virtual int     read() override;
     virtual key_tester* set_key_tester(key_tester* keys) override;
+    virtual bool    in_burst() override;
 
 private:
     unsigned int    get_dimensions();
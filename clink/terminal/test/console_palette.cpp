@@ -0,0 +1,46 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <terminal/console_palette.h>
+
+//------------------------------------------------------------------------------
+TEST_CASE("Console palette")
+{
+    // Legacy console palette, in console order.
+    COLORREF table[16] = {
+        RGB(0,0,0),         RGB(0,0,128),       RGB(0,128,0),       RGB(0,128,128),
+        RGB(128,0,0),       RGB(128,0,128),     RGB(128,128,0),     RGB(192,192,192),
+        RGB(128,128,128),   RGB(0,0,255),       RGB(0,255,0),       RGB(0,255,255),
+        RGB(255,0,0),       RGB(255,0,255),     RGB(255,255,0),     RGB(255,255,255),
+    };
+
+    console_palette palette;
+    REQUIRE(!palette.has_palette());
+    REQUIRE(palette.set_palette(table));
+    REQUIRE(palette.has_palette());
+    REQUIRE(!palette.set_palette(table));
+
+    const unsigned char black[3] = { 0, 0, 0 };
+    const unsigned char navy[3] = { 0, 0, 128 };
+    const unsigned char red[3] = { 255, 0, 0 };
+    const unsigned char near_white[3] = { 250, 250, 250 };
+
+    // Results are ANSI color indices.
+    REQUIRE(palette.get_nearest(black) == 0);
+    REQUIRE(palette.get_nearest(navy) == 4);
+    REQUIRE(palette.get_nearest(red) == 9);
+    REQUIRE(palette.get_nearest(near_white) == 15);
+
+    // Remembered results are the same.
+    REQUIRE(palette.get_nearest(red) == 9);
+    REQUIRE(palette.get_nearest(black) == 0);
+
+    // Changing the palette forgets remembered results.
+    std::swap(table[0], table[15]);
+    REQUIRE(palette.set_palette(table));
+    REQUIRE(palette.get_nearest(black) == 15);
+    REQUIRE(palette.get_nearest(near_white) == 0);
+    REQUIRE(palette.get_nearest(red) == 9);
+}
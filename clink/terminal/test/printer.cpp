@@ -0,0 +1,99 @@
+// Copyright (c) 2022 Christopher Antos
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include <core/base.h>
+#include <core/str.h>
+#include <terminal/printer.h>
+#include <terminal/terminal_out.h>
+#include <terminal/terminal_helpers.h>
+
+//------------------------------------------------------------------------------
+class recording_terminal_out
+    : public terminal_out
+{
+public:
+    virtual void            open() override {}
+    virtual void            begin() override {}
+    virtual void            end() override {}
+    virtual void            close() override {}
+    virtual void            write(const char* chars, int length) override { m_out.concat(chars, length); ++m_writes; }
+    virtual void            flush() override {}
+    virtual int             get_columns() const override { return 80; }
+    virtual int             get_rows() const override { return 25; }
+    virtual bool            get_line_text(int line, str_base& out) const override { return false; }
+    virtual int             is_line_default_color(int line) const override { return true; }
+    virtual int             line_has_color(int line, const BYTE* attrs, int num_attrs, BYTE mask=0xff) const override { return false; }
+    virtual int             find_line(int starting_line, int distance, const char* text, find_line_mode mode, const BYTE* attrs=nullptr, int num_attrs=0, BYTE mask=0xff) const override { return 0; }
+
+    str_moveable            m_out;
+    int                     m_writes = 0;
+};
+
+//------------------------------------------------------------------------------
+TEST_CASE("Printer frames")
+{
+    recording_terminal_out terminal;
+    printer out(terminal);
+
+    SECTION("Unframed")
+    {
+        out.print("abc");
+        out.print("def");
+        REQUIRE(terminal.m_writes == 2);
+        REQUIRE(terminal.m_out.equals("abcdef"));
+    }
+
+    SECTION("Framed")
+    {
+        {
+            printer_frame frame(out);
+            out.print("abc");
+            {
+                printer_frame nested(out);
+                out.print("\x1b[A");
+            }
+            REQUIRE(terminal.m_writes == 0);
+            out.print("def");
+        }
+        REQUIRE(terminal.m_writes == 1);
+        REQUIRE(terminal.m_out.equals("abc\x1b[Adef"));
+    }
+
+    SECTION("Flush")
+    {
+        printer_frame frame(out);
+        out.print("abc");
+
+        // Queries see everything printed so far.
+        str<> line;
+        out.get_line_text(0, line);
+        REQUIRE(terminal.m_writes == 1);
+        REQUIRE(terminal.m_out.equals("abc"));
+
+        out.print("def");
+        out.flush_frame();
+        REQUIRE(terminal.m_writes == 2);
+        REQUIRE(terminal.m_out.equals("abcdef"));
+    }
+
+    SECTION("Flush before direct console access")
+    {
+        // Lua APIs such as console.getlinetext() and os.getscreeninfo() read
+        // the console directly, so they flush the global printer's frame
+        // first; e.g. after a key binding used clink.print().
+        rollback<printer*> rb_printer(g_printer, &out);
+
+        printer_frame frame(out);
+        out.print("abc");
+        REQUIRE(terminal.m_writes == 0);
+
+        flush_printer_frame();
+        REQUIRE(terminal.m_writes == 1);
+        REQUIRE(terminal.m_out.equals("abc"));
+
+        flush_printer_frame();
+        REQUIRE(terminal.m_writes == 1);
+    }
+}
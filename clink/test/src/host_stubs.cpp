@@ -0,0 +1,46 @@
+// Copyright (c) 2015 Martin Ridgers
+// License: http://opensource.org/licenses/MIT
+
+#include "pch.h"
+
+#include "core/str.h"
+
+#include <list>
+#include <assert.h>
+
+//------------------------------------------------------------------------------
+// The test harness and benchmarks link the lib module without the host, so
+// they supply stubs for the host functions it calls.
+
+//------------------------------------------------------------------------------
+#ifdef DEBUG
+bool g_suppress_signal_assert = false;
+#endif
+
+//------------------------------------------------------------------------------
+void host_cmd_enqueue_lines(std::list<str_moveable>& lines, bool hide_prompt, bool show_line)
+{
+    assert(false);
+}
+
+//------------------------------------------------------------------------------
+void host_cleanup_after_signal()
+{
+}
+
+//------------------------------------------------------------------------------
+void host_mark_deprecated_argmatcher(const char* command)
+{
+}
+
+//------------------------------------------------------------------------------
+bool host_has_deprecated_argmatcher(const char* command)
+{
+    return false;
+}
+
+//------------------------------------------------------------------------------
+void start_logger()
+{
+    assert(false);
+}
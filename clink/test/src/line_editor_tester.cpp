@@ -147,6 +147,12 @@ void line_editor_tester::set_input(const char* input)
     m_input = input;
 }
 
+//------------------------------------------------------------------------------
+void line_editor_tester::set_burst(bool burst)
+{
+    m_terminal_in.set_burst(burst);
+}
+
 //------------------------------------------------------------------------------
 void line_editor_tester::set_expected_output(const char* expected)
 {
@@ -177,6 +183,47 @@ static const char* sanitize(const char* text)
     return s_s.c_str();
 }
 
+//------------------------------------------------------------------------------
+static void check_classifications(const char* input, const word_classifications* classifications, const char* expected)
+{
+    REQUIRE(classifications, [&]() {
+        printf(" input; %s\n", sanitize(input));
+
+        puts("expected classifications but got none");
+    });
+
+    str<> c;
+    for (unsigned int i = 0; i < classifications->size(); ++i)
+    {
+        static const char c_lookup[] =
+        {
+            'o',    // word_class::other
+            'u',    // word_class::unrecognized
+            'x',    // word_class::executable
+            'c',    // word_class::command
+            'd',    // word_class::doskey
+            'a',    // word_class::arg
+            'f',    // word_class::flag
+            'n',    // word_class::none
+        };
+        static_assert(sizeof_array(c_lookup) == int(word_class::max), "c_lookup size does not match word_class::max");
+
+        const word_class_info& wc = *(*classifications)[i];
+        if (unsigned(wc.word_class) < sizeof_array(c_lookup))
+            c.concat(&c_lookup[unsigned(wc.word_class)], 1);
+    }
+
+    REQUIRE(strcmp(expected, c.c_str()) == 0, [&] () {
+        printf(" input; %s#\n", sanitize(input));
+
+        puts("\nexpected classifications;");
+        printf("  %s\n", expected);
+
+        puts("\ngot;");
+        printf("  %s\n", c.c_str());
+    });
+}
+
 //------------------------------------------------------------------------------
 void line_editor_tester::run()
 {
@@ -186,6 +233,10 @@ void line_editor_tester::run()
     REQUIRE(m_input != nullptr);
     m_terminal_in.set_input(m_input);
 
+    // Hold the burst open past the end of the input, so that the burst only
+    // ends once the input has been checked.
+    m_terminal_in.set_burst_held(m_has_burst_classifications);
+
     // If we're expecting some matches then add a module to catch the
     // matches object.
     test_module match_catch;
@@ -200,6 +251,15 @@ void line_editor_tester::run()
     }
     while (m_terminal_in.has_input());
 
+    if (m_has_burst_classifications)
+    {
+        // Nothing is classified while the burst is in progress.  Ending the
+        // burst classifies the line once, in the next update.
+        check_classifications(m_input, match_catch.get_classifications(), m_expected_burst_classifications.c_str());
+        m_terminal_in.set_burst_held(false);
+        REQUIRE(m_editor->update());
+    }
+
     m_editor->update_matches();
 
     if (m_has_matches)
@@ -243,45 +303,7 @@ void line_editor_tester::run()
     }
 
     if (m_has_classifications)
-    {
-        const word_classifications* classifications = match_catch.get_classifications();
-        REQUIRE(classifications, [&]() {
-            printf(" input; %s\n", sanitize(m_input));
-
-            puts("expected classifications but got none");
-        });
-
-        str<> c;
-        for (unsigned int i = 0; i < classifications->size(); ++i)
-        {
-            static const char c_lookup[] =
-            {
-                'o',    // word_class::other
-                'u',    // word_class::unrecognized
-                'x',    // word_class::executable
-                'c',    // word_class::command
-                'd',    // word_class::doskey
-                'a',    // word_class::arg
-                'f',    // word_class::flag
-                'n',    // word_class::none
-            };
-            static_assert(sizeof_array(c_lookup) == int(word_class::max), "c_lookup size does not match word_class::max");
-
-            const word_class_info& wc = *(*classifications)[i];
-            if (unsigned(wc.word_class) < sizeof_array(c_lookup))
-                c.concat(&c_lookup[unsigned(wc.word_class)], 1);
-        }
-
-        REQUIRE(m_expected_classifications.equals(c.c_str()), [&] () {
-            printf(" input; %s#\n", sanitize(m_input));
-
-            puts("\nexpected classifications;");
-            printf("  %s\n", m_expected_classifications.c_str());
-
-            puts("\ngot;");
-            printf("  %s\n", c.c_str());
-        });
-    }
+        check_classifications(m_input, match_catch.get_classifications(), m_expected_classifications.c_str());
 
     // Check the output is as expected.
     if (m_expected_output != nullptr)
@@ -299,6 +321,26 @@ void line_editor_tester::run()
     m_expected_output = nullptr;
     m_expected_matches.clear();
     m_expected_classifications.clear();
+    m_expected_burst_classifications.clear();
+    m_has_burst_classifications = false;
+
+    reset_lines();
+}
+
+//------------------------------------------------------------------------------
+void line_editor_tester::replay()
+{
+    REQUIRE(m_input != nullptr);
+    m_terminal_in.set_input(m_input);
+
+    REQUIRE(m_editor->update());
+    do
+    {
+        REQUIRE(m_editor->update());
+    }
+    while (m_terminal_in.has_input());
+
+    m_input = nullptr;
 
     reset_lines();
 }
@@ -357,3 +399,10 @@ void line_editor_tester::set_expected_classifications(const char* classification
     m_expected_classifications = classifications;
     m_has_classifications = true;
 }
+
+//------------------------------------------------------------------------------
+void line_editor_tester::set_expected_burst_classifications(const char* classifications)
+{
+    m_expected_burst_classifications = classifications;
+    m_has_burst_classifications = true;
+}
@@ -22,16 +22,21 @@ class test_terminal_in
 public:
     bool                    has_input() const { return (m_read == nullptr) ? false : (*m_read != '\0'); }
     void                    set_input(const char* input) { m_input = m_read = input; }
+    void                    set_burst(bool burst) { m_burst = burst; }
+    void                    set_burst_held(bool held) { m_burst_held = held; }
     virtual void            begin() override {}
     virtual void            end() override {}
     virtual bool            available(unsigned int timeout) override { return has_input(); }
     virtual void            select(input_idle*) override {}
-    virtual int             read() override { return *(unsigned char*)m_read++; }
+    virtual int             read() override { return has_input() ? *(unsigned char*)m_read++ : input_none; }
     virtual key_tester*     set_key_tester(key_tester*) override { return nullptr; }
+    virtual bool            in_burst() override { return m_burst && (has_input() ? *(unsigned char*)m_read >= 0x20 && *m_read != 0x7f : m_burst_held); }
 
 private:
     const char*             m_input = nullptr;
     const char*             m_read = nullptr;
+    bool                    m_burst = false;
+    bool                    m_burst_held = false; // The burst continues past the end of the input.
 };
 
 //------------------------------------------------------------------------------
@@ -65,11 +70,14 @@ public:
                                 ~line_editor_tester();
     line_editor*                get_editor() const;
     void                        set_input(const char* input);
+    void                        set_burst(bool burst); // Treats queued text as pasted.
     template <class ...T> void  set_expected_matches(T... t); // T must be const char*
     void                        set_expected_matches_list(const char* const* expected); // The list must be terminated with nullptr.
     void                        set_expected_classifications(const char* classifications);
+    void                        set_expected_burst_classifications(const char* classifications); // Checked before the burst ends.
     void                        set_expected_output(const char* expected);
     void                        run();
+    void                        replay(); // Feeds the input without checking expectations (for benchmarks).
 
 private:
     void                        create_line_editor(const line_editor::desc* desc=nullptr);
@@ -85,11 +93,13 @@ private:
     collector_tokeniser*        m_word_tokeniser = nullptr;
     std::vector<const char*>    m_expected_matches;
     str<>                       m_expected_classifications;
+    str<>                       m_expected_burst_classifications;
     const char*                 m_input = nullptr;
     const char*                 m_expected_output = nullptr;
     line_editor*                m_editor = nullptr;
     bool                        m_has_matches = false;
     bool                        m_has_classifications = false;
+    bool                        m_has_burst_classifications = false;
 };
 
 //------------------------------------------------------------------------------
@@ -13,45 +13,9 @@ extern "C" {
 #include <readline/rlprivate.h>
 }
 
-#include <list>
-#include <assert.h>
-
 //------------------------------------------------------------------------------
 extern bool g_force_load_debugger;
 
-//------------------------------------------------------------------------------
-#ifdef DEBUG
-bool g_suppress_signal_assert = false;
-#endif
-
-//------------------------------------------------------------------------------
-void host_cmd_enqueue_lines(std::list<str_moveable>& lines, bool hide_prompt, bool show_line)
-{
-    assert(false);
-}
-
-//------------------------------------------------------------------------------
-void host_cleanup_after_signal()
-{
-}
-
-//------------------------------------------------------------------------------
-void host_mark_deprecated_argmatcher(const char* command)
-{
-}
-
-//------------------------------------------------------------------------------
-bool host_has_deprecated_argmatcher(const char* command)
-{
-    return false;
-}
-
-//------------------------------------------------------------------------------
-void start_logger()
-{
-    assert(false);
-}
-
 //------------------------------------------------------------------------------
 int main(int argc, char** argv)
 {
@@ -107,6 +71,9 @@ int main(int argc, char** argv)
     extern void shutdown_recognizer();
     shutdown_recognizer();
 
+    extern void shutdown_exec_catalog();
+    shutdown_exec_catalog();
+
     extern void shutdown_task_manager();
     shutdown_task_manager();
 
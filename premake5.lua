@@ -310,6 +310,7 @@ clink_lib("clink_lua")
 --------------------------------------------------------------------------------
 clink_lib("clink_core")
     includedirs("clink/core/include/core")
+    includedirs("wildmatch/wildmatch")
     files("clink/core/src/**")
     files("clink/core/include/**")
 
@@ -490,6 +491,50 @@ clink_exe("clink_test")
         links("ole32")
         linkgroups("on")
 
+--------------------------------------------------------------------------------
+clink_exe("clink_bench")
+    links("clink_app_common")
+    links("clink_core")
+    links("clink_lib")
+    links("clink_lua")
+    links("clink_process")
+    links("clink_terminal")
+    links("wildmatch")
+    links("lua")
+    links("readline")
+    links("shlwapi")
+    links("rpcrt4")
+    includedirs("clink/bench")
+    includedirs("clink/test/src")
+    includedirs("clink/app/src")
+    includedirs("clink/core/include")
+    includedirs("clink/lib/include")
+    includedirs("clink/lib/include/lib")
+    includedirs("clink/lib/src")
+    includedirs("clink/lua/include")
+    includedirs("clink/terminal/include")
+    includedirs("lua/src")
+    includedirs("readline")
+    includedirs("readline/compat")
+    files("clink/bench/*.cpp")
+    files("clink/bench/*.h")
+    files("clink/test/src/*.cpp")
+    files("clink/test/src/*.h")
+    removefiles("clink/test/src/main.cpp")
+
+    exceptionhandling("on")
+
+    configuration("vs*")
+        pchheader("pch.h")
+        pchsource("clink/test/src/pch.cpp")
+
+    configuration("gmake")
+        buildoptions("-fpermissive")
+        buildoptions("-std=c++17")
+        links("gdi32")
+        links("ole32")
+        linkgroups("on")
+
 --------------------------------------------------------------------------------
 require "vstudio"
 local function add_tag(tag, value, project_name)
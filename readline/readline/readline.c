@@ -260,6 +260,7 @@ Keymap _rl_dispatching_keymap;
 /* begin_clink_change */
 rl_macro_hook_func_t *rl_macro_hook_func = (rl_macro_hook_func_t *)NULL;
 rl_voidfunc_t *rl_last_func_hook_func = (rl_voidfunc_t *)NULL;
+rl_before_func_hook_func_t *rl_before_func_hook_func = (rl_before_func_hook_func_t *)NULL;
 /* end_clink_change */
 
 /* Non-zero means to erase entire line, including prompt, on empty input lines. */
@@ -948,6 +949,10 @@ _rl_dispatch_subseq (register int key, Keymap map, int got_subseq)
 
 	  rl_dispatching = 1;
 	  RL_SETSTATE(RL_STATE_DISPATCHING);
+/* begin_clink_change */
+	  if (rl_before_func_hook_func)
+	    rl_before_func_hook_func (func);
+/* end_clink_change */
 	  r = (*func) (rl_numeric_arg * rl_arg_sign, key);
 	  RL_UNSETSTATE(RL_STATE_DISPATCHING);
 	  rl_dispatching = 0;
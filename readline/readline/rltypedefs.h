@@ -86,6 +86,8 @@ typedef char rl_get_face_func_t PARAMS((int in, int active_begin, int active_end
 typedef void rl_puts_face_func_t PARAMS((const char* s, const char* face, int n));
 /* Type for function to process macros */
 typedef int rl_macro_hook_func_t PARAMS((const char* macro));
+/* Type for function to call before dispatching a command */
+typedef void rl_before_func_hook_func_t PARAMS((rl_command_func_t *func));
 /* end_clink_change */
 
 /* Input function type */